@@ -1,11 +1,11 @@
 #version 110
 
-uniform mat4 _modelViewMatrix;
-uniform mat4 _modelViewProjectionMatrix;
-uniform mat4 _normalMatrix;
+uniform mat4 _viewMatrix;
+uniform mat4 _projectionMatrix;
 
 attribute vec4 _vertex;
 attribute vec4 _normal;
+attribute mat4 _instanceModelMatrix; // per instance, or the same for the whole draw
 
 uniform vec4 _diffuseColor;
 uniform vec4 _ambientColor;
@@ -16,9 +16,11 @@ uniform vec3 g_lightPos;
 varying vec4 g_color;
 
 void main() {
-    vec3 position = (_modelViewMatrix * _vertex).xyz;
+    // model transforms are rigid, the model view matrix turns the normals as well
+    mat4 modelViewMatrix = _viewMatrix * _instanceModelMatrix;
+    vec3 position = (modelViewMatrix * _vertex).xyz;
     vec3 lightDir = normalize(g_lightPos - position);
-    vec3 eyeNormal = normalize((_normalMatrix * _normal).xyz);
+    vec3 eyeNormal = normalize((modelViewMatrix * vec4(_normal.xyz, 0.0)).xyz);
     vec3 reflection = normalize(2.0 * dot(eyeNormal, lightDir) * eyeNormal - lightDir);
     vec4 ambient = _ambientColor;
     vec4 diffuse = _diffuseColor * max(0.0, dot(eyeNormal, lightDir));
@@ -26,5 +28,5 @@ void main() {
     g_color = ambient + diffuse + specular;
 
     // transform geometry
-    gl_Position = _modelViewProjectionMatrix * _vertex;
+    gl_Position = _projectionMatrix * modelViewMatrix * _vertex;
 }
@@ -27,36 +27,58 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
+#include "shoggoth-engine/kernel/terminalobject.hpp"
+#include "shoggoth-engine/kernel/tracerobject.hpp"
 #include "shoggoth-engine/kernel/device.hpp"
 #include "shoggoth-engine/kernel/scene.hpp"
+#include "shoggoth-engine/kernel/simulationloop.hpp"
+#include "shoggoth-engine/kernel/framepipeline.hpp"
+#include "shoggoth-engine/kernel/framepacer.hpp"
 #include "shoggoth-engine/renderer/renderer.hpp"
 #include "shoggoth-engine/physics/physicsworld.hpp"
 #include "testcomponentfactory.hpp"
 
+class AsyncJob;
+
 class Demo: public CommandObject {
 public:
     Demo(const std::string& objectName,
+         const std::string& terminalName,
+         const std::string& profilerName,
          const std::string& deviceName,
          const std::string& rendererName,
          const std::string& physicsWorldName,
+         const std::string& simulationLoopName,
+         const std::string& framePacerName,
          const std::string& sceneName,
-         const std::string& rootNodeName);
+         const std::string& rootNodeName,
+         const bool isHeadless = false);
     ~Demo();
 
-    void loadScene();
+    void loadScene(const std::string& fileName);
     void bindInputs();
     void runMainLoop();
+    void runReplay(const std::string& fileName);
 
 private:
     bool m_isRunning;
+    bool m_isPipelined;
+    std::string m_title;
+    TerminalObject m_terminal;
+    TracerObject m_profiler;
     Device m_device;
     Renderer m_renderer;
     PhysicsWorld m_physicsWorld;
+    SimulationLoop m_simulationLoop;
+    FramePipeline m_framePipeline;
+    FramePacer m_framePacer;
     TestComponentFactory m_componentFactory;
     Scene m_scene;
 
     std::string cmdQuit(std::deque<std::string>&);
-    std::string cmdRunCommand(std::deque<std::string>& args);
+    std::string cmdPipelined(std::deque<std::string>& args);
+    std::string cmdPipelineStats(std::deque<std::string>&);
+    std::string cmdRunCommand(std::deque<std::string>& args, AsyncJob*& job);
     std::string cmdPrint(std::deque<std::string>& args);
     std::string cmdOnMouseMotion(std::deque<std::string>&);
     std::string cmdFireCube(std::deque<std::string>&);
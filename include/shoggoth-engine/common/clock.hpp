@@ -0,0 +1,51 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <boost/cstdint.hpp>
+#include <boost/chrono/chrono.hpp>
+
+// Monotonic high resolution clock, unaffected by changes to the system time
+class Clock {
+public:
+    static boost::uint64_t nanoseconds();
+    static double seconds();
+};
+
+
+
+inline boost::uint64_t Clock::nanoseconds() {
+    return boost::uint64_t(boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+        boost::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline double Clock::seconds() {
+    return double(nanoseconds()) * 1.0e-9;
+}
+
+#endif // CLOCK_HPP
@@ -0,0 +1,184 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef DELEGATE_HPP
+#define DELEGATE_HPP
+
+// Callable bound to an object and one of its member functions, two pointers in size.
+// The member function is a template argument of the stub the delegate calls, so unlike
+// boost::function over boost::bind there is no adaptor in between and nothing is ever allocated.
+//   typedef Delegate<std::string (std::deque<std::string>&)> slot_t;
+//   slot_t slot = slot_t::fromMethod<Entity, &Entity::cmdMoveX>(this);
+template <typename Signature>
+class Delegate;
+
+template <typename R, typename A1>
+class Delegate<R (A1)> {
+public:
+    Delegate();
+    Delegate(const Delegate& rhs);
+    Delegate& operator=(const Delegate& rhs);
+
+    template <class C, R (C::*Method)(A1)>
+    static Delegate fromMethod(C* object);
+
+    bool empty() const;
+    R operator()(A1 a1) const;
+
+private:
+    typedef R (*stub_t)(void* object, A1 a1);
+
+    void* m_object;
+    stub_t m_stub;
+
+    Delegate(void* object, stub_t stub);
+
+    template <class C, R (C::*Method)(A1)>
+    static R invoke(void* object, A1 a1);
+};
+
+template <typename R, typename A1, typename A2>
+class Delegate<R (A1, A2)> {
+public:
+    Delegate();
+    Delegate(const Delegate& rhs);
+    Delegate& operator=(const Delegate& rhs);
+
+    template <class C, R (C::*Method)(A1, A2)>
+    static Delegate fromMethod(C* object);
+
+    bool empty() const;
+    R operator()(A1 a1, A2 a2) const;
+
+private:
+    typedef R (*stub_t)(void* object, A1 a1, A2 a2);
+
+    void* m_object;
+    stub_t m_stub;
+
+    Delegate(void* object, stub_t stub);
+
+    template <class C, R (C::*Method)(A1, A2)>
+    static R invoke(void* object, A1 a1, A2 a2);
+};
+
+
+
+template <typename R, typename A1>
+Delegate<R (A1)>::Delegate():
+    m_object(0),
+    m_stub(0)
+{}
+
+template <typename R, typename A1>
+Delegate<R (A1)>::Delegate(const Delegate& rhs):
+    m_object(rhs.m_object),
+    m_stub(rhs.m_stub)
+{}
+
+template <typename R, typename A1>
+Delegate<R (A1)>::Delegate(void* object, stub_t stub):
+    m_object(object),
+    m_stub(stub)
+{}
+
+template <typename R, typename A1>
+Delegate<R (A1)>& Delegate<R (A1)>::operator=(const Delegate& rhs) {
+    m_object = rhs.m_object;
+    m_stub = rhs.m_stub;
+    return *this;
+}
+
+template <typename R, typename A1>
+template <class C, R (C::*Method)(A1)>
+inline Delegate<R (A1)> Delegate<R (A1)>::fromMethod(C* object) {
+    return Delegate(object, &Delegate::invoke<C, Method>);
+}
+
+template <typename R, typename A1>
+inline bool Delegate<R (A1)>::empty() const {
+    return m_stub == 0;
+}
+
+template <typename R, typename A1>
+inline R Delegate<R (A1)>::operator()(A1 a1) const {
+    return m_stub(m_object, a1);
+}
+
+template <typename R, typename A1>
+template <class C, R (C::*Method)(A1)>
+R Delegate<R (A1)>::invoke(void* object, A1 a1) {
+    return (static_cast<C*>(object)->*Method)(a1);
+}
+
+template <typename R, typename A1, typename A2>
+Delegate<R (A1, A2)>::Delegate():
+    m_object(0),
+    m_stub(0)
+{}
+
+template <typename R, typename A1, typename A2>
+Delegate<R (A1, A2)>::Delegate(const Delegate& rhs):
+    m_object(rhs.m_object),
+    m_stub(rhs.m_stub)
+{}
+
+template <typename R, typename A1, typename A2>
+Delegate<R (A1, A2)>::Delegate(void* object, stub_t stub):
+    m_object(object),
+    m_stub(stub)
+{}
+
+template <typename R, typename A1, typename A2>
+Delegate<R (A1, A2)>& Delegate<R (A1, A2)>::operator=(const Delegate& rhs) {
+    m_object = rhs.m_object;
+    m_stub = rhs.m_stub;
+    return *this;
+}
+
+template <typename R, typename A1, typename A2>
+template <class C, R (C::*Method)(A1, A2)>
+inline Delegate<R (A1, A2)> Delegate<R (A1, A2)>::fromMethod(C* object) {
+    return Delegate(object, &Delegate::invoke<C, Method>);
+}
+
+template <typename R, typename A1, typename A2>
+inline bool Delegate<R (A1, A2)>::empty() const {
+    return m_stub == 0;
+}
+
+template <typename R, typename A1, typename A2>
+inline R Delegate<R (A1, A2)>::operator()(A1 a1, A2 a2) const {
+    return m_stub(m_object, a1, a2);
+}
+
+template <typename R, typename A1, typename A2>
+template <class C, R (C::*Method)(A1, A2)>
+R Delegate<R (A1, A2)>::invoke(void* object, A1 a1, A2 a2) {
+    return (static_cast<C*>(object)->*Method)(a1, a2);
+}
+
+#endif // DELEGATE_HPP
@@ -0,0 +1,71 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef ASYNCJOB_HPP
+#define ASYNCJOB_HPP
+
+#include <string>
+
+class CommandObject;
+
+// Work started by an async command, split in two halves:
+// run() is called on the worker thread and must only touch the job's own data,
+// commit() is called on the main thread in a later frame to apply the result.
+// The job is dropped without committing if its object was removed meanwhile.
+class AsyncJob {
+public:
+    AsyncJob();
+    virtual ~AsyncJob();
+
+    const std::string& getCompletionCommand() const;
+    bool isOwnerAlive() const;
+
+    void setOwner(CommandObject* owner);
+    void setCompletionCommand(const std::string& completionCommand);
+
+    virtual void run() = 0;
+    virtual std::string commit() = 0;
+
+private:
+    CommandObject* m_owner;
+    size_t m_idOwner;
+    std::string m_completionCommand;
+
+    AsyncJob(const AsyncJob& rhs);
+    AsyncJob& operator=(const AsyncJob&);
+};
+
+
+
+inline const std::string& AsyncJob::getCompletionCommand() const {
+    return m_completionCommand;
+}
+
+inline void AsyncJob::setCompletionCommand(const std::string& completionCommand) {
+    m_completionCommand = completionCommand;
+}
+
+#endif // ASYNCJOB_HPP
@@ -0,0 +1,68 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef ASYNCQUEUE_HPP
+#define ASYNCQUEUE_HPP
+
+#include <string>
+#include <deque>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+class AsyncJob;
+
+// Runs async jobs one after another on a single worker thread, started on the first job.
+// Finished jobs are committed from Terminal::processCommandsQueue, on the main thread.
+class AsyncQueue {
+public:
+    static size_t getTotalJobs();
+
+    static std::string submit(AsyncJob* job);
+    static std::string commitFinishedJobs();
+    static void shutdown();
+
+private:
+    static boost::thread* ms_worker;
+    static boost::mutex ms_mutex;
+    static boost::condition_variable ms_condition;
+    static std::deque<AsyncJob*> ms_pendingJobs;
+    static std::deque<AsyncJob*> ms_finishedJobs;
+    static size_t ms_totalJobs;
+    static bool ms_isShuttingDown;
+
+    static void runWorker();
+    static bool popFinishedJob(AsyncJob*& job);
+    static std::string commitJob(AsyncJob* job);
+};
+
+
+
+inline size_t AsyncQueue::getTotalJobs() {
+    return ms_totalJobs;
+}
+
+#endif // ASYNCQUEUE_HPP
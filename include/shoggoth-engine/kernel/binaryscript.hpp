@@ -0,0 +1,170 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef BINARYSCRIPT_HPP
+#define BINARYSCRIPT_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "command.hpp"
+
+class TokenTable;
+
+typedef enum {
+    ARGUMENT_STRING,
+    ARGUMENT_NUMBER
+} argument_type_t;
+
+// File layout, every field is 32 bits wide so the file can be mapped and read in place:
+// header | objects table | commands table | commands | arguments | string pool
+//
+// Object ids are reused once an object is gone, so the objects table has an entry per id and
+// name pair and every command points at its own entry. The fingerprints are the ones of the
+// token tables when recording started.
+typedef struct {
+    char magic[4];
+    boost::uint32_t version;
+    boost::uint32_t objectsFingerprint;
+    boost::uint32_t commandsFingerprint;
+    boost::uint32_t totalObjects;
+    boost::uint32_t totalCommandNames;
+    boost::uint32_t totalCommands;
+    boost::uint32_t totalArguments;
+    boost::uint32_t poolSize;
+} script_header_t;
+
+typedef struct {
+    boost::uint32_t id;
+    boost::uint32_t offset;
+    boost::uint32_t length;
+} script_token_t;
+
+typedef struct {
+    boost::uint32_t frame;
+    boost::uint32_t idObject;
+    boost::uint32_t objectToken;
+    boost::uint32_t idCommand;
+    boost::uint32_t firstArgument;
+    boost::uint32_t totalArguments;
+} script_command_t;
+
+typedef struct {
+    boost::uint32_t offset;
+    boost::uint32_t length;
+    boost::uint32_t type;
+} script_argument_t;
+
+class BinaryScriptWriter {
+public:
+    BinaryScriptWriter();
+
+    size_t getTotalCommands() const;
+
+    void clear();
+    void appendCommand(const Command& cmd, const size_t frame = 0);
+    bool save(const std::string& fileName) const;
+
+private:
+    typedef std::map<size_t, boost::uint32_t> token_index_t;
+    typedef std::map<std::pair<size_t, std::string>, boost::uint32_t> object_index_t;
+
+    boost::uint32_t m_objectsFingerprint;
+    boost::uint32_t m_commandsFingerprint;
+    std::vector<script_token_t> m_objects;
+    std::vector<script_token_t> m_commandNames;
+    std::vector<script_command_t> m_commands;
+    std::vector<script_argument_t> m_arguments;
+    std::string m_pool;
+    std::map<std::string, boost::uint32_t> m_poolOffsets;
+    object_index_t m_objectIndices;
+    token_index_t m_commandIndices;
+
+    void appendCommand(const size_t idObject, const size_t idCommand, const std::deque<std::string>& arguments, const size_t frame);
+    boost::uint32_t appendToken(const size_t id, const std::string& name, std::vector<script_token_t>& tokens);
+    boost::uint32_t appendToPool(const std::string& str);
+};
+
+class BinaryScript {
+public:
+    BinaryScript();
+
+    static bool isBinaryScript(const std::string& fileName);
+
+    bool load(const std::string& fileName);
+    void close();
+    bool isRemapped() const;
+    size_t getTotalCommands() const;
+    size_t getFrame(const size_t i) const;
+    argument_type_t getArgumentType(const size_t i, const size_t argument) const;
+    bool getCommand(const size_t i, Command& cmd) const;
+
+private:
+    boost::interprocess::mapped_region m_region;
+    const script_header_t* m_header;
+    const script_token_t* m_objects;
+    const script_token_t* m_commandNames;
+    const script_command_t* m_commands;
+    const script_argument_t* m_arguments;
+    const char* m_pool;
+    bool m_isRemapped;
+    std::vector<boost::uint32_t> m_commandTokens;
+    mutable std::vector<size_t> m_commandIds;
+
+    BinaryScript(const BinaryScript& rhs);
+    BinaryScript& operator=(const BinaryScript& rhs);
+
+    bool indexTokens(const script_token_t* tokens, const size_t totalTokens, std::vector<boost::uint32_t>& tokenIndices, std::vector<size_t>& ids) const;
+    bool resolveObjectId(const size_t objectToken, size_t& id) const;
+    bool resolveId(const size_t storedId, const script_token_t* tokens, const std::vector<boost::uint32_t>& tokenIndices, const TokenTable& table, std::vector<size_t>& ids, size_t& id) const;
+};
+
+
+
+inline size_t BinaryScriptWriter::getTotalCommands() const {
+    return m_commands.size();
+}
+
+inline bool BinaryScript::isRemapped() const {
+    return m_isRemapped;
+}
+
+inline size_t BinaryScript::getTotalCommands() const {
+    return m_header != 0? m_header->totalCommands : 0;
+}
+
+inline size_t BinaryScript::getFrame(const size_t i) const {
+    return m_commands[i].frame;
+}
+
+inline argument_type_t BinaryScript::getArgumentType(const size_t i, const size_t argument) const {
+    return argument_type_t(m_arguments[m_commands[i].firstArgument + argument].type);
+}
+
+#endif // BINARYSCRIPT_HPP
@@ -33,11 +33,15 @@
 #include <string>
 #include <deque>
 
+const char COMMENT_CHAR = '#';
+
 class Terminal;
+class BinaryScript;
 
 class Command {
 public:
     friend class Terminal;
+    friend class BinaryScript;
     friend std::ostream& operator<<(std::ostream& out, const Command& rhs);
     friend std::istream& operator>>(std::istream& in, Command& rhs);
 
@@ -45,9 +49,12 @@ public:
 
     size_t getIdObject() const;
     size_t getIdCommand() const;
+    bool isSelection() const;
+    const std::string& getSelector() const;
     const std::deque<std::string>& getArguments() const;
     std::deque<std::string>& arguments();
     const std::string& getArgument(const size_t i) const;
+    bool getArgumentAsNumber(const size_t i, double& number) const;
     void setArguments(const std::deque<std::string>& args);
     const std::string& getOutput() const;
 
@@ -57,6 +64,7 @@ public:
 private:
     size_t m_idObject;
     size_t m_idCommand;
+    std::string m_selector;
     std::deque<std::string> m_arguments;
     std::string m_output;
     std::string m_empty;
@@ -74,6 +82,14 @@ inline size_t Command::getIdCommand() const {
     return m_idCommand;
 }
 
+inline bool Command::isSelection() const {
+    return !m_selector.empty();
+}
+
+inline const std::string& Command::getSelector() const {
+    return m_selector;
+}
+
 inline const std::deque<std::string>& Command::getArguments() const {
     return m_arguments;
 }
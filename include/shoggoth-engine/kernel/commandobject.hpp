@@ -30,19 +30,29 @@
 #include <string>
 #include <deque>
 #include <map>
-#include <boost/function.hpp>
-#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
+#include "shoggoth-engine/common/delegate.hpp"
 
 class Command;
+class AsyncJob;
+
+// how several queued calls of the same command on the same object can be merged
+typedef enum {
+    COALESCE_NONE,  // every call must run
+    COALESCE_SUM,   // numeric arguments are added (relative moves and rotations)
+    COALESCE_LAST   // only the last call matters (setters)
+} coalesce_t;
 
 class CommandObject {
 
 public:
     friend std::ostream& operator<<(std::ostream& out, const CommandObject& rhs);
 
-    typedef boost::function<std::string (std::deque<std::string>&)> slot_t;
+    typedef Delegate<std::string (std::deque<std::string>&)> slot_t;
+    typedef Delegate<std::string (std::deque<std::string>&, AsyncJob*&)> async_slot_t;
     typedef std::map<size_t, slot_t> cmd_table_t;
+    typedef std::map<size_t, async_slot_t> async_cmd_table_t;
+    typedef std::map<size_t, coalesce_t> coalesce_table_t;
 
     CommandObject(const std::string& objectName);
     virtual ~CommandObject();
@@ -54,10 +64,12 @@ public:
 
     bool isCommandFound(const size_t idCommand) const;
     bool isAttributeFound(const size_t idAttribute) const;
+    coalesce_t getCoalescing(const size_t idCommand) const;
 
     bool runObjectCommand(const size_t idCommand, std::deque<std::string>& arguments, std::string& output);
 
-    size_t registerCommand(const std::string& cmd, const slot_t& slot);
+    size_t registerCommand(const std::string& cmd, const slot_t& slot, const coalesce_t coalescing = COALESCE_NONE);
+    size_t registerAsyncCommand(const std::string& cmd, const async_slot_t& slot);
     size_t registerAttribute(const std::string& attrName, const slot_t& slot);
     void unregisterCommand(const std::string& cmd);
     void unregisterAttribute(const std::string& attrName);
@@ -70,8 +82,11 @@ protected:
 
 private:
     cmd_table_t m_commands;
+    async_cmd_table_t m_asyncCommands;
     cmd_table_t m_attributes;
+    coalesce_table_t m_coalescing;
 
+    std::string runAsyncCommand(async_slot_t& slot, std::deque<std::string>& arguments);
     std::string cmdSetAttribute(std::deque<std::string>& arg);
 };
 
@@ -89,7 +104,7 @@ inline bool CommandObject::isCommandFound(const size_t idCommand) const {
     cmd_table_t::const_iterator it = m_commands.find(idCommand);
     if (it != m_commands.end())
         return true;
-    return false;
+    return m_asyncCommands.find(idCommand) != m_asyncCommands.end();
 }
 
 inline bool CommandObject::isAttributeFound(const size_t idAttribute) const {
@@ -99,4 +114,11 @@ inline bool CommandObject::isAttributeFound(const size_t idAttribute) const {
     return false;
 }
 
+inline coalesce_t CommandObject::getCoalescing(const size_t idCommand) const {
+    coalesce_table_t::const_iterator it = m_coalescing.find(idCommand);
+    if (it != m_coalescing.end())
+        return it->second;
+    return COALESCE_NONE;
+}
+
 #endif // COMMANDOBJECT_HPP
@@ -0,0 +1,76 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef COMMANDPROFILER_HPP
+#define COMMANDPROFILER_HPP
+
+#include <string>
+#include <map>
+#include <utility>
+#include <boost/cstdint.hpp>
+
+// Per object and command counters filled by CommandObject::runObjectCommand while enabled.
+// Times include any command run from inside the measured one. Counters are kept by name,
+// object ids are reused by later objects.
+class CommandProfiler {
+public:
+    static bool isEnabled();
+    static void setEnabled(const bool isEnabled);
+
+    static void record(const std::string& objectName, const std::string& commandName, const boost::uint64_t nanoseconds, const boost::uint64_t allocations);
+    static void reset();
+    static std::string report(const size_t maxEntries);
+    static bool exportCsv(const std::string& fileName);
+
+private:
+    typedef struct {
+        std::string objectName;
+        std::string commandName;
+        boost::uint64_t calls;
+        boost::uint64_t totalTime;
+        boost::uint64_t maxTime;
+        boost::uint64_t allocations;
+    } command_stats_t;
+
+    typedef std::map<std::pair<std::string, std::string>, command_stats_t> stats_table_t;
+
+    static bool ms_isEnabled;
+    static stats_table_t ms_stats;
+
+    static bool isSlower(const command_stats_t* lhs, const command_stats_t* rhs);
+};
+
+
+
+inline bool CommandProfiler::isEnabled() {
+    return ms_isEnabled;
+}
+
+inline void CommandProfiler::setEnabled(const bool isEnabled) {
+    ms_isEnabled = isEnabled;
+}
+
+#endif // COMMANDPROFILER_HPP
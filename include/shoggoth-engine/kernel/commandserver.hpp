@@ -0,0 +1,76 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef COMMANDSERVER_HPP
+#define COMMANDSERVER_HPP
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+// Optional endpoint to drive the engine from other processes, polled once per frame
+// from Terminal::processCommandsQueue and never blocking it.
+//
+// Endpoints are "unix:<path>" or "tcp:<port>" (bound to the loopback interface only).
+// Clients send batches of commands, one per line, each batch ended by an empty line.
+// A batch runs in a single pass and is answered with a header line
+// "batch <commands> <bytes> <microseconds>" followed by <bytes> of command outputs.
+class CommandServer {
+public:
+    static bool isListening();
+    static const std::string& getEndpoint();
+
+    static bool listen(const std::string& endpoint);
+    static void close();
+    static void requestClose();
+    static void poll();
+    static std::string statsToString();
+
+private:
+    static std::string ms_endpoint;
+    static bool ms_isClosePending;
+    static boost::uint64_t ms_startTime;
+    static boost::uint64_t ms_totalBatches;
+    static boost::uint64_t ms_totalCommands;
+    static boost::uint64_t ms_totalTime;
+    static boost::uint64_t ms_bytesReceived;
+    static boost::uint64_t ms_bytesSent;
+
+    static void acceptConnections();
+    static std::string runBatch(const std::vector<std::string>& lines);
+};
+
+
+
+inline bool CommandServer::isListening() {
+    return !ms_endpoint.empty();
+}
+
+inline const std::string& CommandServer::getEndpoint() {
+    return ms_endpoint;
+}
+
+#endif // COMMANDSERVER_HPP
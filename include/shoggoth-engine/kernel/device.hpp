@@ -29,19 +29,26 @@
 
 #include <string>
 #include <set>
+#include <vector>
+#include <boost/cstdint.hpp>
 #include "commandobject.hpp"
 #include "inputs.hpp"
+#include "inputbuffer.hpp"
 
 struct SDL_Surface;
 
 class Device: public CommandObject {
 public:
-    Device(const std::string& objectName);
+    Device(const std::string& objectName, const bool isHeadless = false);
     ~Device();
 
+    bool isHeadless() const;
     Inputs* getInputs();
+    const InputBuffer& getInputBuffer() const;
+    boost::uint64_t getFrameFirstEvent() const;
     double getDeltaTime() const;
     double getFps() const;
+    void setFixedDeltaTime(const double fixedDeltaTime);
 
     void onFrameStart();
     void onFrameEnd();
@@ -52,9 +59,12 @@ public:
     void setResolution(const size_t width, const size_t height);
     size_t getWinWidth() const;
     size_t getWinHeight() const;
+    void pushInputEvent(const input_event_t& input);
+    void pollEvents(bool& isRunning);
     void processEvents(bool& isRunning);
 
 protected:
+    bool m_isHeadless;
     size_t m_width;
     size_t m_height;
     size_t m_halfWidth;
@@ -62,12 +72,19 @@ protected:
     size_t m_depth;
     std::set<size_t> m_keysPressed;
     std::set<size_t> m_mouseButtonsPressed;
+    InputBuffer m_inputBuffer;
+    boost::uint64_t m_frameFirstEvent;
+    bool m_isMouseWarped;
+    std::vector<input_event_t> m_syntheticEvents;
     static Inputs ms_inputs;
     static SDL_Surface* ms_screen;
-    double m_startTime;
+    boost::uint64_t m_startTime;
     double m_deltaTime;
+    double m_fixedDeltaTime;
     double m_fps;
 
+    void bufferEvent(const input_event_t& input);
+
     std::string cmdSwapBuffers(std::deque<std::string>&);
     std::string cmdTitle(std::deque<std::string>& args);
     std::string cmdFullscreen(std::deque<std::string>& args);
@@ -76,10 +93,22 @@ protected:
 
 
 
+inline bool Device::isHeadless() const {
+    return m_isHeadless;
+}
+
 inline Inputs* Device::getInputs() {
     return &ms_inputs;
 }
 
+inline const InputBuffer& Device::getInputBuffer() const {
+    return m_inputBuffer;
+}
+
+inline boost::uint64_t Device::getFrameFirstEvent() const {
+    return m_frameFirstEvent;
+}
+
 inline double Device::getDeltaTime() const {
     return m_deltaTime;
 }
@@ -88,6 +117,12 @@ inline double Device::getFps() const {
     return m_fps;
 }
 
+inline void Device::setFixedDeltaTime(const double fixedDeltaTime) {
+    m_fixedDeltaTime = fixedDeltaTime;
+    if (m_fixedDeltaTime > 0.0)
+        m_deltaTime = m_fixedDeltaTime;
+}
+
 
 
 inline std::string Device::cmdSwapBuffers(std::deque<std::string>&) {
@@ -35,6 +35,7 @@
 #include "shoggoth-engine/renderer/culling.hpp"
 #include "commandobject.hpp"
 #include "component.hpp"
+#include "objectselector.hpp"
 
 class Device;
 class Component;
@@ -45,6 +46,8 @@ typedef enum {
     SPACE_GLOBAL
 } transform_space_t;
 
+const size_t TRANSFORM_NOT_INTERPOLATED = size_t(-1);
+
 class Entity: public CommandObject {
 public:
     friend class Component;
@@ -63,6 +66,8 @@ public:
     const Vector3& getPositionRel() const;
     const Quaternion& getOrientationAbs() const;
     const Quaternion& getOrientationRel() const;
+    Vector3 getInterpolatedPositionAbs(const scalar_t& alpha) const;
+    Quaternion getInterpolatedOrientationAbs(const scalar_t& alpha) const;
     const Component* getComponent(const std::string& componentName) const;
     Component* component(const std::string& componentName);
     const_child_iterator_t getChildrenBegin() const;
@@ -107,6 +112,9 @@ public:
     void removeAllChildren();
     std::string treeToString(const size_t indent) const;
 
+    static void beginSimulationStep();
+    static void endSimulationStep();
+
 private:
     Entity* m_parent;
     const Device* m_device;
@@ -117,6 +125,12 @@ private:
     Quaternion m_orientationAbs;
     Quaternion m_orientationRel;
     Quaternion m_lastOrientation;
+    Vector3 m_previousPositionAbs;
+    Quaternion m_previousOrientationAbs;
+    size_t m_previousStep;
+
+    static size_t ms_simulationStep;
+    static bool ms_isSimulationStep;
 
     Entity(const Entity& rhs);
     Entity& operator=(const Entity&);
@@ -124,6 +138,7 @@ private:
     void applyTranslationToChildren();
     void applyOrientationToChildren();
     void applyTransformToPhysicsComponent();
+    void savePreviousTransform();
 
     std::string cmdPositionAbs(std::deque<std::string>& args);
     std::string cmdPositionRel(std::deque<std::string>& args);
@@ -179,6 +194,18 @@ inline const Quaternion& Entity::getOrientationRel() const {
     return m_orientationRel;
 }
 
+inline Vector3 Entity::getInterpolatedPositionAbs(const scalar_t& alpha) const {
+    if (m_previousStep != ms_simulationStep)
+        return m_positionAbs;
+    return m_previousPositionAbs.lerp(m_positionAbs, alpha);
+}
+
+inline Quaternion Entity::getInterpolatedOrientationAbs(const scalar_t& alpha) const {
+    if (m_previousStep != ms_simulationStep)
+        return m_orientationAbs;
+    return m_previousOrientationAbs.slerp(m_orientationAbs, alpha);
+}
+
 inline const Component* Entity::getComponent(const std::string& componentName) const {
     std::map<std::string, Component*>::const_iterator it;
     it = m_components.find(componentName);
@@ -231,11 +258,22 @@ inline Entity::component_iterator_t Entity::getComponentEnd() {
 
 
 
+inline void Entity::beginSimulationStep() {
+    ++ms_simulationStep;
+    ms_isSimulationStep = true;
+}
+
+inline void Entity::endSimulationStep() {
+    ms_isSimulationStep = false;
+}
+
 inline void Entity::setParent(Entity* _parent) {
     m_parent = _parent;
+    ObjectSelector::invalidate();
 }
 
 inline void Entity::setPositionAbs(const Vector3& position) {
+    savePreviousTransform();
     m_positionAbs = position;
     m_positionRel = m_positionAbs - m_parent->m_positionAbs;
     applyTransformToPhysicsComponent();
@@ -247,6 +285,7 @@ inline void Entity::setPositionAbs(const scalar_t& posX, const scalar_t& posY, c
 }
 
 inline void Entity::setPositionRel(const Vector3& position) {
+    savePreviousTransform();
     m_positionRel = position;
     m_positionAbs = m_positionRel + m_parent->m_positionAbs;
     applyTransformToPhysicsComponent();
@@ -258,6 +297,7 @@ inline void Entity::setPositionRel(const scalar_t& posX, const scalar_t& posY, c
 }
 
 inline void Entity::setOrientationAbs(const Quaternion& orientation) {
+    savePreviousTransform();
     m_lastOrientation = m_orientationAbs;
     m_orientationAbs = orientation.normalized();
     m_orientationRel = (m_parent->m_orientationAbs.inverse() * m_orientationAbs).normalized();
@@ -278,6 +318,7 @@ inline void Entity::setOrientationAbs(const scalar_t& yawRad, const scalar_t& pi
 }
 
 inline void Entity::setOrientationRel(const Quaternion& orientation) {
+    savePreviousTransform();
     m_lastOrientation = m_orientationAbs;
     m_orientationRel = orientation.normalized();
     m_orientationAbs = (m_parent->m_orientationAbs * m_orientationRel).normalized();
@@ -342,4 +383,16 @@ inline std::string Entity::cmdRemoveAllChildren(std::deque<std::string>&) {
     return "";
 }
 
+inline void Entity::savePreviousTransform() {
+    // Changes made by a simulation step are interpolated from the transform the step started
+    // from, anything else (commands, teleports) is shown right away
+    if (!ms_isSimulationStep)
+        m_previousStep = TRANSFORM_NOT_INTERPOLATED;
+    else if (m_previousStep != ms_simulationStep) {
+        m_previousPositionAbs = m_positionAbs;
+        m_previousOrientationAbs = m_orientationAbs;
+        m_previousStep = ms_simulationStep;
+    }
+}
+
 #endif // ENTITY_HPP
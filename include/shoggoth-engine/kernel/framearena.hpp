@@ -0,0 +1,154 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef FRAMEARENA_HPP
+#define FRAMEARENA_HPP
+
+#include <string>
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+const size_t DEFAULT_FRAME_ARENA_BYTES = 256 * 1024;
+
+// Bump allocator for memory that is gone by the end of the frame, on the main thread only.
+// Allocating moves an offset, freeing does nothing and reset() takes everything back at once,
+// from Device::onFrameEnd. A frame that outgrows the block gets extra blocks from the heap,
+// and the next reset replaces them with a single block big enough for that frame, so once the
+// arena has grown a steady frame takes nothing from the heap.
+class FrameArena {
+public:
+    static void* allocate(const size_t bytes, const size_t alignment);
+    static void reset();
+
+    static size_t getCapacity();
+    static size_t getUsedBytes();
+    static size_t getHighWaterBytes();
+    static std::string report();
+
+private:
+    static char* ms_block;
+    static size_t ms_capacity;
+    static size_t ms_offset;
+    static size_t ms_frameBytes;
+    static size_t ms_highWaterBytes;
+    static std::vector<char*> ms_overflowBlocks;
+    static boost::uint64_t ms_lastAllocations;
+    static boost::uint64_t ms_frameAllocations;
+};
+
+// STL allocator on the FrameArena, for containers that do not outlive the frame:
+//     typedef std::set<RenderableMesh*, std::less<RenderableMesh*>, FrameAllocator<RenderableMesh*> > set_t;
+template <typename T>
+class FrameAllocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef FrameAllocator<U> other;
+    };
+
+    FrameAllocator() {}
+    FrameAllocator(const FrameAllocator&) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    pointer address(reference x) const;
+    const_pointer address(const_reference x) const;
+    pointer allocate(const size_type n, const void* = 0);
+    void deallocate(pointer, const size_type) {}
+    size_type max_size() const;
+    void construct(pointer p, const T& value);
+    void destroy(pointer p);
+};
+
+
+
+inline size_t FrameArena::getCapacity() {
+    return ms_capacity;
+}
+
+inline size_t FrameArena::getUsedBytes() {
+    return ms_frameBytes;
+}
+
+inline size_t FrameArena::getHighWaterBytes() {
+    return ms_highWaterBytes;
+}
+
+
+
+template <typename T>
+inline typename FrameAllocator<T>::pointer FrameAllocator<T>::address(reference x) const {
+    return &x;
+}
+
+template <typename T>
+inline typename FrameAllocator<T>::const_pointer FrameAllocator<T>::address(const_reference x) const {
+    return &x;
+}
+
+template <typename T>
+inline typename FrameAllocator<T>::pointer FrameAllocator<T>::allocate(const size_type n, const void*) {
+    return static_cast<pointer>(FrameArena::allocate(n * sizeof(T), boost::alignment_of<T>::value));
+}
+
+template <typename T>
+inline typename FrameAllocator<T>::size_type FrameAllocator<T>::max_size() const {
+    return size_type(-1) / sizeof(T);
+}
+
+template <typename T>
+inline void FrameAllocator<T>::construct(pointer p, const T& value) {
+    new (static_cast<void*>(p)) T(value);
+}
+
+template <typename T>
+inline void FrameAllocator<T>::destroy(pointer p) {
+    p->~T();
+}
+
+// the arena is shared, any two allocators can free each other's memory
+template <typename T, typename U>
+inline bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) {
+    return false;
+}
+
+#endif // FRAMEARENA_HPP
@@ -0,0 +1,84 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef FRAMEPACER_HPP
+#define FRAMEPACER_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include "commandobject.hpp"
+#include "histogram.hpp"
+
+const double DEFAULT_TARGET_FPS = 60.0;
+const double MIN_TARGET_FPS = 1.0e-3; // a period of at most 1000 s
+const double MAX_TARGET_FPS = 1.0e9; // a period of at least 1 ns
+const boost::uint64_t DEFAULT_SPIN_TIME = 500000;
+
+// Holds frames to an exact period, from the end of one wait() to the end of the next, so the
+// whole frame counts and not only the drawing. It sleeps until DEFAULT_SPIN_TIME before the
+// deadline, as the scheduler may wake it late, and yields in a loop for the rest. A late frame
+// starts the next period from its end instead of rushing to catch up.
+// A target of 0 fps turns pacing off.
+class FramePacer: public CommandObject {
+public:
+    FramePacer(const std::string& objectName);
+    ~FramePacer();
+
+    double getTargetFps() const;
+    void setTargetFps(const double targetFps);
+    void setSpinTime(const boost::uint64_t spinTime);
+
+    void reset();
+    void wait();
+    std::string report() const;
+
+private:
+    boost::uint64_t m_period;
+    boost::uint64_t m_spinTime;
+    boost::uint64_t m_deadline;
+    boost::uint64_t m_lastFrameEnd;
+    boost::uint64_t m_totalFrames;
+    boost::uint64_t m_lateFrames;
+    boost::uint64_t m_totalSpinTime;
+    Histogram m_errors;
+
+    std::string cmdTargetFps(std::deque<std::string>& args);
+    std::string cmdSpinTime(std::deque<std::string>& args);
+    std::string cmdStats(std::deque<std::string>&);
+    std::string cmdStatsReset(std::deque<std::string>&);
+};
+
+
+
+inline double FramePacer::getTargetFps() const {
+    return m_period > 0? 1.0e9 / double(m_period) : 0.0;
+}
+
+inline void FramePacer::setSpinTime(const boost::uint64_t spinTime) {
+    m_spinTime = spinTime;
+}
+
+#endif // FRAMEPACER_HPP
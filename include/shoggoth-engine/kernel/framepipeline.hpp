@@ -0,0 +1,82 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef FRAMEPIPELINE_HPP
+#define FRAMEPIPELINE_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "shoggoth-engine/common/delegate.hpp"
+
+class SimulationLoop;
+
+// Runs the fixed steps of a frame on a worker thread while the caller draws the frame built
+// before them, so a frame costs about max(steps, draw) instead of their sum. The worker owns
+// the entities from startStage() until waitStage() returns: only an already built frame can
+// be drawn meanwhile, and commands run before starting the next stage.
+//
+//     renderer.buildFrame(loop.getAlpha());
+//     pipeline.startStage();
+//     renderer.submitFrame();
+//     pipeline.waitStage();
+//
+// What is drawn is one frame behind the serial loop, the worker starts on the first stage.
+class FramePipeline {
+public:
+    typedef Delegate<void (const double)> step_slot_t;
+
+    FramePipeline(SimulationLoop* simulationLoop, const step_slot_t& stepSlot);
+    ~FramePipeline();
+
+    bool isStageRunning() const;
+    void startStage();
+    void waitStage();
+    std::string report() const;
+    void reset();
+
+private:
+    SimulationLoop* m_simulationLoop;
+    step_slot_t m_stepSlot;
+    boost::thread* m_worker;
+    mutable boost::mutex m_mutex;
+    boost::condition_variable m_condition;
+    bool m_isStageRunning;
+    bool m_isShuttingDown;
+    boost::uint64_t m_totalStages;
+    boost::uint64_t m_stageTime;
+    boost::uint64_t m_waitTime;
+
+    FramePipeline(const FramePipeline& rhs);
+    FramePipeline& operator=(const FramePipeline& rhs);
+
+    void runWorker();
+    void runStage();
+};
+
+#endif // FRAMEPIPELINE_HPP
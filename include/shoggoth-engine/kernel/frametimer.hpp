@@ -0,0 +1,94 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef FRAMETIMER_HPP
+#define FRAMETIMER_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include "shoggoth-engine/common/clock.hpp"
+#include "histogram.hpp"
+
+const size_t FRAME_WINDOW_FRAMES = 600;
+const size_t FRAME_HISTORY = 1200;
+
+typedef enum {
+    FRAME_PHASE_EVENTS,
+    FRAME_PHASE_COMMANDS,
+    FRAME_PHASE_PHYSICS,
+    FRAME_PHASE_CULLING,
+    FRAME_PHASE_DRAW,
+    FRAME_PHASE_SWAP,
+    FRAME_PHASE_TOTAL,
+    TOTAL_FRAME_PHASES
+} frame_phase_t;
+
+// Nanosecond time spent on each phase of the frame. A phase may run several times per frame
+// (physics steps) and its time is added up. Frames feed two histograms per phase that take
+// turns every FRAME_WINDOW_FRAMES frames, so reports cover the last 600 to 1200 frames and
+// old stutters age out, and the last FRAME_HISTORY frames are kept raw for CSV dumps.
+class FrameTimer {
+public:
+    static void beginPhase(const frame_phase_t phase);
+    static void endPhase(const frame_phase_t phase);
+    static void endFrame(const boost::uint64_t frameTime);
+
+    static boost::uint64_t getTotalFrames();
+    static double getMeanFrameTime();
+    static void getHistogram(const frame_phase_t phase, Histogram& histogram);
+    static void reset();
+    static std::string report();
+    static bool exportCsv(const std::string& fileName);
+
+private:
+    typedef struct {
+        boost::uint64_t phases[TOTAL_FRAME_PHASES];
+    } frame_times_t;
+
+    static boost::uint64_t ms_phaseStart[TOTAL_FRAME_PHASES];
+    static frame_times_t ms_frame;
+    static frame_times_t ms_history[FRAME_HISTORY];
+    static boost::uint64_t ms_totalFrames;
+    static Histogram ms_windows[2][TOTAL_FRAME_PHASES];
+    static size_t ms_window;
+    static size_t ms_windowFrames;
+};
+
+
+
+inline void FrameTimer::beginPhase(const frame_phase_t phase) {
+    ms_phaseStart[phase] = Clock::nanoseconds();
+}
+
+inline void FrameTimer::endPhase(const frame_phase_t phase) {
+    ms_frame.phases[phase] += Clock::nanoseconds() - ms_phaseStart[phase];
+}
+
+inline boost::uint64_t FrameTimer::getTotalFrames() {
+    return ms_totalFrames;
+}
+
+#endif // FRAMETIMER_HPP
@@ -0,0 +1,83 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <boost/cstdint.hpp>
+
+const size_t HISTOGRAM_SUB_BUCKET_BITS = 3;
+const size_t HISTOGRAM_BUCKETS = 512;
+
+// Fixed size histogram of unsigned values, usually nanoseconds. Every power of two is split
+// in 8 linear buckets, so percentiles are within 12.5% of the real value over the whole
+// 64 bit range, while recording is a few shifts and never allocates.
+class Histogram {
+public:
+    Histogram();
+
+    boost::uint64_t getCount() const;
+    boost::uint64_t getMax() const;
+    double getMean() const;
+    boost::uint64_t getPercentile(const double percentile) const;
+
+    void record(const boost::uint64_t value);
+    void add(const Histogram& rhs);
+    void reset();
+
+private:
+    boost::uint64_t m_buckets[HISTOGRAM_BUCKETS];
+    boost::uint64_t m_count;
+    boost::uint64_t m_total;
+    boost::uint64_t m_max;
+
+    static size_t findBucket(const boost::uint64_t value);
+    static boost::uint64_t getBucketLimit(const size_t bucket);
+};
+
+
+
+inline boost::uint64_t Histogram::getCount() const {
+    return m_count;
+}
+
+inline boost::uint64_t Histogram::getMax() const {
+    return m_max;
+}
+
+inline double Histogram::getMean() const {
+    return m_count > 0? double(m_total) / double(m_count) : 0.0;
+}
+
+inline void Histogram::record(const boost::uint64_t value) {
+    ++m_buckets[findBucket(value)];
+    ++m_count;
+    m_total += value;
+    if (value > m_max)
+        m_max = value;
+}
+
+#endif // HISTOGRAM_HPP
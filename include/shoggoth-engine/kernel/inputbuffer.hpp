@@ -0,0 +1,89 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef INPUTBUFFER_HPP
+#define INPUTBUFFER_HPP
+
+#include <boost/cstdint.hpp>
+#include "inputs.hpp"
+
+const size_t INPUT_BUFFER_CAPACITY = 256;
+
+typedef struct {
+    input_t type;
+    boost::uint64_t time;   // Clock::nanoseconds() when the event was polled
+    size_t code;            // key or mouse button
+    mouse_motion_t motion;
+} input_event_t;
+
+// Fixed capacity ring of raw input events. Every event gets a sequence number that never
+// wraps, so readers remember the last sequence they consumed and walk forward from there
+// without copying or allocating; only the newest INPUT_BUFFER_CAPACITY events are kept.
+class InputBuffer {
+public:
+    InputBuffer();
+
+    boost::uint64_t getTotalEvents() const;
+    boost::uint64_t getOldestSequence() const;
+    const input_event_t* getEvent(const boost::uint64_t sequence) const;
+    input_event_t* getNewestEvent();
+
+    void push(const input_event_t& event);
+    void clear();
+
+private:
+    input_event_t m_events[INPUT_BUFFER_CAPACITY];
+    boost::uint64_t m_totalEvents;
+};
+
+
+
+inline boost::uint64_t InputBuffer::getTotalEvents() const {
+    return m_totalEvents;
+}
+
+inline boost::uint64_t InputBuffer::getOldestSequence() const {
+    return m_totalEvents > INPUT_BUFFER_CAPACITY? m_totalEvents - INPUT_BUFFER_CAPACITY : 0;
+}
+
+inline const input_event_t* InputBuffer::getEvent(const boost::uint64_t sequence) const {
+    if (sequence < getOldestSequence() || sequence >= m_totalEvents)
+        return 0;
+    return &m_events[sequence % INPUT_BUFFER_CAPACITY];
+}
+
+inline input_event_t* InputBuffer::getNewestEvent() {
+    if (m_totalEvents == 0)
+        return 0;
+    return &m_events[(m_totalEvents - 1) % INPUT_BUFFER_CAPACITY];
+}
+
+inline void InputBuffer::push(const input_event_t& event) {
+    m_events[m_totalEvents % INPUT_BUFFER_CAPACITY] = event;
+    ++m_totalEvents;
+}
+
+#endif // INPUTBUFFER_HPP
@@ -0,0 +1,76 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef INPUTLATENCY_HPP
+#define INPUTLATENCY_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include "histogram.hpp"
+
+typedef enum {
+    LATENCY_EVENT_TO_COMMAND,
+    LATENCY_COMMAND_TO_DRAW,
+    LATENCY_DRAW_TO_SWAP,
+    LATENCY_EVENT_TO_SWAP,
+    TOTAL_LATENCY_STAGES
+} latency_stage_t;
+
+// Input to photon latency, measured while enabled. Device stamps every input event when
+// it is polled, the stamp is carried by the bound commands through the Terminal queue, and
+// the oldest input run on a frame is followed until the swap that shows it.
+class InputLatency {
+public:
+    static bool isEnabled();
+    static void setEnabled(const bool isEnabled);
+
+    static void onCommand(const boost::uint64_t inputTime);
+    static void onDraw();
+    static void onSwap();
+
+    static const Histogram& getHistogram(const latency_stage_t stage);
+    static void reset();
+    static std::string report();
+
+private:
+    static bool ms_isEnabled;
+    static Histogram ms_histograms[TOTAL_LATENCY_STAGES];
+    static boost::uint64_t ms_frameInputTime;
+    static boost::uint64_t ms_frameCommandTime;
+    static boost::uint64_t ms_frameDrawTime;
+};
+
+
+
+inline bool InputLatency::isEnabled() {
+    return ms_isEnabled;
+}
+
+inline const Histogram& InputLatency::getHistogram(const latency_stage_t stage) {
+    return ms_histograms[stage];
+}
+
+#endif // INPUTLATENCY_HPP
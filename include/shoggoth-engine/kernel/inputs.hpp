@@ -29,8 +29,10 @@
 
 #include <ostream>
 #include <string>
-#include <vector>
+#include <list>
 #include <map>
+#include <boost/cstdint.hpp>
+#include "command.hpp"
 
 typedef enum {
     INPUT_KEY_PRESS,
@@ -58,24 +60,37 @@ public:
 
     void bindInput(const input_t type, const std::string& command, const size_t code = 0);
     void clearAllBindings();
-    void onKeyPress(const size_t code);
-    void onKeyRelease(const size_t code);
-    void onKeyPressed(const size_t code);
-    void onMouseButtonPress(const size_t code);
-    void onMouseButtonRelease(const size_t code);
-    void onMouseButtonPressed(const size_t code);
-    void onMouseMotion(const mouse_motion_t& motion);
+    void onKeyPress(const size_t code, const boost::uint64_t time = 0);
+    void onKeyRelease(const size_t code, const boost::uint64_t time = 0);
+    void onKeyPressed(const size_t code, const boost::uint64_t time = 0);
+    void onMouseButtonPress(const size_t code, const boost::uint64_t time = 0);
+    void onMouseButtonRelease(const size_t code, const boost::uint64_t time = 0);
+    void onMouseButtonPressed(const size_t code, const boost::uint64_t time = 0);
+    void onMouseMotion(const mouse_motion_t& motion, const boost::uint64_t time = 0);
 
 private:
-    typedef std::map<size_t, std::string> input_map_t;
+    // bound commands are parsed once, and again only after objects were created or deleted.
+    // The terminal queues pointers to them, so binding more inputs must not move the old ones.
+    typedef struct {
+        std::string expression;
+        Command command;
+        size_t generation;
+        bool isResolved;
+    } binding_t;
+    typedef std::map<size_t, binding_t> input_map_t;
+    typedef std::list<binding_t> input_list_t;
+
     input_map_t m_keyPressMap;
     input_map_t m_keyReleaseMap;
     input_map_t m_keyPressedMap;
     input_map_t m_mouseButtonPressMap;
     input_map_t m_mouseButtonReleaseMap;
     input_map_t m_mouseButtonPressedMap;
-    std::vector<std::string> m_mouseMotionList;
+    input_list_t m_mouseMotionList;
     mouse_motion_t m_lastMouseMotion;
+
+    static void pushBinding(input_map_t& bindings, const size_t code, const boost::uint64_t time);
+    static void pushBinding(binding_t& binding, const boost::uint64_t time);
 };
 
 
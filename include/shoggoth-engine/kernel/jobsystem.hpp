@@ -0,0 +1,154 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <boost/cstdint.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/tss.hpp>
+#include "shoggoth-engine/common/delegate.hpp"
+
+// A job runs its slot over the range [begin, end)
+typedef Delegate<void (const size_t, const size_t)> job_slot_t;
+
+typedef enum {
+    JOB_ANY_THREAD,
+    JOB_MAIN_THREAD
+} job_affinity_t;
+
+class JobCounter;
+
+typedef struct {
+    job_slot_t slot;
+    size_t begin;
+    size_t end;
+    JobCounter* counter;
+    job_affinity_t affinity;
+} job_t;
+
+// Jobs submitted with a counter that have not finished yet. Jobs submitted with the counter
+// as their dependency are held until it reaches zero, so counters chain jobs in stages.
+// A counter must outlive its jobs, waiting on it before it goes out of scope is enough.
+class JobCounter {
+public:
+    friend class JobSystem;
+
+    JobCounter();
+
+    bool isDone() const;
+
+private:
+    mutable boost::mutex m_mutex;
+    size_t m_pendingJobs;
+    std::vector<job_t> m_continuations;
+
+    JobCounter(const JobCounter& rhs);
+    JobCounter& operator=(const JobCounter& rhs);
+};
+
+// Work stealing scheduler. Every thread has its own deque of jobs: the owner pushes and pops
+// at the back, so it keeps working on what it just split (and is still in cache), and idle
+// workers steal from the front of the others, taking the oldest and usually largest jobs.
+// The main thread is slot 0: it runs jobs only while waiting on a counter, and it is the only
+// one running JOB_MAIN_THREAD jobs (OpenGL), also once per frame from runMainThreadJobs().
+// A thread waiting on a counter only runs that counter's jobs (and main thread jobs) while
+// there are workers, and sleeps when none is left to take.
+//
+//     JobCounter counter;
+//     JobSystem::parallelFor(0, entities.size(), 64, slot, &counter);
+//     ... other work on the main thread ...
+//     JobSystem::wait(counter);
+//
+// Without initialize() there are no workers and the main thread runs every job while waiting.
+class JobSystem {
+public:
+    static void initialize(const size_t totalWorkers = size_t(-1));
+    static void shutdown();
+    static size_t getTotalWorkers();
+    static bool isMainThread();
+
+    static void submit(const job_slot_t& slot, const size_t begin, const size_t end, JobCounter* counter = 0,
+                       const job_affinity_t affinity = JOB_ANY_THREAD, JobCounter* dependency = 0);
+    static void parallelFor(const size_t begin, const size_t end, const size_t grainSize,
+                            const job_slot_t& slot, JobCounter* counter);
+    static void parallelFor(const size_t begin, const size_t end, const size_t grainSize, const job_slot_t& slot);
+    static void wait(JobCounter& counter);
+    static size_t runMainThreadJobs();
+
+    static std::string report();
+    static void resetStats();
+
+private:
+    struct job_queue_t {
+        boost::mutex mutex;
+        std::deque<job_t> jobs;
+        // slot 0 is shared by the main thread and any other non-worker thread
+        boost::atomic<boost::uint64_t> executedJobs;
+        boost::atomic<boost::uint64_t> stolenJobs;
+
+        job_queue_t(): mutex(), jobs(), executedJobs(0), stolenJobs(0) {}
+    };
+
+    static std::vector<job_queue_t*> ms_queues;
+    static std::vector<boost::thread*> ms_workers;
+    static job_queue_t ms_mainThreadJobs;
+    static boost::thread_specific_ptr<size_t> ms_queueIndex;
+    static boost::thread::id ms_mainThreadId;
+    static boost::mutex ms_sleepMutex;
+    static boost::condition_variable ms_sleepCondition;
+    static boost::condition_variable ms_waitCondition;
+    static boost::uint64_t ms_generation;
+    static bool ms_isShuttingDown;
+
+    static size_t getQueueIndex();
+    static void push(const job_t& job);
+    static bool popOwnJob(const size_t index, job_t& job, const JobCounter* counter);
+    static bool stealJob(const size_t index, job_t& job, const JobCounter* counter);
+    static bool popMainThreadJob(job_t& job);
+    static bool findJob(const size_t index, job_t& job, const JobCounter* counter);
+    static void runJob(const job_t& job);
+    static void finishJob(JobCounter* counter);
+    static void runWorker(const size_t index);
+};
+
+
+
+inline size_t JobSystem::getTotalWorkers() {
+    return ms_workers.size();
+}
+
+inline bool JobSystem::isMainThread() {
+    return boost::this_thread::get_id() == ms_mainThreadId;
+}
+
+#endif // JOBSYSTEM_HPP
@@ -0,0 +1,222 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/atomic.hpp>
+
+typedef enum {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_NONE
+} log_level_t;
+
+// messages below this level are stripped when compiling, see SHOGGOTH_LOG_LEVEL in cmake
+#ifndef SHOGGOTH_LOG_MIN_LEVEL
+#define SHOGGOTH_LOG_MIN_LEVEL 0
+#endif
+const log_level_t LOG_COMPILED_LEVEL = log_level_t(SHOGGOTH_LOG_MIN_LEVEL);
+
+const size_t LOG_MESSAGE_SIZE = 240;
+const size_t LOG_RING_SLOTS = 1024;
+
+// Leveled log, written from any thread without locks or allocations. A message is formatted
+// on the stack and copied into a ring buffer, a background thread writes the ring to cout
+// (debug and info) or cerr (warnings and errors). A message is written like a stream and
+// sent when the statement ends:
+//
+//     LogError() << "could not open file: " << fileName;
+//
+// When the ring is full messages are dropped instead of blocking. A message repeated by the
+// same thread within a second is counted and skipped, the next one after that says how many
+// times it was repeated. Before initialize() and after shutdown() messages are written
+// directly by the thread that logs them.
+class Logger {
+public:
+    static void initialize();
+    static void shutdown();
+    static void flush();
+
+    static log_level_t getLevel();
+    static void setLevel(const log_level_t level);
+    static bool isEnabled(const log_level_t level);
+    static bool parseLevel(const std::string& name, log_level_t& level);
+
+    static void write(const log_level_t level, const char* text, const size_t length);
+    static std::string report();
+    static void resetStats();
+
+private:
+    // set by the terminal while any thread logs
+    static boost::atomic<int> ms_level;
+
+    static void runFlusher();
+    static bool isRepeated(const log_level_t level, const char* text, const size_t length,
+                           boost::uint64_t& repetitions);
+};
+
+// Fixed size text a message is formatted into, longer messages are truncated
+class LogLine {
+public:
+    LogLine(const bool isEnabled);
+
+    bool isEnabled() const;
+    void send(const log_level_t level);
+
+    void append(const char* text);
+    void append(const std::string& text);
+    void append(const char character);
+    void append(const long number);
+    void append(const unsigned long number);
+    void append(const double number);
+
+private:
+    bool m_isEnabled;
+    size_t m_length;
+    char m_text[LOG_MESSAGE_SIZE];
+};
+
+template <log_level_t level>
+class LogMessage {
+public:
+    LogMessage();
+    ~LogMessage();
+
+    LogMessage& operator<<(const char* text);
+    LogMessage& operator<<(const std::string& text);
+    LogMessage& operator<<(const char character);
+    LogMessage& operator<<(const int number);
+    LogMessage& operator<<(const unsigned int number);
+    LogMessage& operator<<(const long number);
+    LogMessage& operator<<(const unsigned long number);
+    LogMessage& operator<<(const double number);
+
+private:
+    LogLine m_line;
+
+    LogMessage(const LogMessage& rhs);
+    LogMessage& operator=(const LogMessage& rhs);
+};
+
+typedef LogMessage<LOG_LEVEL_DEBUG> LogDebug;
+typedef LogMessage<LOG_LEVEL_INFO> LogInfo;
+typedef LogMessage<LOG_LEVEL_WARNING> LogWarning;
+typedef LogMessage<LOG_LEVEL_ERROR> LogError;
+
+
+
+inline log_level_t Logger::getLevel() {
+    return log_level_t(ms_level.load(boost::memory_order_relaxed));
+}
+
+inline void Logger::setLevel(const log_level_t level) {
+    ms_level.store(int(level), boost::memory_order_relaxed);
+}
+
+inline bool Logger::isEnabled(const log_level_t level) {
+    return level >= LOG_COMPILED_LEVEL && int(level) >= ms_level.load(boost::memory_order_relaxed);
+}
+
+
+inline bool LogLine::isEnabled() const {
+    return m_isEnabled;
+}
+
+
+// every operator tests the level first, so a stripped message compiles to nothing
+template <log_level_t level>
+inline LogMessage<level>::LogMessage():
+    m_line(level >= LOG_COMPILED_LEVEL && Logger::isEnabled(level))
+{}
+
+template <log_level_t level>
+inline LogMessage<level>::~LogMessage() {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.send(level);
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const char* text) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append(text);
+    return *this;
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const std::string& text) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append(text);
+    return *this;
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const char character) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append(character);
+    return *this;
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const int number) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append(long(number));
+    return *this;
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const unsigned int number) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append((unsigned long)(number));
+    return *this;
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const long number) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append(number);
+    return *this;
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const unsigned long number) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append(number);
+    return *this;
+}
+
+template <log_level_t level>
+inline LogMessage<level>& LogMessage<level>::operator<<(const double number) {
+    if (level >= LOG_COMPILED_LEVEL && m_line.isEnabled())
+        m_line.append(number);
+    return *this;
+}
+
+#endif // LOGGER_HPP
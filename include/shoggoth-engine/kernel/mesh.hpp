@@ -42,6 +42,7 @@ public:
 
     unsigned int getVboId() const;
     unsigned int getIndicesId() const;
+    unsigned int getVaoId() const;
     float getVertex(const size_t i) const;
     const std::vector<float>& getVertices() const;
     const float* getVerticesPtr() const;
@@ -65,6 +66,7 @@ public:
 
     void setVboId(const unsigned int vboId);
     void setIndicesId(const unsigned int indicesId);
+    void setVaoId(const unsigned int vaoId);
     void setVertices(const std::vector<float>& vertices);
     void setVertices(const float* vertices, const size_t size);
     void setNormals(const std::vector<float>& normals);
@@ -77,6 +79,7 @@ public:
 private:
     unsigned int m_vboId;
     unsigned int m_indicesId;
+    unsigned int m_vaoId;
     std::vector<float> m_vertices;
     std::vector<float> m_normals;
     std::vector<float> m_uvCoords;
@@ -93,6 +96,10 @@ inline unsigned int Mesh::getIndicesId() const {
     return m_indicesId;
 }
 
+inline unsigned int Mesh::getVaoId() const {
+    return m_vaoId;
+}
+
 inline float Mesh::getVertex(const size_t i) const {
     return m_vertices[i];
 }
@@ -183,6 +190,10 @@ inline void Mesh::setIndicesId(const unsigned int indicesId) {
     m_indicesId = indicesId;
 }
 
+inline void Mesh::setVaoId(const unsigned int vaoId) {
+    m_vaoId = vaoId;
+}
+
 inline void Mesh::setVertices(const std::vector< float >& vertices) {
     m_vertices = vertices;
 }
@@ -0,0 +1,80 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef OBJECTSELECTOR_HPP
+#define OBJECTSELECTOR_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+class CommandObject;
+class Entity;
+
+const char SELECTOR_PATH_SEPARATOR = '/';
+const std::string SELECTOR_ANY_DEPTH = "**";
+const char SELECTOR_WAKE_CHAR = '!';
+
+// Resolves an object selector into the objects it names, so one command can be run on all of them.
+//   missile-*            object names matching a glob, with * and ?
+//   root/level1/**       entities under a path, ** matches any number of levels
+//   *[rigidbody]         only entities with the given components, filters can be chained
+//   missile-*!           also wakes every matched rigid body once, after the command ran on all of them
+// Selections are cached until an object, a component or the hierarchy changes.
+class ObjectSelector {
+public:
+    static bool isSelector(const std::string& name);
+    static size_t getGeneration();
+
+    static bool select(const std::string& selector, std::vector<CommandObject*>& objects);
+    static bool runCommand(const std::string& selector, const size_t idCommand, const std::deque<std::string>& arguments, std::string& output);
+    static void invalidate();
+
+private:
+    typedef struct {
+        std::vector<CommandObject*> objects;
+        std::vector<size_t> ids;
+        bool isWakeRequested;
+    } selection_t;
+    typedef std::map<std::string, selection_t> selection_cache_t;
+
+    static selection_cache_t ms_cache;
+    static size_t ms_generation;
+
+    static const selection_t* resolve(const std::string& selector);
+    static void selectByName(const std::string& pattern, std::vector<CommandObject*>& objects);
+    static void selectByPath(const std::vector<std::string>& segments, const size_t segment, Entity* entity, std::vector<CommandObject*>& objects);
+    static bool isGlobMatch(const char* pattern, const char* name);
+};
+
+
+
+inline size_t ObjectSelector::getGeneration() {
+    return ms_generation;
+}
+
+#endif // OBJECTSELECTOR_HPP
@@ -38,10 +38,12 @@ class ComponentFactory;
 class Device;
 class Renderer;
 class PhysicsWorld;
+class AsyncJob;
 
 class Scene: public CommandObject {
 public:
     friend class Entity;
+    friend class LoadSceneJob;
 
     Scene(const std::string& objectName,
           const std::string& rootNodeName,
@@ -55,6 +57,7 @@ public:
 
     Entity* root();
 
+    static void prefetchXML(const std::string& fileName);
     void saveToXML(const std::string& fileName) const;
     bool loadFromXML(const std::string& fileName);
     bool findEntity(const std::string& name, Entity*& entity);
@@ -73,6 +76,9 @@ private:
     Scene(const Scene& rhs);
     Scene& operator=(const Scene&);
 
+    static bool readXML(const std::string& fileName, boost::property_tree::ptree& tree);
+    bool loadFromTree(const std::string& fileName, const boost::property_tree::ptree& tree);
+
     void saveToPTree(const std::string& path,
                      boost::property_tree::ptree& tree,
                      const Entity* node) const;
@@ -84,7 +90,7 @@ private:
                        bool& isCameraFound);
 
     std::string cmdSaveXML(std::deque<std::string>& args);
-    std::string cmdLoadXML(std::deque<std::string>& args);
+    std::string cmdLoadXML(std::deque<std::string>& args, AsyncJob*& job);
 };
 
 
@@ -107,11 +113,4 @@ inline std::string Scene::cmdSaveXML(std::deque<std::string>& args) {
     return "";
 }
 
-inline std::string Scene::cmdLoadXML(std::deque<std::string>& args) {
-    if (args.size() < 1)
-        return "Error: too few arguments";
-    loadFromXML(args[0]);
-    return "";
-}
-
 #endif // SCENE_HPP
@@ -0,0 +1,157 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef SCRIPTVM_HPP
+#define SCRIPTVM_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+class CommandObject;
+
+const std::string SCRIPT_SET = "set";
+const std::string SCRIPT_FOR = "for";
+const std::string SCRIPT_END = "end";
+const char SCRIPT_FORMAT_BEGIN = '{';
+const char SCRIPT_FORMAT_END = '}';
+
+// Runs text scripts that use variables and loops, e.g.
+//   set size 100
+//   for i 0 size
+//     for j 0 size 2
+//       scene add-entity cube-{i}-{j}
+//       cube-{i}-{j} position-abs {i * 2} 0 {j * 2 + 1}
+//     end
+//   end
+// Variables are numbers, "for <var> <from> <to> [step]" runs while var < to (var > to for negative steps),
+// and {expression} in any word of a command is replaced with the value of the expression.
+// A script is compiled once into instructions, then its commands call the object slots directly,
+// looking up object and command ids only when their names are formatted or the objects changed.
+class ScriptVM {
+public:
+    ScriptVM();
+
+    static bool isProgram(const std::vector<std::string>& lines);
+
+    size_t getTotalCommands() const;
+
+    bool compile(const std::vector<std::string>& lines, std::string& error);
+    std::string run();
+
+private:
+    typedef enum {
+        EXPRESSION_NUMBER,
+        EXPRESSION_VARIABLE,
+        EXPRESSION_ADD,
+        EXPRESSION_SUBTRACT,
+        EXPRESSION_MULTIPLY,
+        EXPRESSION_DIVIDE,
+        EXPRESSION_MODULO,
+        EXPRESSION_NEGATE
+    } expression_op_t;
+
+    typedef struct {
+        expression_op_t op;
+        double number;
+        size_t variable;
+    } expression_item_t;
+
+    typedef std::vector<expression_item_t> expression_t; // postfix order
+
+    typedef struct {
+        std::string literal;
+        size_t expression;
+    } text_part_t;
+
+    typedef std::vector<text_part_t> text_t;
+
+    typedef struct {
+        text_t object;
+        text_t command;
+        std::vector<text_t> arguments;
+        size_t idObject;
+        size_t idCommand;
+        size_t generation;
+        bool isSelection;
+    } script_command_t;
+
+    typedef enum {
+        INSTRUCTION_SET,        // variable = expression
+        INSTRUCTION_LOOP_TEST,  // jump past the loop when variable has reached limit
+        INSTRUCTION_LOOP_STEP,  // variable += step, jump back to the test
+        INSTRUCTION_COMMAND
+    } instruction_op_t;
+
+    typedef struct {
+        instruction_op_t op;
+        size_t variable;
+        size_t operand;
+        size_t limit;
+        size_t step;
+        size_t jump;
+    } instruction_t;
+
+    std::vector<instruction_t> m_program;
+    std::vector<expression_t> m_expressions;
+    std::vector<script_command_t> m_commands;
+    std::map<std::string, size_t> m_variableSlots;
+    std::vector<double> m_variables;
+    std::vector<double> m_stack;
+    std::deque<std::string> m_arguments;
+    std::string m_name;
+    std::string m_output;
+    size_t m_totalCommands;
+
+    ScriptVM(const ScriptVM& rhs);
+    ScriptVM& operator=(const ScriptVM&);
+
+    static bool isKeyword(const std::string& word);
+    static void splitWords(const std::string& line, std::vector<std::string>& words);
+
+    size_t addVariable(const std::string& name);
+    size_t addExpression(const expression_t& expression);
+    bool compileExpression(const std::string& text, size_t& expression, std::string& error);
+    bool parseSum(const std::string& text, size_t& i, expression_t& expression, std::string& error);
+    bool parseProduct(const std::string& text, size_t& i, expression_t& expression, std::string& error);
+    bool parseFactor(const std::string& text, size_t& i, expression_t& expression, std::string& error);
+    bool compileText(const std::string& word, text_t& text, std::string& error);
+    bool compileCommand(const std::vector<std::string>& words, std::string& error);
+
+    double evaluate(const size_t expression);
+    void format(const text_t& text, std::string& str);
+    bool resolve(script_command_t& cmd, CommandObject*& object, std::string& output);
+    void runCommand(script_command_t& cmd, std::string& output);
+};
+
+
+
+inline size_t ScriptVM::getTotalCommands() const {
+    return m_totalCommands;
+}
+
+#endif // SCRIPTVM_HPP
@@ -0,0 +1,107 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef SIMULATIONLOOP_HPP
+#define SIMULATIONLOOP_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include "commandobject.hpp"
+
+const double DEFAULT_UPDATE_RATE = 60.0;
+const double MIN_UPDATE_RATE = 1.0e-3; // a step of at most 1000 s
+const double MAX_UPDATE_RATE = 1.0e9; // a step of at least 1 ns
+const size_t DEFAULT_MAX_CATCH_UP_STEPS = 5;
+
+// Fixed rate simulation clock, independent of the render rate. Each frame accumulates the
+// time that passed and step() is true once per fixed step due, up to the max catch up steps
+// (the rest of the time is dropped, so a long stall slows the simulation down instead of
+// freezing it). Entities changed by the steps are drawn interpolated by getAlpha().
+//
+//     loop.beginFrame();
+//     while (loop.step())
+//         physicsWorld.stepFixed(loop.getTimestep());
+//     renderer.draw(loop.getAlpha());
+class SimulationLoop: public CommandObject {
+public:
+    SimulationLoop(const std::string& objectName);
+    ~SimulationLoop();
+
+    double getTimestep() const;
+    double getAlpha() const;
+    size_t getMaxCatchUpSteps() const;
+    boost::uint64_t getTotalSteps() const;
+    boost::uint64_t getDroppedSteps() const;
+    void setUpdateRate(const double updateRate);
+    void setMaxCatchUpSteps(const size_t maxCatchUpSteps);
+
+    void reset();
+    void beginFrame();
+    void advance(const boost::uint64_t nanoseconds);
+    bool step();
+
+private:
+    boost::uint64_t m_timestep;
+    boost::uint64_t m_accumulator;
+    boost::uint64_t m_lastTime;
+    size_t m_maxCatchUpSteps;
+    size_t m_frameSteps;
+    bool m_isStepping;
+    boost::uint64_t m_totalSteps;
+    boost::uint64_t m_droppedSteps;
+
+    std::string cmdUpdateRate(std::deque<std::string>& args);
+    std::string cmdMaxCatchUpSteps(std::deque<std::string>& args);
+    std::string cmdStats(std::deque<std::string>&);
+};
+
+
+
+inline double SimulationLoop::getTimestep() const {
+    return double(m_timestep) * 1.0e-9;
+}
+
+inline double SimulationLoop::getAlpha() const {
+    return double(m_accumulator) / double(m_timestep);
+}
+
+inline size_t SimulationLoop::getMaxCatchUpSteps() const {
+    return m_maxCatchUpSteps;
+}
+
+inline boost::uint64_t SimulationLoop::getTotalSteps() const {
+    return m_totalSteps;
+}
+
+inline boost::uint64_t SimulationLoop::getDroppedSteps() const {
+    return m_droppedSteps;
+}
+
+inline void SimulationLoop::setMaxCatchUpSteps(const size_t maxCatchUpSteps) {
+    m_maxCatchUpSteps = maxCatchUpSteps > 0? maxCatchUpSteps : 1;
+}
+
+#endif // SIMULATIONLOOP_HPP
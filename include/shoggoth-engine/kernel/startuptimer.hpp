@@ -0,0 +1,99 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef STARTUPTIMER_HPP
+#define STARTUPTIMER_HPP
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include "shoggoth-engine/common/clock.hpp"
+
+// Times the phases of startup, on whichever thread runs them, up to the first frame. A phase
+// is marked with a StartupPhase on the stack, named with a string literal:
+//
+//     Device::Device(const string& name, const bool isHeadless):
+//         ...
+//     {
+//         StartupPhase phase("Device");
+//
+// Phases that end after the first frame are not recorded, so code that also runs later (like
+// loading another scene) can stay marked.
+class StartupTimer {
+public:
+    friend class StartupPhase;
+
+    static void start();
+    static void finish();
+    static bool isFinished();
+    static boost::uint64_t getTimeToFirstFrame();
+    static std::string report();
+
+private:
+    typedef struct {
+        const char* name;
+        bool isMainThread;
+        boost::uint64_t begin;
+        boost::uint64_t end;
+    } startup_phase_t;
+
+    static boost::uint64_t ms_startTime;
+    static boost::uint64_t ms_finishTime;
+    static boost::thread::id ms_mainThreadId;
+    static boost::mutex ms_phasesMutex;
+    static std::vector<startup_phase_t> ms_phases;
+
+    static void record(const char* name, const boost::uint64_t begin, const boost::uint64_t end);
+    static bool comparePhases(const startup_phase_t& lhs, const startup_phase_t& rhs);
+};
+
+class StartupPhase {
+public:
+    StartupPhase(const char* name);
+    ~StartupPhase();
+
+private:
+    const char* m_name;
+    boost::uint64_t m_begin;
+
+    StartupPhase(const StartupPhase& rhs);
+    StartupPhase& operator=(const StartupPhase& rhs);
+};
+
+
+
+inline StartupPhase::StartupPhase(const char* name):
+    m_name(name),
+    m_begin(Clock::nanoseconds())
+{}
+
+inline StartupPhase::~StartupPhase() {
+    StartupTimer::record(m_name, m_begin, Clock::nanoseconds());
+}
+
+#endif // STARTUPTIMER_HPP
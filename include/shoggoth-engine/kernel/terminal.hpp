@@ -31,22 +31,49 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <boost/cstdint.hpp>
 #include "shoggoth-engine/kernel/tokentable.hpp"
 #include "command.hpp"
+#include "commandobject.hpp"
 
-class CommandObject;
+class BinaryScript;
+class BinaryScriptWriter;
+class ObjectSelector;
+class ScriptVM;
 
 class Terminal {
 public:
     friend class Command;
     friend class CommandObject;
+    friend class BinaryScript;
+    friend class BinaryScriptWriter;
+    friend class ObjectSelector;
+    friend class ScriptVM;
 
     static bool getObject(const size_t id, CommandObject*& object);
     static const std::string getObjectName(const size_t idObject);
     static std::string findCommandName(const size_t idCommand);
 
+    static bool isCommandCoalescingEnabled();
+    static void setCommandCoalescing(const bool isEnabled);
+
+    static size_t getFrame();
+    static bool isRecording();
+    static bool startRecording(const std::string& fileName);
+    static bool stopRecording();
+    static bool isReplaying();
+    static bool startReplay(const std::string& fileName);
+    static void stopReplay();
+
     static void pushCommand(const std::string& cmd);
+    static void pushBoundCommand(const Command& cmd, const boost::uint64_t inputTime = 0);
+    static void cancelBoundCommands();
     static std::string runScript(const std::string& fileName);
+    static std::string runScriptLines(const std::vector<std::string>& lines);
+    static std::string runBatch(const std::vector<std::string>& lines, size_t& totalCommands);
+    static void readScriptLines(const std::string& fileName, std::vector<std::string>& lines);
+    static std::string runBinaryScript(const std::string& fileName);
+    static std::string compileScript(const std::string& fileName, const std::string& binaryFileName);
     static std::string processCommandsQueue();
     static std::vector<std::string> generateObjectsList(const bool shouldIncludeId = false);
     static std::vector<std::string> generateCommandsList(const bool shouldIncludeId = false);
@@ -57,14 +84,41 @@ public:
 private:
     typedef std::map<size_t, CommandObject*> obj_ptr_table_t;
 
+    // a queued command is either an expression still to be parsed, or an already parsed
+    // command owned by someone else (input bindings), copied when it runs.
+    // Commands caused by an input carry the time it was polled, for InputLatency
+    typedef struct {
+        std::string expression;
+        const Command* bound;
+        boost::uint64_t inputTime;
+    } queued_command_t;
+    typedef std::vector<queued_command_t> command_queue_t;
+
     static TokenTable ms_objectsTable;
     static TokenTable ms_commandsTable;
     static TokenTable ms_attributesTable;
     static obj_ptr_table_t ms_objectPointersTable;
-    static std::deque<std::string> ms_commandsQueue;
+    static command_queue_t ms_commandsQueue;
+    static command_queue_t ms_runningQueue;
+    static Command ms_queuedCommand;
+    static boost::uint64_t ms_runningInputTime;
+    static bool ms_isCommandCoalescingEnabled;
+    static size_t ms_frame;
+    static BinaryScriptWriter* ms_recorder;
+    static std::string ms_recordingFileName;
+    static size_t ms_recordingFirstFrame;
+    static BinaryScript* ms_replay;
+    static size_t ms_replayFirstFrame;
+    static size_t ms_replayCommand;
 
     static size_t registerObject(const std::string& objectName, CommandObject* obj);
     static void unregisterObject(const std::string& objectName);
+    static void parseScript(const std::vector<std::string>& lines, std::deque<Command>& commands);
+    static bool takeQueuedCommand(const queued_command_t& queued, Command& cmd);
+    static void coalesceCommandsQueue(std::deque<Command>& commands, std::deque<boost::uint64_t>& inputTimes);
+    static bool mergeCommands(Command& target, const Command& cmd, const coalesce_t coalescing);
+    static void recordCommand(const Command& cmd);
+    static std::string processReplayFrame();
     static std::vector<std::string> generateAutocompleteObjectList(const std::string& object);
     static std::vector<std::string> generateAutocompleteCommandList(const size_t idObject, const std::string& command);
     static std::vector<std::string> generateAutocompleteAttributeList(const size_t idObject, const std::string& attr);
@@ -73,8 +127,9 @@ private:
 
 
 inline bool Terminal::getObject(const size_t id, CommandObject*& object) {
-    if (id < ms_objectPointersTable.size()) {
-        object = ms_objectPointersTable[id];
+    obj_ptr_table_t::const_iterator it = ms_objectPointersTable.find(id);
+    if (it != ms_objectPointersTable.end()) {
+        object = it->second;
         if (object != 0)
             return true;
     }
@@ -85,4 +140,24 @@ inline std::string Terminal::findCommandName(const size_t idCommand) {
     return ms_commandsTable.findName(idCommand);
 }
 
+inline size_t Terminal::getFrame() {
+    return ms_frame;
+}
+
+inline bool Terminal::isRecording() {
+    return ms_recorder != 0;
+}
+
+inline bool Terminal::isReplaying() {
+    return ms_replay != 0;
+}
+
+inline bool Terminal::isCommandCoalescingEnabled() {
+    return ms_isCommandCoalescingEnabled;
+}
+
+inline void Terminal::setCommandCoalescing(const bool isEnabled) {
+    ms_isCommandCoalescingEnabled = isEnabled;
+}
+
 #endif // TERMINAL_HPP
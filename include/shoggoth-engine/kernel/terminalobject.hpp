@@ -0,0 +1,67 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TERMINALOBJECT_HPP
+#define TERMINALOBJECT_HPP
+
+#include <string>
+#include "commandobject.hpp"
+
+// Exposes the Terminal settings and tools as commands of its own object
+class TerminalObject: public CommandObject {
+public:
+    TerminalObject(const std::string& objectName);
+    ~TerminalObject();
+
+private:
+    std::string cmdCoalesceCommands(std::deque<std::string>& args);
+    std::string cmdCompileScript(std::deque<std::string>& args);
+    std::string cmdProfileCommands(std::deque<std::string>& args);
+    std::string cmdStats(std::deque<std::string>& args);
+    std::string cmdStatsReset(std::deque<std::string>&);
+    std::string cmdStatsCsv(std::deque<std::string>& args);
+    std::string cmdProfileLatency(std::deque<std::string>& args);
+    std::string cmdLatency(std::deque<std::string>&);
+    std::string cmdLatencyReset(std::deque<std::string>&);
+    std::string cmdFrameTimes(std::deque<std::string>&);
+    std::string cmdFrameTimesReset(std::deque<std::string>&);
+    std::string cmdFrameTimesCsv(std::deque<std::string>& args);
+    std::string cmdFrameArena(std::deque<std::string>&);
+    std::string cmdStartup(std::deque<std::string>&);
+    std::string cmdJobs(std::deque<std::string>&);
+    std::string cmdJobsReset(std::deque<std::string>&);
+    std::string cmdLogLevel(std::deque<std::string>& args);
+    std::string cmdLogStats(std::deque<std::string>&);
+    std::string cmdLogStatsReset(std::deque<std::string>&);
+    std::string cmdRecordStart(std::deque<std::string>& args);
+    std::string cmdRecordStop(std::deque<std::string>&);
+    std::string cmdReplay(std::deque<std::string>& args);
+    std::string cmdServerStart(std::deque<std::string>& args);
+    std::string cmdServerStop(std::deque<std::string>&);
+    std::string cmdServerStats(std::deque<std::string>&);
+};
+
+#endif // TERMINALOBJECT_HPP
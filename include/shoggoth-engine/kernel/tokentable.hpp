@@ -30,6 +30,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <boost/cstdint.hpp>
 #include "shoggoth-engine/common/uniqueidgenerator.hpp"
 
 class TokenTable {
@@ -38,10 +39,13 @@ public:
 
     size_t registerToken(const std::string& token);
     void unregisterToken(const std::string& token);
+    bool isToken(const std::string& token) const;
     bool findId(size_t& id, const std::string& token) const;
+    void findIdsWithPrefix(const std::string& prefix, std::vector<size_t>& ids) const;
     std::string findName(const size_t id) const;
     std::vector<std::string> generateList(const bool shouldIncludeId = false) const;
     std::vector<std::string> autocompleteList(const std::string& token) const;
+    boost::uint32_t fingerprint() const;
 
 private:
     std::map<std::string, size_t> m_tokenMap;
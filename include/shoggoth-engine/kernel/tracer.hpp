@@ -0,0 +1,125 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include "shoggoth-engine/common/clock.hpp"
+
+const size_t TRACE_BUFFER_EVENTS = 65536;
+
+// Captures nested scopes on every thread for chrome://tracing and Perfetto. A scope is
+// marked with a TraceScope on the stack, named with a string literal:
+//
+//     void Renderer::submitFrame() {
+//         TraceScope trace("Renderer::submitFrame");
+//
+// Every thread writes its scopes into its own ring buffer, so marking takes no lock, and
+// once full the oldest scopes are overwritten. While not capturing a scope costs a branch.
+// Only the owning thread writes a buffer: it publishes each scope by storing the new count,
+// and drops the previous capture's scopes itself when it sees the capture generation change.
+class Tracer {
+public:
+    friend class TraceScope;
+
+    static bool isCapturing();
+    static void start();
+    static void stop();
+    static size_t getTotalEvents();
+    static bool exportTrace(const std::string& fileName);
+
+private:
+    typedef struct {
+        const char* name;
+        boost::uint64_t begin;
+        boost::uint64_t end;
+    } trace_event_t;
+
+    struct trace_buffer_t {
+        size_t threadId;
+        std::string threadName;
+        boost::atomic<boost::uint64_t> generation;
+        boost::atomic<boost::uint64_t> firstEvent;
+        boost::atomic<boost::uint64_t> totalEvents;
+        std::vector<trace_event_t> events;
+
+        trace_buffer_t(const size_t id, const std::string& name):
+            threadId(id), threadName(name), generation(0), firstEvent(0), totalEvents(0),
+            events(TRACE_BUFFER_EVENTS) {}
+    };
+
+    static boost::atomic<bool> ms_isCapturing;
+    static boost::atomic<boost::uint64_t> ms_generation;
+    static boost::uint64_t ms_startTime;
+    static boost::thread::id ms_mainThreadId;
+    static boost::mutex ms_buffersMutex;
+    static std::vector<trace_buffer_t*> ms_buffers;
+    static boost::thread_specific_ptr<trace_buffer_t*> ms_threadBuffer;
+
+    static void record(const char* name, const boost::uint64_t begin, const boost::uint64_t end);
+    static bool getCapturedRange(const trace_buffer_t* buffer, boost::uint64_t& first, boost::uint64_t& total);
+    static trace_buffer_t* getThreadBuffer();
+    static void writeEscaped(std::ostream& out, const char* text);
+};
+
+class TraceScope {
+public:
+    TraceScope(const char* name);
+    ~TraceScope();
+
+private:
+    const char* m_name;
+    boost::uint64_t m_begin;
+
+    TraceScope(const TraceScope& rhs);
+    TraceScope& operator=(const TraceScope& rhs);
+};
+
+
+
+inline bool Tracer::isCapturing() {
+    return ms_isCapturing.load(boost::memory_order_acquire);
+}
+
+inline TraceScope::TraceScope(const char* name):
+    m_name(name),
+    m_begin(Tracer::isCapturing()? Clock::nanoseconds() : 0)
+{}
+
+inline TraceScope::~TraceScope() {
+    // scopes open when the capture started are not recorded
+    if (m_begin != 0 && Tracer::isCapturing())
+        Tracer::record(m_name, m_begin, Clock::nanoseconds());
+}
+
+#endif // TRACER_HPP
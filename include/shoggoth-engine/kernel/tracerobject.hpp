@@ -0,0 +1,49 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TRACEROBJECT_HPP
+#define TRACEROBJECT_HPP
+
+#include <string>
+#include "commandobject.hpp"
+
+const std::string DEFAULT_TRACE_FILE = "trace.json";
+
+// Exposes the Tracer captures as commands of its own object:
+//     profiler start
+//     profiler stop [trace.json]
+class TracerObject: public CommandObject {
+public:
+    TracerObject(const std::string& objectName);
+    ~TracerObject();
+
+private:
+    std::string cmdStart(std::deque<std::string>&);
+    std::string cmdStop(std::deque<std::string>& args);
+    std::string cmdStatus(std::deque<std::string>&);
+};
+
+#endif // TRACEROBJECT_HPP
@@ -55,6 +55,7 @@ public:
     void registerCollisionShape(const std::string& shapeId, btCollisionShape* shape);
     void setMinExpectedFramerate(const double minExpectedFramerate);
     void stepSimulation(const double currentTimeSeconds);
+    void stepFixed(const double timestep);
 
 private:
     typedef boost::unordered_map<std::string, btCollisionShape*> collision_shapes_map_t;
@@ -27,6 +27,7 @@
 #ifndef RIGIDBODY_HPP
 #define RIGIDBODY_HPP
 
+#include <vector>
 #include "shoggoth-engine/linearmath/vector3.hpp"
 #include "shoggoth-engine/kernel/component.hpp"
 
@@ -40,6 +41,8 @@ const std::string COLLISION_SHAPE_CONE = "#cone";
 const std::string COLLISION_SHAPE_CONVEX = "#convex";
 const std::string COLLISION_SHAPE_CONCAVE = "#concave";
 
+const std::string XML_RIGIDBODY_COLLISIONSHAPE = "collisionshape";
+
 class PhysicsWorld;
 class btRigidBody;
 class btCollisionShape;
@@ -97,6 +100,10 @@ public:
     void addConvexHull(const double mass, const std::string& fileName);
     void addConcaveHull(const double mass, const std::string& fileName);
 
+    static btCollisionShape* buildConvexHull(const std::string& fileName);
+    static void deferActivations();
+    static void flushActivations();
+
     void loadFromPtree(const std::string& path, const boost::property_tree::ptree& tree);
     void saveToPtree(const std::string& path, boost::property_tree::ptree& tree) const;
 
@@ -105,6 +112,11 @@ private:
     std::string m_shapeId;
     btRigidBody* m_rigidBody;
     double m_mass;
+    bool m_isActivationPending;
+    bool m_isForcedActivation;
+
+    static size_t ms_deferActivationsDepth;
+    static std::vector<RigidBody*> ms_pendingActivations;
 
     RigidBody(const RigidBody& rhs);
     RigidBody& operator=(const RigidBody&);
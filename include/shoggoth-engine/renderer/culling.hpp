@@ -29,6 +29,7 @@
 #include <set>
 #include <map>
 #include <boost/unordered_map.hpp>
+#include "shoggoth-engine/kernel/framearena.hpp"
 
 class Quaternion;
 class Vector3;
@@ -41,6 +42,9 @@ class btCollisionWorld;
 class btCollisionShape;
 class btCollisionObject;
 
+// the culling results only last for the frame being drawn
+typedef std::set<RenderableMesh*, std::less<RenderableMesh*>, FrameAllocator<RenderableMesh*> > frame_renderable_set_t;
+
 class Culling {
 public:
     static void initialize();
@@ -49,7 +53,7 @@ public:
     static void unregisterForCulling(RenderableMesh* const renderablemesh);
     static void performFrustumCulling(const float* projectionMatrix,
                                       const Entity* camera,
-                                      std::set<RenderableMesh*>& modelsInFrustum);
+                                      frame_renderable_set_t& modelsInFrustum);
 
 private:
     typedef std::map<RenderableMesh*, btCollisionObject*> collision_object_map_t;
@@ -48,8 +48,19 @@ public:
     bool loadFromFile(const std::string& fileName);
     Texture* loadTextureFromFile(const std::string& fileName);
     void useMaterial() const;
+    void useProgram() const;
+    void useMaterialState() const;
+    void useTransform() const;
+    size_t getSortId() const;
+    unsigned int getProgramId() const;
+    unsigned int getTextureId() const;
+    bool isTransparent() const;
+    bool isInstanced() const;
 
 private:
+    static size_t ms_totalMaterials;
+
+    size_t m_sortId;
     Renderer* m_renderer;
     std::string m_fileName;
     Shader m_shader;
@@ -79,4 +90,20 @@ inline const std::string& Material::getFileName() const {
     return m_fileName;
 }
 
+inline size_t Material::getSortId() const {
+    return m_sortId;
+}
+
+inline unsigned int Material::getProgramId() const {
+    return m_shader.getProgramId();
+}
+
+inline bool Material::isTransparent() const {
+    return m_opacity < 1.0f;
+}
+
+inline bool Material::isInstanced() const {
+    return m_shader.isInstanced();
+}
+
 #endif // MATERIAL_HPP
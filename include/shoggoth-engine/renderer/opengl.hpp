@@ -61,9 +61,16 @@ typedef enum {
     RENDERING_METHOD_SHADERS // 2.0
 } rendering_method_t;
 
+typedef enum {
+    INSTANCING_NONE, // 1.0
+    INSTANCING_EXT, // extension
+    INSTANCING // 3.3
+} instancing_t;
+
 const unsigned int VERTEX_ARRAY_INDEX = 0;
 const unsigned int NORMALS_ARRAY_INDEX = 1;
 const unsigned int UVCOORDS_ARRAY_INDEX = 2;
+const unsigned int INSTANCE_MATRIX_INDEX = 3; // a mat4 takes the 4 indices from here, one per column
 
 
 class OpenGL {
@@ -85,13 +92,18 @@ public:
     static texture_filtering_t& textureFilteringMode();
     static texture_compression_t& textureCompressionMode();
     static rendering_method_t& renderingMethod();
+    static instancing_t& instancingMode();
     static bool areVBOsSupported();
     static bool areShadersSupported();
+    static bool areInstancedDrawsSupported();
+    static bool areVAOsSupported();
+    static bool isNullRenderer();
     static void setTextureFilteringMode(const texture_filtering_t& textureFiltering);
     static void setAnisotropy(const float anisotropy);
 
     static void detectCapabilities();
     static void forceFixedPipeline(const bool useFixedPipeline = true);
+    static void forceNullRenderer(const bool useNullRenderer = true);
     static void multMatrix(float* result, const float* a, const float* b);
     static void inverseMatrix(float* result, const float* a);
     static void transposeMatrix(float* m);
@@ -109,8 +121,11 @@ private:
     static texture_filtering_t ms_textureFilteringMode;
     static texture_compression_t ms_textureCompressionMode;
     static rendering_method_t ms_renderingMethod;
+    static instancing_t ms_instancingMode;
     static bool ms_areVBOsSupported;
     static bool ms_areShadersSupported;
+    static bool ms_areVAOsSupported;
+    static bool ms_isNullRenderer;
 };
 
 
@@ -122,12 +137,21 @@ namespace gl {
     void bindVboBuffer(const unsigned int vboId);
     void vboBufferBytes(const size_t totalBytes);
     void vboBufferSubData(const size_t startByte, const size_t totalBytes, const float* data);
+    void vboStreamData(const size_t totalBytes, const float* data);
     size_t getVboBufferBytes();
     void bindIndexBuffer(const unsigned int indicesId);
     void indexBufferData(const size_t totalBytes, const unsigned int* data);
     size_t getIndexBufferBytes();
     void vertexAttribPointer(const unsigned int dataIndex, const size_t bytesOffset);
+    void enableVertexAttribArray(const unsigned int dataIndex);
+    unsigned int genVertexArray();
+    void deleteVertexArray(const unsigned int vaoId);
+    void bindVertexArray(const unsigned int vaoId);
     void drawElements(const size_t totalIndices);
+    void enableInstanceMatrixArray(const bool isEnabled);
+    void instanceMatrixPointer(const size_t bytesOffset);
+    void instanceMatrix(const float* matrix);
+    void drawElementsInstanced(const size_t totalIndices, const size_t totalInstances);
 
     // shaders
     unsigned int createVertexShader();
@@ -152,6 +176,7 @@ namespace gl {
     void useUniform3x3(const int location, const float* value);
     void useUniform4x4(const int location, const float* value);
     void bindAttribLocation(const unsigned int programId, const unsigned int attribArrayIndex, const std::string& name);
+    int getAttribLocation(const unsigned int programId, const std::string& name);
 }
 
 
@@ -196,6 +221,10 @@ inline rendering_method_t& OpenGL::renderingMethod() {
     return ms_renderingMethod;
 }
 
+inline instancing_t& OpenGL::instancingMode() {
+    return ms_instancingMode;
+}
+
 inline bool OpenGL::areVBOsSupported() {
     return ms_areVBOsSupported;
 }
@@ -204,6 +233,18 @@ inline bool OpenGL::areShadersSupported() {
     return ms_areShadersSupported;
 }
 
+inline bool OpenGL::areInstancedDrawsSupported() {
+    return ms_instancingMode != INSTANCING_NONE;
+}
+
+inline bool OpenGL::areVAOsSupported() {
+    return ms_areVAOsSupported;
+}
+
+inline bool OpenGL::isNullRenderer() {
+    return ms_isNullRenderer;
+}
+
 inline void OpenGL::setAnisotropy(const float anisotropy) {
     ms_anisotropy = anisotropy;
     if (ms_anisotropy > ms_maxAnisotropy)
@@ -258,6 +299,14 @@ inline void gl::vboBufferSubData(const size_t startByte, const size_t totalBytes
         glBufferSubData(GL_ARRAY_BUFFER, startByte, totalBytes, data);
 }
 
+// the data is replaced every frame, the driver hands a fresh buffer instead of waiting for the old one
+inline void gl::vboStreamData(const size_t totalBytes, const float* data) {
+    if (OpenGL::dataUploadMode() == DATA_UPLOAD_VERTEX_BUFFER_OBJECT_EXT)
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB, totalBytes, data, GL_STREAM_DRAW_ARB);
+    else
+        glBufferData(GL_ARRAY_BUFFER, totalBytes, data, GL_STREAM_DRAW);
+}
+
 inline size_t gl::getVboBufferBytes() {
     GLint bufferSize;
     if (OpenGL::dataUploadMode() == DATA_UPLOAD_VERTEX_BUFFER_OBJECT_EXT)
@@ -297,10 +346,83 @@ inline void gl::vertexAttribPointer(const unsigned int dataIndex, const size_t b
         glVertexAttribPointer(dataIndex, 3, GL_FLOAT, GL_FALSE, 0, (void*)(bytesOffset));
 }
 
+inline void gl::enableVertexAttribArray(const unsigned int dataIndex) {
+    if (OpenGL::renderingMethod() == RENDERING_METHOD_SHADERS_EXT)
+        glEnableVertexAttribArrayARB(dataIndex);
+    else
+        glEnableVertexAttribArray(dataIndex);
+}
+
+// the ARB extension shares the names of the 3.0 functions
+inline unsigned int gl::genVertexArray() {
+    unsigned int vaoId;
+    glGenVertexArrays(1, &vaoId);
+    return vaoId;
+}
+
+inline void gl::deleteVertexArray(const unsigned int vaoId) {
+    glDeleteVertexArrays(1, &vaoId);
+}
+
+inline void gl::bindVertexArray(const unsigned int vaoId) {
+    glBindVertexArray(vaoId);
+}
+
 inline void gl::drawElements(const size_t totalIndices) {
     glDrawElements(GL_TRIANGLES, GLsizei(totalIndices), GL_UNSIGNED_INT, 0);
 }
 
+inline void gl::enableInstanceMatrixArray(const bool isEnabled) {
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (OpenGL::renderingMethod() == RENDERING_METHOD_SHADERS_EXT) {
+            if (isEnabled)
+                glEnableVertexAttribArrayARB(INSTANCE_MATRIX_INDEX + i);
+            else
+                glDisableVertexAttribArrayARB(INSTANCE_MATRIX_INDEX + i);
+        }
+        else {
+            if (isEnabled)
+                glEnableVertexAttribArray(INSTANCE_MATRIX_INDEX + i);
+            else
+                glDisableVertexAttribArray(INSTANCE_MATRIX_INDEX + i);
+        }
+    }
+}
+
+// column major matrices packed one after the other in the bound vbo, advancing once per
+// instance. The divisor belongs to the bound vao like the pointer, so both are set together
+inline void gl::instanceMatrixPointer(const size_t bytesOffset) {
+    const GLsizei stride = GLsizei(16 * sizeof(float));
+    for (unsigned int i = 0; i < 4; ++i) {
+        size_t columnOffset = bytesOffset + i * 4 * sizeof(float);
+        if (OpenGL::dataUploadMode() == DATA_UPLOAD_VERTEX_BUFFER_OBJECT_EXT)
+            glVertexAttribPointerARB(INSTANCE_MATRIX_INDEX + i, 4, GL_FLOAT, GL_FALSE, stride, (void*)(columnOffset));
+        else
+            glVertexAttribPointer(INSTANCE_MATRIX_INDEX + i, 4, GL_FLOAT, GL_FALSE, stride, (void*)(columnOffset));
+        if (OpenGL::instancingMode() == INSTANCING_EXT)
+            glVertexAttribDivisorARB(INSTANCE_MATRIX_INDEX + i, 1);
+        else
+            glVertexAttribDivisor(INSTANCE_MATRIX_INDEX + i, 1);
+    }
+}
+
+// the same matrix for every vertex, used while the instance matrix array is disabled
+inline void gl::instanceMatrix(const float* matrix) {
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (OpenGL::renderingMethod() == RENDERING_METHOD_SHADERS_EXT)
+            glVertexAttrib4fvARB(INSTANCE_MATRIX_INDEX + i, matrix + i * 4);
+        else
+            glVertexAttrib4fv(INSTANCE_MATRIX_INDEX + i, matrix + i * 4);
+    }
+}
+
+inline void gl::drawElementsInstanced(const size_t totalIndices, const size_t totalInstances) {
+    if (OpenGL::instancingMode() == INSTANCING_EXT)
+        glDrawElementsInstancedARB(GL_TRIANGLES, GLsizei(totalIndices), GL_UNSIGNED_INT, 0, GLsizei(totalInstances));
+    else
+        glDrawElementsInstanced(GL_TRIANGLES, GLsizei(totalIndices), GL_UNSIGNED_INT, 0, GLsizei(totalInstances));
+}
+
 
 
 inline unsigned int gl::createVertexShader() {
@@ -482,4 +604,10 @@ inline void gl::bindAttribLocation(const unsigned int programId, const unsigned
         glBindAttribLocation(programId, attribArrayIndex, name.c_str());
 }
 
+inline int gl::getAttribLocation(const unsigned int programId, const std::string& name) {
+    if (OpenGL::renderingMethod() == RENDERING_METHOD_SHADERS_EXT)
+        return glGetAttribLocationARB(programId, name.c_str());
+    return glGetAttribLocation(programId, name.c_str());
+}
+
 #endif // OPENGL_H
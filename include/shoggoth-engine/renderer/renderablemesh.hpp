@@ -35,9 +35,12 @@ const std::string COMPONENT_RENDERABLEMESH = "renderablemesh";
 const std::string RENDERABLEMESH_BOX_DESCRIPTION = "$box";
 const std::string RENDERABLEMESH_FILE_DESCRIPTION = "$file";
 
+const std::string XML_RENDERABLEMESH_MODEL = "model";
+
 class Renderer;
 class Model;
 class Material;
+class AsyncJob;
 
 class RenderableMesh: public Component {
 public:
@@ -50,6 +53,7 @@ public:
 
     void loadBox(const double lengthX, const double lengthY, const double lengthZ);
     void loadFromFile(const std::string& fileName);
+    void loadFromModel(Model* model);
     void assignMaterial(const size_t meshIndex, const std::string& fileName);
 
     void loadFromPtree(const std::string& path, const boost::property_tree::ptree& tree);
@@ -64,7 +68,7 @@ private:
     RenderableMesh& operator=(const RenderableMesh&);
 
     std::string cmdLoadModelBox(std::deque<std::string>& args);
-    std::string cmdLoadModelFile(std::deque<std::string>& args);
+    std::string cmdLoadModelFile(std::deque<std::string>& args, AsyncJob*& job);
 };
 
 
@@ -81,13 +85,4 @@ inline Model* RenderableMesh::model() {
     return m_model;
 }
 
-
-
-inline std::string RenderableMesh::cmdLoadModelFile(std::deque<std::string>& args) {
-    if (args.size() < 1)
-        return "Error: too few arguments";
-    loadFromFile(args[0]);
-    return "";
-}
-
 #endif // RENDERABLEMESH_HPP
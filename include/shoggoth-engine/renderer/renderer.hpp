@@ -29,8 +29,13 @@
 
 #include <string>
 #include <set>
+#include <vector>
+#include <boost/cstdint.hpp>
 #include <boost/unordered_map.hpp>
 #include "shoggoth-engine/kernel/commandobject.hpp"
+#include "shoggoth-engine/linearmath/scalar.hpp"
+#include "shoggoth-engine/renderer/culling.hpp"
+#include "shoggoth-engine/renderer/renderqueue.hpp"
 
 class Device;
 class Vector3;
@@ -48,7 +53,11 @@ public:
     Renderer(const std::string& objectName, const Device* device);
     ~Renderer();
 
-    void draw();
+    // draw() is buildFrame() then submitFrame(). The frame built is a copy of everything
+    // submitFrame() draws, so entities may change in between (see FramePipeline)
+    void draw(const double alpha = 1.0);
+    void buildFrame(const double alpha = 1.0);
+    void submitFrame();
     void registerCamera(Camera* camera);
     void unregisterCamera(Camera* camera);
     void registerLight(Light* light);
@@ -57,6 +66,7 @@ public:
     void unregisterRenderableMesh(RenderableMesh* renderable);
 
     void registerModel(Model* model);
+    Model* registerAndUploadModel(Model* model);
     void unregisterModel(Model* model);
     Model* findModel(const std::string& identifier);
     void registerTexture(Texture* texture);
@@ -72,9 +82,55 @@ public:
     void deleteMeshFromGPU(const Mesh& mesh);
     void uploadTextureToGPU(Texture& texture);
     void deleteTextureFromGPU(const Texture& texture);
+    size_t getTotalDrawItems() const;
+    std::string reportRenderStats() const;
     std::string listsToString() const;
 
 private:
+    // the frame is built into a draw list first and submitted to OpenGL afterwards,
+    // so the null renderer still does the culling and per-object work
+    typedef struct {
+        float modelMatrix[16];
+    } draw_transform_t;
+
+    typedef struct {
+        const Mesh* mesh;
+        const Material* material;
+        size_t transform;
+    } draw_item_t;
+
+    // light state copied with the mesh transforms, the pipeline worker may be moving the light entities
+    // while the fixed pipeline lights are submitted
+    typedef struct {
+        float position[4];
+        float spotDirection[3];
+        float constantAttenuation;
+        float linearAttenuation;
+        float quadraticAttenuation;
+        bool isSpotDirectionUsed;
+    } draw_light_t;
+
+    // consecutive items of the sorted queue drawn by one call, instanced batches read their
+    // model matrices from the frame instance buffer starting at matrix number instance
+    typedef struct {
+        size_t first;
+        size_t count;
+        size_t instance;
+        bool isInstanced;
+    } draw_batch_t;
+
+    // state changes of the sorted draw list, every draw used to change all of them
+    typedef struct {
+        boost::uint64_t frames;
+        boost::uint64_t draws;
+        boost::uint64_t drawCalls;
+        boost::uint64_t programBinds;
+        boost::uint64_t materialBinds;
+        boost::uint64_t textureBinds;
+        boost::uint64_t matrixUploads;
+        boost::uint64_t bufferBinds;
+    } render_stats_t;
+
     const Device* m_device;
     Camera* m_activeCamera;
     std::set<Camera*> m_cameras;
@@ -84,10 +140,27 @@ private:
     boost::unordered_map<std::string, Material*> m_materials;
     boost::unordered_map<std::string, Texture*> m_textures;
     Material* m_defaultMaterial;
+    std::vector<draw_transform_t> m_drawTransforms;
+    std::vector<draw_item_t> m_drawList;
+    std::vector<draw_light_t> m_drawLights;
+    RenderQueue m_renderQueue;
+    std::vector<draw_batch_t> m_drawBatches;
+    std::vector<float> m_instanceMatrices;
+    unsigned int m_instanceBufferId;
+    render_stats_t m_frameStats;
+    render_stats_t m_totalStats;
 
     Renderer(const Renderer& rhs);
     Renderer& operator=(const Renderer& rhs);
 
+    void initializeCulling(const size_t, const size_t);
+    void buildDrawList(const frame_renderable_set_t& renderables, const scalar_t& alpha);
+    void buildDrawBatches();
+    bool isInstancedDraw(const draw_item_t& item) const;
+    void countStateChanges();
+    void submitDrawList();
+    void submitShaderDrawList();
+    void submitLegacyDrawList();
     void initLighting() const;
     void initCamera();
     void displayLegacyLights() const;
@@ -95,6 +168,8 @@ private:
     std::string cmdAmbientLight(std::deque<std::string>& args);
     std::string cmdTextureFiltering(std::deque<std::string>& args);
     std::string cmdAnisotropy(std::deque<std::string>& args);
+    std::string cmdRenderStats(std::deque<std::string>&);
+    std::string cmdRenderStatsReset(std::deque<std::string>&);
 };
 
 
@@ -118,6 +193,10 @@ inline void Renderer::unregisterLight(Light* light) {
     initLighting();
 }
 
+inline size_t Renderer::getTotalDrawItems() const {
+    return m_drawList.size();
+}
+
 inline void Renderer::registerRenderableMesh(RenderableMesh* renderable) {
     m_renderableMeshes.insert(renderable);
 }
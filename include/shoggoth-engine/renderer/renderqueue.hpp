@@ -0,0 +1,102 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+typedef enum {
+    RENDER_PASS_OPAQUE,
+    RENDER_PASS_TRANSPARENT
+} render_pass_t;
+
+// Draws of a frame ordered by a 64 bit key, most significant bits first:
+//
+//     pass (2) | program (14) | material (14) | texture (14) | depth (20)
+//
+// so the draws sharing a program, then a material, then a texture, end up next to each other
+// and the state changes only between groups. Opaque draws go front to back inside a group.
+// Transparent draws are blended, so their depth goes right after the pass, back to front.
+// Instanced draws are opaque and keep the mesh in place of the depth, so the instances of a
+// mesh with a material are next to each other and go in a single draw call.
+class RenderQueue {
+public:
+    RenderQueue();
+
+    static boost::uint64_t makeKey(const render_pass_t pass,
+                                   const unsigned int program,
+                                   const size_t material,
+                                   const unsigned int texture,
+                                   const float depth);
+    static boost::uint64_t makeInstancedKey(const unsigned int program,
+                                            const size_t material,
+                                            const unsigned int texture,
+                                            const unsigned int mesh);
+
+    void clear();
+    void push(const boost::uint64_t key, const size_t item);
+    void sort();
+
+    size_t size() const;
+    size_t getItem(const size_t index) const;
+    boost::uint64_t getKey(const size_t index) const;
+
+private:
+    typedef struct {
+        boost::uint64_t key;
+        size_t item;
+    } render_key_t;
+
+    std::vector<render_key_t> m_keys;
+    std::vector<render_key_t> m_buffer;
+};
+
+
+
+inline void RenderQueue::clear() {
+    m_keys.clear();
+}
+
+inline void RenderQueue::push(const boost::uint64_t key, const size_t item) {
+    render_key_t entry = {key, item};
+    m_keys.push_back(entry);
+}
+
+inline size_t RenderQueue::size() const {
+    return m_keys.size();
+}
+
+inline size_t RenderQueue::getItem(const size_t index) const {
+    return m_keys[index].item;
+}
+
+inline boost::uint64_t RenderQueue::getKey(const size_t index) const {
+    return m_keys[index].key;
+}
+
+#endif // RENDERQUEUE_HPP
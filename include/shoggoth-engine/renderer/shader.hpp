@@ -37,6 +37,11 @@ public:
 
     bool loadShaderProgram(const std::string& vertexFile, const std::string& fragmentFile);
     void useShader() const;
+    void useProgram() const;
+    void useUniforms() const;
+    void useMatrices() const;
+    unsigned int getProgramId() const;
+    bool isInstanced() const;
 
     void setUniform1(const std::string& name, const float value);
     void setUniform2(const std::string& name, const float* value);
@@ -58,6 +63,7 @@ private:
     int m_projectionMatrixLocation;
     int m_modelViewProjectionMatrixLocation;
     int m_normalMatrix;
+    int m_instanceMatrixLocation;
 
     std::map<int, float*> m_uniform1;
     std::map<int, float*> m_uniform2;
@@ -70,4 +76,14 @@ private:
     bool loadShaderFile(const unsigned int shaderId, const std::string& fileName);
 };
 
+
+
+inline unsigned int Shader::getProgramId() const {
+    return m_shaderProgramId;
+}
+
+inline bool Shader::isInstanced() const {
+    return m_instanceMatrixLocation >= 0;
+}
+
 #endif // SHADER_HPP
@@ -0,0 +1,163 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Compares command slots made with boost::function over boost::bind, as CommandObject used to
+// store them, with the fixed-size Delegate that replaced them: memory per entity and dispatch time.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <deque>
+#include <vector>
+#include <cstdlib>
+#include <new>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include "shoggoth-engine/common/delegate.hpp"
+#include "shoggoth-engine/common/clock.hpp"
+
+using namespace std;
+
+const size_t SLOTS_PER_ENTITY = 30;
+const size_t TOTAL_ENTITIES = 1000;
+const size_t TOTAL_CALLS = 10000000;
+
+typedef boost::function<string (deque<string>&)> function_slot_t;
+typedef Delegate<string (deque<string>&)> delegate_slot_t;
+
+#if __cplusplus >= 201103L
+#define THROWS_BAD_ALLOC
+#define THROWS_NOTHING noexcept
+#else
+#define THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define THROWS_NOTHING throw()
+#endif
+
+size_t g_allocations = 0;
+size_t g_allocatedBytes = 0;
+
+void* operator new(size_t size) THROWS_BAD_ALLOC {
+    ++g_allocations;
+    g_allocatedBytes += size;
+    void* ptr = malloc(size != 0? size : 1);
+    if (ptr == 0)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) THROWS_NOTHING {
+    free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* ptr, size_t) THROWS_NOTHING {
+    free(ptr);
+}
+#endif
+
+class BenchmarkEntity {
+public:
+    BenchmarkEntity(): m_total(0) {}
+
+    size_t getTotal() const { return m_total; }
+
+    string cmdMoveX(deque<string>& args) { m_total += args.size(); return ""; }
+    string cmdMoveY(deque<string>& args) { m_total += args.size() + 1; return ""; }
+    string cmdMoveZ(deque<string>& args) { m_total += args.size() + 2; return ""; }
+
+private:
+    size_t m_total;
+};
+
+template <typename slot_t>
+void makeSlots(BenchmarkEntity* entity, vector<slot_t>& slots);
+
+template <>
+void makeSlots<function_slot_t>(BenchmarkEntity* entity, vector<function_slot_t>& slots) {
+    for (size_t i = 0; i < SLOTS_PER_ENTITY; i += 3) {
+        slots.push_back(boost::bind(&BenchmarkEntity::cmdMoveX, entity, _1));
+        slots.push_back(boost::bind(&BenchmarkEntity::cmdMoveY, entity, _1));
+        slots.push_back(boost::bind(&BenchmarkEntity::cmdMoveZ, entity, _1));
+    }
+}
+
+template <>
+void makeSlots<delegate_slot_t>(BenchmarkEntity* entity, vector<delegate_slot_t>& slots) {
+    for (size_t i = 0; i < SLOTS_PER_ENTITY; i += 3) {
+        slots.push_back(delegate_slot_t::fromMethod<BenchmarkEntity, &BenchmarkEntity::cmdMoveX>(entity));
+        slots.push_back(delegate_slot_t::fromMethod<BenchmarkEntity, &BenchmarkEntity::cmdMoveY>(entity));
+        slots.push_back(delegate_slot_t::fromMethod<BenchmarkEntity, &BenchmarkEntity::cmdMoveZ>(entity));
+    }
+}
+
+template <typename slot_t>
+void runBenchmark(const string& name) {
+    BenchmarkEntity* entities = new BenchmarkEntity[TOTAL_ENTITIES];
+    vector<slot_t> slots;
+    slots.reserve(TOTAL_ENTITIES * SLOTS_PER_ENTITY);
+
+    // only what the slots allocate themselves is counted, not the tables holding them
+    const size_t allocations = g_allocations;
+    const size_t allocatedBytes = g_allocatedBytes;
+    for (size_t i = 0; i < TOTAL_ENTITIES; ++i)
+        makeSlots<slot_t>(&entities[i], slots);
+    const double allocationsPerEntity = double(g_allocations - allocations) / double(TOTAL_ENTITIES);
+    const double bytesPerEntity = double(sizeof(slot_t) * SLOTS_PER_ENTITY) +
+                                  double(g_allocatedBytes - allocatedBytes) / double(TOTAL_ENTITIES);
+
+    deque<string> args(3, "1.0");
+    const boost::uint64_t startTime = Clock::nanoseconds();
+    for (size_t i = 0; i < TOTAL_CALLS; i += slots.size()) {
+        for (size_t j = 0; j < slots.size(); ++j)
+            slots[j](args);
+    }
+    const boost::uint64_t elapsed = Clock::nanoseconds() - startTime;
+    const size_t totalCalls = (TOTAL_CALLS + slots.size() - 1) / slots.size() * slots.size();
+
+    size_t checksum = 0;
+    for (size_t i = 0; i < TOTAL_ENTITIES; ++i)
+        checksum += entities[i].getTotal();
+
+    cout << setw(18) << left << name << right
+         << setw(8) << sizeof(slot_t)
+         << setw(14) << fixed << setprecision(1) << allocationsPerEntity
+         << setw(14) << bytesPerEntity
+         << setw(12) << setprecision(2) << double(elapsed) / double(totalCalls)
+         << "   (checksum " << checksum << ")" << endl;
+
+    delete[] entities;
+}
+int main() {
+    cout << SLOTS_PER_ENTITY << " slots per entity, " << TOTAL_ENTITIES << " entities, " << TOTAL_CALLS << " calls" << endl;
+    cout << setw(18) << left << "slot" << right
+         << setw(8) << "sizeof"
+         << setw(14) << "allocs/entity"
+         << setw(14) << "bytes/entity"
+         << setw(12) << "ns/call" << endl;
+    runBenchmark<function_slot_t>("boost::function");
+    runBenchmark<delegate_slot_t>("Delegate");
+    return 0;
+}
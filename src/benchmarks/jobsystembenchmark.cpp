@@ -0,0 +1,122 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+// Scaling of JobSystem::parallelFor with the number of workers, on an even workload (the same
+// math for every element) and an uneven one (the cost grows along the range, so the workers
+// that finish early have to steal). Results are checked against a run without workers.
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <boost/thread/thread.hpp>
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+#include "shoggoth-engine/common/clock.hpp"
+
+using namespace std;
+
+const size_t TOTAL_ELEMENTS = 1 << 18;
+const size_t GRAIN_SIZE = 512;
+const size_t ITERATIONS = 16;
+const size_t RUNS = 5;
+
+class Workload {
+public:
+    Workload():
+        m_input(TOTAL_ELEMENTS),
+        m_output(TOTAL_ELEMENTS, 0.0)
+    {
+        for (size_t i = 0; i < TOTAL_ELEMENTS; ++i)
+            m_input[i] = double(i % 1000) * 0.001;
+    }
+
+    const vector<double>& getOutput() const {
+        return m_output;
+    }
+
+    void even(const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            m_output[i] = iterate(m_input[i], ITERATIONS);
+    }
+
+    void uneven(const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            m_output[i] = iterate(m_input[i], 1 + ITERATIONS * 2 * i / TOTAL_ELEMENTS);
+    }
+
+private:
+    vector<double> m_input;
+    vector<double> m_output;
+
+    static double iterate(double x, const size_t iterations) {
+        for (size_t n = 0; n < iterations; ++n)
+            x = sin(x) * 0.5 + sqrt(x * x + 1.0) * 0.25;
+        return x;
+    }
+};
+
+double bestRunMs(const job_slot_t& slot) {
+    boost::uint64_t best = boost::uint64_t(-1);
+    for (size_t run = 0; run < RUNS; ++run) {
+        boost::uint64_t startTime = Clock::nanoseconds();
+        JobSystem::parallelFor(0, TOTAL_ELEMENTS, GRAIN_SIZE, slot);
+        best = min(best, Clock::nanoseconds() - startTime);
+    }
+    return double(best) * 1.0e-6;
+}
+
+// an optional argument sets the most threads to try, by default all the hardware threads
+int main(int argc, char** argv) {
+    size_t cores = argc > 1? size_t(atoi(argv[1])) : boost::thread::hardware_concurrency();
+    Workload reference;
+    reference.even(0, TOTAL_ELEMENTS);
+
+    cout << TOTAL_ELEMENTS << " elements in jobs of " << GRAIN_SIZE << ", best of " << RUNS << " runs, "
+         << boost::thread::hardware_concurrency() << " hardware threads" << endl;
+    cout << "threads     even ms  speedup   uneven ms  speedup" << endl;
+
+    double evenBase = 0.0;
+    double unevenBase = 0.0;
+    for (size_t workers = 0; workers < max(cores, size_t(1)); ++workers) {
+        JobSystem::initialize(workers);
+        Workload workload;
+        double evenMs = bestRunMs(job_slot_t::fromMethod<Workload, &Workload::even>(&workload));
+        if (workload.getOutput() != reference.getOutput())
+            cerr << "Error: wrong results with " << workers << " workers" << endl;
+        double unevenMs = bestRunMs(job_slot_t::fromMethod<Workload, &Workload::uneven>(&workload));
+        JobSystem::shutdown();
+
+        if (workers == 0) {
+            evenBase = evenMs;
+            unevenBase = unevenMs;
+        }
+        cout << fixed << setprecision(2)
+             << setw(7) << workers + 1 << setw(12) << evenMs << setw(8) << evenBase / evenMs << "x"
+             << setw(12) << unevenMs << setw(8) << unevenBase / unevenMs << "x" << endl;
+    }
+    return 0;
+}
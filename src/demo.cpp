@@ -31,10 +31,20 @@
 #include <fstream>
 #include <iomanip>
 #include <cstdlib>
+#include <cstdio>
 #include <ctime>
+#include <algorithm>
 #include <SDL/SDL.h>
+#include "shoggoth-engine/common/clock.hpp"
 #include "shoggoth-engine/kernel/entity.hpp"
 #include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/binaryscript.hpp"
+#include "shoggoth-engine/kernel/asyncjob.hpp"
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+#include "shoggoth-engine/kernel/frametimer.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+#include "shoggoth-engine/kernel/startuptimer.hpp"
 #include "shoggoth-engine/kernel/model.hpp"
 #include "shoggoth-engine/renderer/renderablemesh.hpp"
 #include "shoggoth-engine/renderer/camera.hpp"
@@ -45,8 +55,7 @@
 
 using namespace std;
 
-const unsigned int FRAMERATE_LIMIT = 60;
-const unsigned int MILLISECONDS_LIMIT = 1000 / FRAMERATE_LIMIT;
+const size_t TITLE_SIZE = 128;
 
 const size_t MAX_CUBES = 30;
 const size_t MAX_MODELS = 3;
@@ -57,28 +66,70 @@ const double MISSILE_SIZE = 0.5;
 vector<string> g_materials;
 
 
+// Reads a text script on the worker, its commands are parsed and run when committing
+class RunScriptJob: public AsyncJob {
+public:
+    RunScriptJob(const string& fileName):
+        AsyncJob(),
+        m_fileName(fileName),
+        m_lines()
+    {}
+
+    void run() {
+        Terminal::readScriptLines(m_fileName, m_lines);
+    }
+
+    string commit() {
+        cout << Terminal::runScriptLines(m_lines);
+        return "";
+    }
+
+private:
+    string m_fileName;
+    vector<string> m_lines;
+};
+
+
 Demo::Demo(const string& objectName,
+           const string& terminalName,
+           const string& profilerName,
            const string& deviceName,
            const string& rendererName,
            const string& physicsWorldName,
+           const string& simulationLoopName,
+           const string& framePacerName,
            const string& sceneName,
-           const string& rootNodeName):
+           const string& rootNodeName,
+           const bool isHeadless):
     CommandObject(objectName),
     m_isRunning(false),
-    m_device(deviceName),
+    m_isPipelined(false),
+    m_title(),
+    m_terminal(terminalName),
+    m_profiler(profilerName),
+    m_device(deviceName, isHeadless),
     m_renderer(rendererName, &m_device),
     m_physicsWorld(physicsWorldName),
+    m_simulationLoop(simulationLoopName),
+    m_framePipeline(&m_simulationLoop, FramePipeline::step_slot_t::fromMethod<PhysicsWorld, &PhysicsWorld::stepFixed>(&m_physicsWorld)),
+    m_framePacer(framePacerName),
     m_componentFactory(&m_renderer, &m_physicsWorld),
     m_scene(sceneName, rootNodeName, &m_componentFactory, &m_device, &m_renderer, &m_physicsWorld)
 {
-    registerCommand("quit", boost::bind(&Demo::cmdQuit, this, _1));
-    registerCommand("run", boost::bind(&Demo::cmdRunCommand, this, _1));
-    registerCommand("print-entity", boost::bind(&Demo::cmdPrint, this, _1));
-    registerCommand("on-mouse-motion", boost::bind(&Demo::cmdOnMouseMotion, this, _1));
-    registerCommand("fire-cube", boost::bind(&Demo::cmdFireCube, this, _1));
-    registerCommand("fire-sphere", boost::bind(&Demo::cmdFireModel, this, _1));
+    registerCommand("quit", slot_t::fromMethod<Demo, &Demo::cmdQuit>(this));
+    registerCommand("pipeline-stats", slot_t::fromMethod<Demo, &Demo::cmdPipelineStats>(this));
+    registerAttribute("pipelined", slot_t::fromMethod<Demo, &Demo::cmdPipelined>(this));
+    registerAsyncCommand("run", async_slot_t::fromMethod<Demo, &Demo::cmdRunCommand>(this));
+    registerCommand("print-entity", slot_t::fromMethod<Demo, &Demo::cmdPrint>(this));
+    registerCommand("on-mouse-motion", slot_t::fromMethod<Demo, &Demo::cmdOnMouseMotion>(this));
+    registerCommand("fire-cube", slot_t::fromMethod<Demo, &Demo::cmdFireCube>(this));
+    registerCommand("fire-sphere", slot_t::fromMethod<Demo, &Demo::cmdFireModel>(this));
 
     srand((unsigned int)(time(0)));
+    m_title.reserve(TITLE_SIZE);
+    // a headless run goes as fast as it can
+    if (isHeadless)
+        m_framePacer.setTargetFps(0.0);
 
     g_materials.push_back("assets/materials/black.material");
     g_materials.push_back("assets/materials/blue.material");
@@ -92,16 +143,21 @@ Demo::Demo(const string& objectName,
     g_materials.push_back("assets/materials/white.material");
     g_materials.push_back("assets/materials/yellow.material");
 
+    StartupPhase phase("Resolution");
     m_device.setResolution(800, 600);
-    OpenGL::forceFixedPipeline(false);
-    OpenGL::setTextureFilteringMode(TEXTURE_FILTERING_ANISOTROPIC);
-    OpenGL::setAnisotropy(4.0f);
+    if (!OpenGL::isNullRenderer()) {
+        OpenGL::forceFixedPipeline(false);
+        OpenGL::setTextureFilteringMode(TEXTURE_FILTERING_ANISOTROPIC);
+        OpenGL::setAnisotropy(4.0f);
+    }
 }
 
 Demo::~Demo() {
+    JobSystem::shutdown();
+    Logger::shutdown();
 }
 
-void Demo::loadScene() {
+void Demo::loadScene(const string& fileName) {
     // model            faces (triangles)
     // icosphere1              20
     // icosphere2              80
@@ -115,7 +171,7 @@ void Demo::loadScene() {
     // icosphere10      5,242,880
 
     cout << "Loading scene..." << endl;
-    m_scene.loadFromXML("assets/scenes/demo.xml");
+    m_scene.loadFromXML(fileName);
 }
 
 void Demo::bindInputs() {
@@ -142,8 +198,9 @@ void Demo::bindInputs() {
 }
 
 void Demo::runMainLoop() {
-    Uint32 startTime;
-    Uint32 deltaTime;
+    Histogram frameTimes;
+    char title[TITLE_SIZE];
+    bool isFirstFrame = true;
 
     // test to measure commands performance
 //     startTime = SDL_GetTicks();
@@ -155,38 +212,108 @@ void Demo::runMainLoop() {
     cout << endl;
     cout << "Entering main loop" << endl;
     m_isRunning = true;
+    m_simulationLoop.reset();
+    m_framePacer.reset();
     while (m_isRunning) {
-        startTime = SDL_GetTicks();
+        TraceScope trace("Demo::runMainLoop frame");
         m_device.onFrameStart();
 
-        // update
-        m_physicsWorld.stepSimulation(0.001 * SDL_GetTicks());
+        // update, inputs and commands every frame and physics at a fixed rate
         m_device.processEvents(m_isRunning);
-        cout << Terminal::processCommandsQueue();
-
-        // measure CPU load
-        stringstream ss;
-        deltaTime = SDL_GetTicks() - startTime;
-        ss << "Shoggoth Engine Demo - CPU:" << setw(3) << deltaTime << " ms - ";
+        const string& output = Terminal::processCommandsQueue();
+        if (!output.empty())
+            cout << output;
+        if (m_isPipelined) {
+            // draw the state the steps start from while they run
+            m_renderer.buildFrame(m_simulationLoop.getAlpha());
+            m_framePipeline.startStage();
+            m_renderer.submitFrame();
+            m_framePipeline.waitStage();
+        }
+        else {
+            m_simulationLoop.beginFrame();
+            while (m_simulationLoop.step())
+                m_physicsWorld.stepFixed(m_simulationLoop.getTimestep());
 
-        // draw and measure GPU load
-        startTime = SDL_GetTicks();
-        m_renderer.draw();
-        deltaTime = SDL_GetTicks() - startTime;
-        ss << "GPU:" << setw(3) << deltaTime << " ms (16-40 ideal) - ";
+            // draw
+            m_renderer.draw(m_simulationLoop.getAlpha());
+        }
 
-        // framerate cap
-        deltaTime = SDL_GetTicks() - startTime;
-        if (MILLISECONDS_LIMIT > deltaTime)
-            SDL_Delay(MILLISECONDS_LIMIT - deltaTime);
+        // framerate cap over the whole frame
+        m_framePacer.wait();
 
-        // show framerate
+        // show frame times, the percentiles show the stutter an average hides
         m_device.onFrameEnd();
-        ss << setw(5) << fixed << setprecision(1) << m_device.getFps() << " fps";
-        m_device.setTitle(ss.str());
+        if (isFirstFrame) {
+            StartupTimer::finish();
+            LogInfo() << "First frame after " << double(StartupTimer::getTimeToFirstFrame()) * 1.0e-6 << " ms";
+            isFirstFrame = false;
+        }
+        FrameTimer::getHistogram(FRAME_PHASE_TOTAL, frameTimes);
+        snprintf(title, sizeof(title), "Shoggoth Engine Demo - frame p50:%5.1f ms p99:%5.1f ms - %5.1f fps",
+                 double(frameTimes.getPercentile(50.0)) * 1.0e-6,
+                 double(frameTimes.getPercentile(99.0)) * 1.0e-6, m_device.getFps());
+        // formatted in place and only set when it changes, no stream or string per frame
+        if (m_title != title) {
+            m_title.assign(title);
+            m_device.setTitle(m_title);
+        }
     }
     cout << "Ending main loop" << endl;
     cout << endl;
+
+    if (Terminal::isRecording() && Terminal::stopRecording())
+        cout << "Recording saved" << endl;
+}
+
+void Demo::runReplay(const string& fileName) {
+    if (!Terminal::startReplay(fileName)) {
+        cerr << "Error: could not replay " << fileName << endl;
+        return;
+    }
+
+    // replays run as fast as possible with a fixed timestep, so they are deterministic
+    m_device.setFixedDeltaTime(FIXED_TIMESTEP);
+
+    size_t frames = 0;
+    boost::uint64_t minFrameTime = boost::uint64_t(-1);
+    boost::uint64_t maxFrameTime = 0;
+    boost::uint64_t replayStartTime = Clock::nanoseconds();
+
+    cout << endl;
+    cout << "Replaying " << fileName << endl;
+    m_isRunning = true;
+    while (m_isRunning && Terminal::isReplaying()) {
+        boost::uint64_t frameStartTime = Clock::nanoseconds();
+        m_device.onFrameStart();
+
+        // same order as the main loop, the commands of a frame run before its physics step
+        m_device.processEvents(m_isRunning);
+        cout << Terminal::processCommandsQueue();
+        m_physicsWorld.stepFixed(FIXED_TIMESTEP);
+        m_renderer.draw();
+
+        m_device.onFrameEnd();
+        boost::uint64_t frameTime = Clock::nanoseconds() - frameStartTime;
+        minFrameTime = min(minFrameTime, frameTime);
+        maxFrameTime = max(maxFrameTime, frameTime);
+        ++frames;
+    }
+    double totalTime = double(Clock::nanoseconds() - replayStartTime) * 1.0e-9;
+    m_device.setFixedDeltaTime(0.0);
+
+    cout << "Replay finished" << endl;
+    cout << fixed << setprecision(3);
+    cout << "  frames:          " << frames << endl;
+    cout << "  simulated time:  " << double(frames) * FIXED_TIMESTEP << " s" << endl;
+    cout << "  wall time:       " << totalTime << " s" << endl;
+    if (frames > 0) {
+        cout << "  frame time:      " << totalTime * 1000.0 / double(frames) << " ms avg, "
+             << double(minFrameTime) * 1.0e-6 << " ms min, "
+             << double(maxFrameTime) * 1.0e-6 << " ms max" << endl;
+        cout << "  framerate:       " << double(frames) / totalTime << " fps" << endl;
+    }
+    cout << endl;
 }
 
 string Demo::cmdQuit(std::deque<std::string>&) {
@@ -194,10 +321,25 @@ string Demo::cmdQuit(std::deque<std::string>&) {
     return "";
 }
 
-string Demo::cmdRunCommand(std::deque<std::string>& args) {
+string Demo::cmdPipelined(std::deque<std::string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    m_isPipelined = boost::lexical_cast<bool>(args[0]);
+    return string("Pipelined frames ") + (m_isPipelined? "enabled" : "disabled");
+}
+
+string Demo::cmdPipelineStats(std::deque<std::string>&) {
+    return m_framePipeline.report();
+}
+
+string Demo::cmdRunCommand(std::deque<std::string>& args, AsyncJob*& job) {
     if (args.size() < 1)
         return "Error: too few arguments";
-    cout << Terminal::runScript(args[0]);
+    // compiled scripts are mapped, not read, so there is nothing to wait for
+    if (BinaryScript::isBinaryScript(args[0]))
+        cout << Terminal::runScript(args[0]);
+    else
+        job = new RunScriptJob(args[0]);
     return "";
 }
 
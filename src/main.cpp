@@ -28,14 +28,56 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <string>
+#include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/commandserver.hpp"
+#include "shoggoth-engine/kernel/scene.hpp"
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+#include "shoggoth-engine/kernel/startuptimer.hpp"
 #include "demo.hpp"
 
 using namespace std;
 
-int main(int, char**) {
-    Demo demo("demo", "device", "renderer", "physics-world", "scene", "root");
-    demo.loadScene();
+const string SCENE_FILE = "assets/scenes/demo.xml";
+
+int main(int argc, char** argv) {
+    StartupTimer::start();
+    string recordFileName;
+    string replayFileName;
+    string endpoint;
+    bool isHeadless = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--headless")
+            isHeadless = true;
+        else if (i + 1 == argc)
+            break;
+        else if (arg == "--record")
+            recordFileName = argv[++i];
+        else if (arg == "--replay")
+            replayFileName = argv[++i];
+        else if (arg == "--listen")
+            endpoint = argv[++i];
+    }
+
+    // the scene is read by the workers while the device and renderer start, the demo shuts
+    // the logger and the job system down
+    Logger::initialize();
+    JobSystem::initialize();
+    Scene::prefetchXML(SCENE_FILE);
+
+    Demo demo("demo", "terminal", "profiler", "device", "renderer", "physics-world", "simulation", "pacer", "scene", "root", isHeadless);
+    demo.loadScene(SCENE_FILE);
+    if (!endpoint.empty())
+        CommandServer::listen(endpoint);
+    if (!replayFileName.empty()) {
+        demo.runReplay(replayFileName);
+        return EXIT_SUCCESS;
+    }
     demo.bindInputs();
+    if (!recordFileName.empty())
+        Terminal::startRecording(recordFileName);
     demo.runMainLoop();
     return EXIT_SUCCESS;
 }
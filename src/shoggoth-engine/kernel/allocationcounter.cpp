@@ -0,0 +1,93 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/allocationcounter.hpp"
+
+#ifdef SHOGGOTH_COUNT_ALLOCATIONS
+
+#include <new>
+#include <cstdlib>
+#include <boost/atomic.hpp>
+
+#if __cplusplus >= 201103L
+#define THROWS_BAD_ALLOC
+#define THROWS_NOTHING noexcept
+#else
+#define THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define THROWS_NOTHING throw()
+#endif
+
+boost::atomic<boost::uint64_t> g_totalAllocations(0);
+
+void* operator new(size_t size) THROWS_BAD_ALLOC {
+    g_totalAllocations.fetch_add(1, boost::memory_order_relaxed);
+    void* ptr = malloc(size != 0? size : 1);
+    if (ptr == 0)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) THROWS_BAD_ALLOC {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) THROWS_NOTHING {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) THROWS_NOTHING {
+    free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete(void* ptr, size_t) THROWS_NOTHING {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) THROWS_NOTHING {
+    free(ptr);
+}
+#endif
+
+bool AllocationCounter::isCounting() {
+    return true;
+}
+
+boost::uint64_t AllocationCounter::getTotalAllocations() {
+    return g_totalAllocations.load(boost::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::isCounting() {
+    return false;
+}
+
+boost::uint64_t AllocationCounter::getTotalAllocations() {
+    return 0;
+}
+
+#endif // SHOGGOTH_COUNT_ALLOCATIONS
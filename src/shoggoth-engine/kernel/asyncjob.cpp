@@ -0,0 +1,65 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/asyncjob.hpp"
+
+#include <iostream>
+#include "shoggoth-engine/kernel/terminal.hpp"
+
+using namespace std;
+
+AsyncJob::AsyncJob():
+    m_owner(0),
+    m_idOwner(0),
+    m_completionCommand()
+{}
+
+AsyncJob::~AsyncJob() {}
+
+bool AsyncJob::isOwnerAlive() const {
+    CommandObject* object;
+    return m_owner != 0 && Terminal::getObject(m_idOwner, object) && object == m_owner;
+}
+
+void AsyncJob::setOwner(CommandObject* owner) {
+    m_owner = owner;
+    m_idOwner = owner->getIdObject();
+}
+
+
+
+AsyncJob::AsyncJob(const AsyncJob& rhs):
+    m_owner(rhs.m_owner),
+    m_idOwner(rhs.m_idOwner),
+    m_completionCommand(rhs.m_completionCommand)
+{
+    cerr << "Error: AsyncJob copy constructor should not be called!" << endl;
+}
+
+AsyncJob& AsyncJob::operator=(const AsyncJob&) {
+    cerr << "Error: AsyncJob assignment operator should not be called!" << endl;
+    return *this;
+}
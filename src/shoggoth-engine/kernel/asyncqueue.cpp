@@ -0,0 +1,146 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/asyncqueue.hpp"
+
+#include "shoggoth-engine/common/clock.hpp"
+#include "shoggoth-engine/kernel/asyncjob.hpp"
+#include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+
+using namespace std;
+
+// commits can be heavy too (GPU uploads), the remaining ones wait for the next frame
+const boost::uint64_t COMMIT_BUDGET_NS = 4000000;
+
+boost::thread* AsyncQueue::ms_worker = 0;
+boost::mutex AsyncQueue::ms_mutex;
+boost::condition_variable AsyncQueue::ms_condition;
+deque<AsyncJob*> AsyncQueue::ms_pendingJobs = deque<AsyncJob*>();
+deque<AsyncJob*> AsyncQueue::ms_finishedJobs = deque<AsyncJob*>();
+size_t AsyncQueue::ms_totalJobs = 0;
+bool AsyncQueue::ms_isShuttingDown = false;
+
+string AsyncQueue::submit(AsyncJob* job) {
+    // replays must apply every result on the same frame they were recorded
+    if (Terminal::isReplaying()) {
+        job->run();
+        return commitJob(job);
+    }
+
+    if (ms_worker == 0)
+        ms_worker = new boost::thread(&AsyncQueue::runWorker);
+    {
+        boost::lock_guard<boost::mutex> lock(ms_mutex);
+        ms_pendingJobs.push_back(job);
+    }
+    ms_condition.notify_one();
+    ++ms_totalJobs;
+    return "";
+}
+
+string AsyncQueue::commitFinishedJobs() {
+    string output;
+    if (ms_totalJobs == 0)
+        return output;
+
+    AsyncJob* job;
+    string jobOutput;
+    boost::uint64_t startTime = Clock::nanoseconds();
+    while (Clock::nanoseconds() - startTime < COMMIT_BUDGET_NS && popFinishedJob(job)) {
+        --ms_totalJobs;
+        jobOutput = commitJob(job);
+        if (!jobOutput.empty())
+            output.append(jobOutput + "\n");
+    }
+    return output;
+}
+
+void AsyncQueue::shutdown() {
+    if (ms_worker == 0)
+        return;
+    {
+        boost::lock_guard<boost::mutex> lock(ms_mutex);
+        ms_isShuttingDown = true;
+    }
+    ms_condition.notify_one();
+    ms_worker->join();
+    delete ms_worker;
+    ms_worker = 0;
+    ms_isShuttingDown = false;
+
+    if (ms_totalJobs > 0)
+        LogInfo() << "Discarding " << ms_totalJobs << " unfinished async jobs";
+    for (size_t i = 0; i < ms_pendingJobs.size(); ++i)
+        delete ms_pendingJobs[i];
+    for (size_t i = 0; i < ms_finishedJobs.size(); ++i)
+        delete ms_finishedJobs[i];
+    ms_pendingJobs.clear();
+    ms_finishedJobs.clear();
+    ms_totalJobs = 0;
+}
+
+
+
+void AsyncQueue::runWorker() {
+    boost::unique_lock<boost::mutex> lock(ms_mutex);
+    while (!ms_isShuttingDown) {
+        if (ms_pendingJobs.empty()) {
+            ms_condition.wait(lock);
+            continue;
+        }
+        AsyncJob* job = ms_pendingJobs.front();
+        ms_pendingJobs.pop_front();
+
+        lock.unlock();
+        job->run();
+        lock.lock();
+
+        ms_finishedJobs.push_back(job);
+    }
+}
+
+bool AsyncQueue::popFinishedJob(AsyncJob*& job) {
+    boost::lock_guard<boost::mutex> lock(ms_mutex);
+    if (ms_finishedJobs.empty())
+        return false;
+    job = ms_finishedJobs.front();
+    ms_finishedJobs.pop_front();
+    return true;
+}
+
+string AsyncQueue::commitJob(AsyncJob* job) {
+    string output;
+    if (job->isOwnerAlive()) {
+        output = job->commit();
+        if (!job->getCompletionCommand().empty())
+            Terminal::pushCommand(job->getCompletionCommand());
+    }
+    else
+        LogError() << "Async job dropped, its object no longer exists";
+    delete job;
+    return output;
+}
@@ -0,0 +1,360 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/binaryscript.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <sstream>
+#include <boost/interprocess/file_mapping.hpp>
+#include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/objectselector.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+
+using namespace std;
+using namespace boost;
+
+const char BINARY_SCRIPT_MAGIC[] = {'S', 'H', 'S', 'C'};
+const uint32_t BINARY_SCRIPT_VERSION = 2;
+
+const uint32_t NO_TOKEN = uint32_t(-1);
+const size_t UNRESOLVED_ID = size_t(-1);
+
+bool isNumber(const string& argument) {
+    double number;
+    istringstream ss(argument);
+    ss >> number;
+    return !ss.fail() && ss.eof();
+}
+
+// ids are only meaningful for the token tables as they are when recording starts
+BinaryScriptWriter::BinaryScriptWriter():
+    m_objectsFingerprint(Terminal::ms_objectsTable.fingerprint()),
+    m_commandsFingerprint(Terminal::ms_commandsTable.fingerprint()),
+    m_objects(),
+    m_commandNames(),
+    m_commands(),
+    m_arguments(),
+    m_pool(),
+    m_poolOffsets(),
+    m_objectIndices(),
+    m_commandIndices()
+{}
+
+void BinaryScriptWriter::clear() {
+    m_objectsFingerprint = Terminal::ms_objectsTable.fingerprint();
+    m_commandsFingerprint = Terminal::ms_commandsTable.fingerprint();
+    m_objects.clear();
+    m_commandNames.clear();
+    m_commands.clear();
+    m_arguments.clear();
+    m_pool.clear();
+    m_poolOffsets.clear();
+    m_objectIndices.clear();
+    m_commandIndices.clear();
+}
+
+void BinaryScriptWriter::appendCommand(const Command& cmd, const size_t frame) {
+    if (!cmd.isSelection()) {
+        appendCommand(cmd.getIdObject(), cmd.getIdCommand(), cmd.getArguments(), frame);
+        return;
+    }
+    // scripts only store object ids, so a selection is expanded to the objects it matches now
+    vector<CommandObject*> objects;
+    ObjectSelector::select(cmd.getSelector(), objects);
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (objects[i]->isCommandFound(cmd.getIdCommand()))
+            appendCommand(objects[i]->getIdObject(), cmd.getIdCommand(), cmd.getArguments(), frame);
+    }
+}
+
+void BinaryScriptWriter::appendCommand(const size_t idObject, const size_t idCommand, const deque<string>& arguments, const size_t frame) {
+    // the object owning an id when the command runs, a later one may get the same id
+    pair<size_t, string> object(idObject, Terminal::getObjectName(idObject));
+    object_index_t::const_iterator itObject = m_objectIndices.find(object);
+    if (itObject == m_objectIndices.end())
+        itObject = m_objectIndices.insert(pair<pair<size_t, string>, uint32_t>(object, appendToken(idObject, object.second, m_objects))).first;
+    if (m_commandIndices.find(idCommand) == m_commandIndices.end())
+        m_commandIndices.insert(pair<size_t, uint32_t>(idCommand, appendToken(idCommand, Terminal::findCommandName(idCommand), m_commandNames)));
+
+    script_command_t command;
+    command.frame = uint32_t(frame);
+    command.idObject = uint32_t(idObject);
+    command.objectToken = itObject->second;
+    command.idCommand = uint32_t(idCommand);
+    command.firstArgument = uint32_t(m_arguments.size());
+    command.totalArguments = uint32_t(arguments.size());
+    m_commands.push_back(command);
+
+    script_argument_t argument;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        argument.offset = appendToPool(arguments[i]);
+        argument.length = uint32_t(arguments[i].size());
+        argument.type = isNumber(arguments[i])? ARGUMENT_NUMBER : ARGUMENT_STRING;
+        m_arguments.push_back(argument);
+    }
+}
+
+bool BinaryScriptWriter::save(const string& fileName) const {
+    ofstream file(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!file.is_open() || !file.good()) {
+        LogError() << "Error: could not open file: " << fileName;
+        return false;
+    }
+
+    script_header_t header;
+    memcpy(header.magic, BINARY_SCRIPT_MAGIC, sizeof(header.magic));
+    header.version = BINARY_SCRIPT_VERSION;
+    header.objectsFingerprint = m_objectsFingerprint;
+    header.commandsFingerprint = m_commandsFingerprint;
+    header.totalObjects = uint32_t(m_objects.size());
+    header.totalCommandNames = uint32_t(m_commandNames.size());
+    header.totalCommands = uint32_t(m_commands.size());
+    header.totalArguments = uint32_t(m_arguments.size());
+    header.poolSize = uint32_t(m_pool.size());
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(script_header_t));
+    if (!m_objects.empty())
+        file.write(reinterpret_cast<const char*>(&m_objects[0]), streamsize(m_objects.size() * sizeof(script_token_t)));
+    if (!m_commandNames.empty())
+        file.write(reinterpret_cast<const char*>(&m_commandNames[0]), streamsize(m_commandNames.size() * sizeof(script_token_t)));
+    if (!m_commands.empty())
+        file.write(reinterpret_cast<const char*>(&m_commands[0]), streamsize(m_commands.size() * sizeof(script_command_t)));
+    if (!m_arguments.empty())
+        file.write(reinterpret_cast<const char*>(&m_arguments[0]), streamsize(m_arguments.size() * sizeof(script_argument_t)));
+    file.write(m_pool.data(), streamsize(m_pool.size()));
+    file.close();
+    return true;
+}
+
+uint32_t BinaryScriptWriter::appendToken(const size_t id, const string& name, vector<script_token_t>& tokens) {
+    script_token_t token;
+    token.id = uint32_t(id);
+    token.offset = appendToPool(name);
+    token.length = uint32_t(name.size());
+    tokens.push_back(token);
+    return uint32_t(tokens.size() - 1);
+}
+
+uint32_t BinaryScriptWriter::appendToPool(const string& str) {
+    map<string, uint32_t>::const_iterator it = m_poolOffsets.find(str);
+    if (it != m_poolOffsets.end())
+        return it->second;
+    uint32_t offset = uint32_t(m_pool.size());
+    m_pool.append(str);
+    m_poolOffsets.insert(pair<string, uint32_t>(str, offset));
+    return offset;
+}
+
+
+
+BinaryScript::BinaryScript():
+    m_region(),
+    m_header(0),
+    m_objects(0),
+    m_commandNames(0),
+    m_commands(0),
+    m_arguments(0),
+    m_pool(0),
+    m_isRemapped(false),
+    m_commandTokens(),
+    m_commandIds()
+{}
+
+bool BinaryScript::isBinaryScript(const string& fileName) {
+    char magic[sizeof(BINARY_SCRIPT_MAGIC)];
+    ifstream file(fileName.c_str(), ios::in | ios::binary);
+    if (!file.is_open() || !file.good())
+        return false;
+    file.read(magic, sizeof(magic));
+    return file.good() && memcmp(magic, BINARY_SCRIPT_MAGIC, sizeof(magic)) == 0;
+}
+
+bool BinaryScript::load(const string& fileName) {
+    close();
+
+    // check the file first, mapping a missing or truncated file throws
+    ifstream file(fileName.c_str(), ios::in | ios::binary | ios::ate);
+    if (!file.is_open() || !file.good()) {
+        LogError() << "Error: could not open file: " << fileName;
+        return false;
+    }
+    size_t fileSize = size_t(file.tellg());
+    file.close();
+    if (fileSize < sizeof(script_header_t)) {
+        LogError() << "Error: invalid binary script: " << fileName;
+        return false;
+    }
+
+    interprocess::file_mapping mapping(fileName.c_str(), interprocess::read_only);
+    interprocess::mapped_region region(mapping, interprocess::read_only);
+    m_region.swap(region);
+
+    const char* data = static_cast<const char*>(m_region.get_address());
+    const script_header_t* header = reinterpret_cast<const script_header_t*>(data);
+    size_t expectedSize = sizeof(script_header_t) +
+                          (size_t(header->totalObjects) + header->totalCommandNames) * sizeof(script_token_t) +
+                          size_t(header->totalCommands) * sizeof(script_command_t) +
+                          size_t(header->totalArguments) * sizeof(script_argument_t) +
+                          header->poolSize;
+    if (memcmp(header->magic, BINARY_SCRIPT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != BINARY_SCRIPT_VERSION ||
+        expectedSize != fileSize)
+    {
+        LogError() << "Error: invalid binary script: " << fileName;
+        close();
+        return false;
+    }
+
+    data += sizeof(script_header_t);
+    m_objects = reinterpret_cast<const script_token_t*>(data);
+    data += header->totalObjects * sizeof(script_token_t);
+    m_commandNames = reinterpret_cast<const script_token_t*>(data);
+    data += header->totalCommandNames * sizeof(script_token_t);
+    m_commands = reinterpret_cast<const script_command_t*>(data);
+    data += header->totalCommands * sizeof(script_command_t);
+    m_arguments = reinterpret_cast<const script_argument_t*>(data);
+    data += header->totalArguments * sizeof(script_argument_t);
+    m_pool = data;
+    m_header = header;
+
+    for (size_t i = 0; i < header->totalObjects; ++i) {
+        if (size_t(m_objects[i].offset) + m_objects[i].length > header->poolSize) {
+            LogError() << "Error: invalid binary script: " << fileName;
+            close();
+            return false;
+        }
+    }
+
+    // the stored ids are still valid when replaying from the tables the recording started
+    // with, otherwise the tokens are looked up again by name. Command names are looked up
+    // once, objects every time (they may be created and removed by the script itself)
+    m_isRemapped = header->objectsFingerprint != Terminal::ms_objectsTable.fingerprint() ||
+                   header->commandsFingerprint != Terminal::ms_commandsTable.fingerprint();
+    if (m_isRemapped && !indexTokens(m_commandNames, header->totalCommandNames, m_commandTokens, m_commandIds)) {
+        LogError() << "Error: invalid binary script: " << fileName;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void BinaryScript::close() {
+    interprocess::mapped_region region;
+    m_region.swap(region);
+    m_header = 0;
+    m_objects = 0;
+    m_commandNames = 0;
+    m_commands = 0;
+    m_arguments = 0;
+    m_pool = 0;
+    m_isRemapped = false;
+    m_commandTokens.clear();
+    m_commandIds.clear();
+}
+
+bool BinaryScript::getCommand(const size_t i, Command& cmd) const {
+    const script_command_t& command = m_commands[i];
+    if (m_isRemapped) {
+        if (!resolveObjectId(command.objectToken, cmd.m_idObject) ||
+            !resolveId(command.idCommand, m_commandNames, m_commandTokens, Terminal::ms_commandsTable, m_commandIds, cmd.m_idCommand))
+            return false;
+    }
+    else {
+        cmd.m_idObject = command.idObject;
+        cmd.m_idCommand = command.idCommand;
+    }
+
+    if (size_t(command.firstArgument) + command.totalArguments > m_header->totalArguments)
+        return false;
+    cmd.m_selector.resize(0);
+    cmd.m_arguments.resize(command.totalArguments);
+    for (size_t n = 0; n < command.totalArguments; ++n) {
+        const script_argument_t& argument = m_arguments[command.firstArgument + n];
+        if (size_t(argument.offset) + argument.length > m_header->poolSize)
+            return false;
+        cmd.m_arguments[n].assign(m_pool + argument.offset, argument.length);
+    }
+    cmd.m_output.resize(0);
+    return true;
+}
+
+
+
+BinaryScript::BinaryScript(const BinaryScript& rhs):
+    m_region(),
+    m_header(rhs.m_header),
+    m_objects(rhs.m_objects),
+    m_commandNames(rhs.m_commandNames),
+    m_commands(rhs.m_commands),
+    m_arguments(rhs.m_arguments),
+    m_pool(rhs.m_pool),
+    m_isRemapped(rhs.m_isRemapped),
+    m_commandTokens(rhs.m_commandTokens),
+    m_commandIds(rhs.m_commandIds)
+{
+    cerr << "Error: BinaryScript copy constructor should not be called!" << endl;
+}
+
+BinaryScript& BinaryScript::operator=(const BinaryScript&) {
+    cerr << "Error: BinaryScript assignment operator should not be called!" << endl;
+    return *this;
+}
+
+bool BinaryScript::indexTokens(const script_token_t* tokens, const size_t totalTokens, vector<uint32_t>& tokenIndices, vector<size_t>& ids) const {
+    tokenIndices.clear();
+    for (size_t i = 0; i < totalTokens; ++i) {
+        if (size_t(tokens[i].offset) + tokens[i].length > m_header->poolSize)
+            return false;
+        if (tokens[i].id >= tokenIndices.size())
+            tokenIndices.resize(tokens[i].id + 1, NO_TOKEN);
+        tokenIndices[tokens[i].id] = uint32_t(i);
+    }
+    ids.assign(tokenIndices.size(), UNRESOLVED_ID);
+    return true;
+}
+
+bool BinaryScript::resolveObjectId(const size_t objectToken, size_t& id) const {
+    if (objectToken >= m_header->totalObjects)
+        return false;
+    const script_token_t& token = m_objects[objectToken];
+    return Terminal::ms_objectsTable.findId(id, string(m_pool + token.offset, token.length));
+}
+
+bool BinaryScript::resolveId(const size_t storedId, const script_token_t* tokens, const vector<uint32_t>& tokenIndices, const TokenTable& table, vector<size_t>& ids, size_t& id) const {
+    if (storedId >= tokenIndices.size() || tokenIndices[storedId] == NO_TOKEN)
+        return false;
+    if (ids[storedId] == UNRESOLVED_ID) {
+        const script_token_t& token = tokens[tokenIndices[storedId]];
+        if (!table.findId(ids[storedId], string(m_pool + token.offset, token.length))) {
+            ids[storedId] = UNRESOLVED_ID;
+            return false;
+        }
+    }
+    id = ids[storedId];
+    return true;
+}
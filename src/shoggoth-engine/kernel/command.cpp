@@ -29,14 +29,15 @@
 #include <sstream>
 #include "shoggoth-engine/kernel/terminal.hpp"
 #include "shoggoth-engine/kernel/commandobject.hpp"
+#include "shoggoth-engine/kernel/objectselector.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
-const char COMMENT_CHAR = '#';
-
 Command::Command():
     m_idObject(0),
     m_idCommand(0),
+    m_selector(),
     m_arguments(),
     m_output(),
     m_empty()
@@ -46,11 +47,20 @@ void Command::appendToArguments(const string& newArg) {
     m_arguments.push_back(newArg);
 }
 
+bool Command::getArgumentAsNumber(const size_t i, double& number) const {
+    if (i >= m_arguments.size())
+        return false;
+    istringstream ss(m_arguments[i]);
+    ss >> number;
+    return !ss.fail() && ss.eof();
+}
+
 bool Command::parseCommand(const string& expression) {
     string object;
     string command;
     string argument;
 
+    m_selector.resize(0);
     m_arguments.resize(0);
     m_output.resize(0);
     bool isComment = false;
@@ -89,22 +99,34 @@ bool Command::parseCommand(const string& expression) {
     if (!argument.empty())
         m_arguments.push_back(argument);
 
+    if (ObjectSelector::isSelector(object) && !Terminal::ms_objectsTable.isToken(object)) {
+        // no single object id, so a selection is never coalesced with anything
+        m_selector = object;
+        m_idObject = size_t(-1);
+        return Terminal::ms_commandsTable.findId(m_idCommand, command);
+    }
     if (Terminal::ms_objectsTable.findId(m_idObject, object))
         return Terminal::ms_commandsTable.findId(m_idCommand, command);
     return false;
 }
 
 bool Command::run() {
+    if (!m_selector.empty())
+        return ObjectSelector::runCommand(m_selector, m_idCommand, m_arguments, m_output);
     CommandObject* object;
     if (Terminal::getObject(m_idObject, object))
         return object->runObjectCommand(m_idCommand, m_arguments, m_output);
-    cerr << "ObjectID " << m_idObject << " not found!" << endl;
+    LogError() << "ObjectID " << m_idObject << " not found!";
     return false;
 }
 
 ostream& operator<<(ostream& out, const Command& rhs) {
     //     out << rhs.m_idObject << " " << rhs.m_idCommand << " " << rhs.m_arguments;
-    out << Terminal::getObjectName(rhs.m_idObject) << " " << Terminal::findCommandName(rhs.m_idCommand);
+    if (rhs.isSelection())
+        out << rhs.m_selector;
+    else
+        out << Terminal::getObjectName(rhs.m_idObject);
+    out << " " << Terminal::findCommandName(rhs.m_idCommand);
     for (size_t i = 0; i < rhs.m_arguments.size(); ++i)
         out << " " << rhs.m_arguments[i];
     return out;
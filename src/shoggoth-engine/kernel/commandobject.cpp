@@ -26,9 +26,15 @@
 
 #include "shoggoth-engine/kernel/commandobject.hpp"
 
-#include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include "shoggoth-engine/common/clock.hpp"
 #include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/asyncjob.hpp"
+#include "shoggoth-engine/kernel/asyncqueue.hpp"
+#include "shoggoth-engine/kernel/commandprofiler.hpp"
+#include "shoggoth-engine/kernel/allocationcounter.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
@@ -36,11 +42,16 @@ const size_t MAX_EXPECTED_ID_DIGITS = 4;
 
 const string SET_COMMAND = "set";
 
+// arguments of an async command after this token form the command run once it completes
+const string COMPLETION_TOKEN = "=>";
+
 CommandObject::CommandObject(const string& objectName) :
     m_objectName(objectName),
     m_idObject(0),
     m_commands(),
-    m_attributes()
+    m_asyncCommands(),
+    m_attributes(),
+    m_coalescing()
 {
     m_idObject = Terminal::registerObject(m_objectName, this);
 }
@@ -60,18 +71,45 @@ bool CommandObject::operator>(const CommandObject& rhs) const {
 bool CommandObject::runObjectCommand(const size_t idCommand, deque<string>& arguments, string& output) {
     cmd_table_t::iterator it = m_commands.find(idCommand);
     if (it != m_commands.end()) {
-        output = (it->second)(arguments);
+        if (CommandProfiler::isEnabled()) {
+            // the command may delete this object, nothing of it is read after the call
+            const string objectName = m_objectName;
+            boost::uint64_t allocations = AllocationCounter::getTotalAllocations();
+            boost::uint64_t startTime = Clock::nanoseconds();
+            output = (it->second)(arguments);
+            CommandProfiler::record(objectName, Terminal::findCommandName(idCommand),
+                                    Clock::nanoseconds() - startTime,
+                                    AllocationCounter::getTotalAllocations() - allocations);
+        }
+        else
+            output = (it->second)(arguments);
+        return true;
+    }
+    async_cmd_table_t::iterator itAsync = m_asyncCommands.find(idCommand);
+    if (itAsync != m_asyncCommands.end()) {
+        output = runAsyncCommand(itAsync->second, arguments);
         return true;
     }
-    cerr << "Object \"" << m_objectName << "\" has no CommandID " << idCommand << endl;
+    LogError() << "Object \"" << m_objectName << "\" has no CommandID " << idCommand;
     return false;
 }
 
-size_t CommandObject::registerCommand(const string& cmd, const slot_t& slot) {
+size_t CommandObject::registerCommand(const string& cmd, const slot_t& slot, const coalesce_t coalescing) {
     size_t id = Terminal::ms_commandsTable.registerToken(cmd);
     cmd_table_t::iterator it = m_commands.find(id);
-    if (it == m_commands.end())
+    if (it == m_commands.end()) {
         m_commands.insert(pair<size_t, slot_t>(id, slot));
+        if (coalescing != COALESCE_NONE)
+            m_coalescing.insert(pair<size_t, coalesce_t>(id, coalescing));
+    }
+    return id;
+}
+
+size_t CommandObject::registerAsyncCommand(const string& cmd, const async_slot_t& slot) {
+    size_t id = Terminal::ms_commandsTable.registerToken(cmd);
+    async_cmd_table_t::iterator it = m_asyncCommands.find(id);
+    if (it == m_asyncCommands.end())
+        m_asyncCommands.insert(pair<size_t, async_slot_t>(id, slot));
     return id;
 }
 
@@ -80,14 +118,17 @@ size_t CommandObject::registerAttribute(const string& attrName, const slot_t& sl
     cmd_table_t::iterator it = m_attributes.find(id);
     if (it == m_attributes.end())
         m_attributes.insert(pair<size_t, slot_t>(id, slot));
-    registerCommand(SET_COMMAND, boost::bind(&CommandObject::cmdSetAttribute, this, _1));
+    registerCommand(SET_COMMAND, slot_t::fromMethod<CommandObject, &CommandObject::cmdSetAttribute>(this), COALESCE_LAST);
     return id;
 }
 
 void CommandObject::unregisterCommand(const std::string& cmd) {
     size_t id;
-    if (Terminal::ms_commandsTable.findId(id, cmd))
+    if (Terminal::ms_commandsTable.findId(id, cmd)) {
         m_commands.erase(id);
+        m_asyncCommands.erase(id);
+        m_coalescing.erase(id);
+    }
 }
 
 void CommandObject::unregisterAttribute(const std::string& attrName) {
@@ -98,12 +139,42 @@ void CommandObject::unregisterAttribute(const std::string& attrName) {
 
 void CommandObject::unregisterAllCommands() {
     m_commands.clear();
+    m_asyncCommands.clear();
+    m_coalescing.clear();
 }
 
 void CommandObject::unregisterAllAttributes() {
     m_attributes.clear();
 }
 
+string CommandObject::runAsyncCommand(async_slot_t& slot, deque<string>& arguments) {
+    string completionCommand;
+    deque<string>::iterator itToken = find(arguments.begin(), arguments.end(), COMPLETION_TOKEN);
+    if (itToken != arguments.end()) {
+        for (deque<string>::iterator it = itToken + 1; it != arguments.end(); ++it) {
+            if (!completionCommand.empty())
+                completionCommand.append(" ");
+            completionCommand.append(*it);
+        }
+        arguments.erase(itToken, arguments.end());
+    }
+
+    // the slot only validates its arguments and creates the job, or does the work
+    // right away when there is nothing slow to do (already loaded resources)
+    AsyncJob* job = 0;
+    string output = slot(arguments, job);
+    if (job != 0) {
+        job->setOwner(this);
+        job->setCompletionCommand(completionCommand);
+        string commitOutput = AsyncQueue::submit(job);
+        if (!commitOutput.empty())
+            output = commitOutput;
+    }
+    else if (!completionCommand.empty() && output.compare(0, 6, "Error:") != 0)
+        Terminal::pushCommand(completionCommand);
+    return output;
+}
+
 string CommandObject::cmdSetAttribute(deque<string>& args) {
     size_t id;
     if (args.size() == 0)
@@ -120,8 +191,11 @@ string CommandObject::cmdSetAttribute(deque<string>& args) {
 
 ostream& operator<<(ostream& out, const CommandObject& rhs) {
     out << setw(MAX_EXPECTED_ID_DIGITS) << rhs.m_idObject << " " << rhs.m_objectName << "   ";
-    std::map<size_t, boost::function<std::string (deque<string>&)> >::const_iterator it;
+    CommandObject::cmd_table_t::const_iterator it;
     for (it = rhs.m_commands.begin(); it != rhs.m_commands.end(); ++it)
         out << it->first << " ";
+    CommandObject::async_cmd_table_t::const_iterator itAsync;
+    for (itAsync = rhs.m_asyncCommands.begin(); itAsync != rhs.m_asyncCommands.end(); ++itAsync)
+        out << itAsync->first << " ";
     return out;
 }
@@ -0,0 +1,117 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/commandprofiler.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include "shoggoth-engine/kernel/allocationcounter.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+
+using namespace std;
+
+const size_t COMMAND_NAME_WIDTH = 32;
+
+bool CommandProfiler::ms_isEnabled = false;
+CommandProfiler::stats_table_t CommandProfiler::ms_stats = CommandProfiler::stats_table_t();
+
+void CommandProfiler::record(const string& objectName, const string& commandName, const boost::uint64_t nanoseconds, const boost::uint64_t allocations) {
+    pair<string, string> key(objectName, commandName);
+    stats_table_t::iterator it = ms_stats.find(key);
+    if (it == ms_stats.end()) {
+        command_stats_t stats = {objectName, commandName, 0, 0, 0, 0};
+        it = ms_stats.insert(pair<pair<string, string>, command_stats_t>(key, stats)).first;
+    }
+    command_stats_t& stats = it->second;
+    ++stats.calls;
+    stats.totalTime += nanoseconds;
+    stats.maxTime = max(stats.maxTime, nanoseconds);
+    stats.allocations += allocations;
+}
+
+void CommandProfiler::reset() {
+    ms_stats.clear();
+}
+
+string CommandProfiler::report(const size_t maxEntries) {
+    vector<const command_stats_t*> sorted;
+    sorted.reserve(ms_stats.size());
+    stats_table_t::const_iterator it;
+    for (it = ms_stats.begin(); it != ms_stats.end(); ++it)
+        sorted.push_back(&it->second);
+    sort(sorted.begin(), sorted.end(), isSlower);
+
+    stringstream ss;
+    ss << left << setw(int(COMMAND_NAME_WIDTH)) << "command" << right
+       << setw(10) << "calls"
+       << setw(12) << "total ms"
+       << setw(12) << "avg us"
+       << setw(12) << "max us"
+       << setw(12) << "allocs" << endl;
+    ss << fixed << setprecision(3);
+    for (size_t i = 0; i < sorted.size() && i < maxEntries; ++i) {
+        const command_stats_t& stats = *sorted[i];
+        ss << left << setw(int(COMMAND_NAME_WIDTH)) << (stats.objectName + " " + stats.commandName) << right
+           << setw(10) << stats.calls
+           << setw(12) << double(stats.totalTime) * 1.0e-6
+           << setw(12) << double(stats.totalTime) * 1.0e-3 / double(stats.calls)
+           << setw(12) << double(stats.maxTime) * 1.0e-3;
+        if (AllocationCounter::isCounting())
+            ss << setw(12) << stats.allocations << endl;
+        else
+            ss << setw(12) << "n/a" << endl;
+    }
+    return ss.str();
+}
+
+bool CommandProfiler::exportCsv(const string& fileName) {
+    ofstream file(fileName.c_str(), ios::out | ios::trunc);
+    if (!file.is_open() || !file.good()) {
+        LogError() << "Error: could not open file: " << fileName;
+        return false;
+    }
+    file << "object,command,calls,total_ns,max_ns,allocations" << endl;
+    stats_table_t::const_iterator it;
+    for (it = ms_stats.begin(); it != ms_stats.end(); ++it) {
+        const command_stats_t& stats = it->second;
+        file << stats.objectName << "," << stats.commandName << ","
+             << stats.calls << "," << stats.totalTime << "," << stats.maxTime << ",";
+        if (AllocationCounter::isCounting())
+            file << stats.allocations;
+        file << endl;
+    }
+    file.close();
+    return true;
+}
+
+
+
+bool CommandProfiler::isSlower(const command_stats_t* lhs, const command_stats_t* rhs) {
+    return lhs->totalTime > rhs->totalTime;
+}
@@ -0,0 +1,346 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/commandserver.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <deque>
+#include <cstdio>
+#include <cerrno>
+#include <sys/stat.h>
+#include <boost/asio.hpp>
+#include "shoggoth-engine/common/clock.hpp"
+#include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+
+using namespace std;
+using namespace boost::asio;
+
+typedef generic::stream_protocol protocol_t;
+typedef basic_socket_acceptor<protocol_t> acceptor_t;
+
+const string ENDPOINT_UNIX = "unix:";
+const string ENDPOINT_TCP = "tcp:";
+const int MAX_PENDING_CONNECTIONS = 16;
+const size_t RECEIVE_BUFFER_SIZE = 65536;
+
+
+// Client connection, all its socket operations are non-blocking
+class CommandConnection {
+public:
+    CommandConnection(io_context& ioContext):
+        m_socket(ioContext),
+        m_input(),
+        m_batch(),
+        m_batches(),
+        m_output(),
+        m_isClosed(false)
+    {}
+
+    protocol_t::socket& socket() {
+        return m_socket;
+    }
+
+    bool isFinished() const {
+        return m_isClosed && (m_output.empty() || !m_socket.is_open());
+    }
+
+    void receive(vector<char>& buffer, boost::uint64_t& bytesReceived) {
+        boost::system::error_code errorCode;
+        while (!m_isClosed) {
+            size_t bytes = m_socket.read_some(boost::asio::buffer(buffer), errorCode);
+            if (errorCode == error::would_block || errorCode == error::try_again)
+                break;
+            if (errorCode) {
+                m_isClosed = true;
+                break;
+            }
+            bytesReceived += bytes;
+            m_input.append(&buffer[0], bytes);
+        }
+        splitBatches();
+    }
+
+    bool popBatch(vector<string>& batch) {
+        if (m_batches.empty())
+            return false;
+        batch.swap(m_batches.front());
+        m_batches.pop_front();
+        return true;
+    }
+
+    void send(const string& data) {
+        m_output.append(data);
+    }
+
+    void flush(boost::uint64_t& bytesSent) {
+        boost::system::error_code errorCode;
+        while (!m_output.empty() && m_socket.is_open()) {
+            size_t bytes = m_socket.write_some(boost::asio::buffer(m_output), errorCode);
+            if (errorCode == error::would_block || errorCode == error::try_again)
+                break;
+            if (errorCode) {
+                m_isClosed = true;
+                m_socket.close(errorCode);
+                break;
+            }
+            bytesSent += bytes;
+            m_output.erase(0, bytes);
+        }
+    }
+
+private:
+    protocol_t::socket m_socket;
+    string m_input;
+    vector<string> m_batch;
+    deque<vector<string> > m_batches;
+    string m_output;
+    bool m_isClosed;
+
+    CommandConnection(const CommandConnection& rhs);
+    CommandConnection& operator=(const CommandConnection&);
+
+    void splitBatches() {
+        size_t start = 0;
+        size_t end;
+        while ((end = m_input.find('\n', start)) != string::npos) {
+            size_t length = end - start;
+            if (length > 0 && m_input[end - 1] == '\r')
+                --length;
+            if (length == 0) {
+                m_batches.push_back(vector<string>());
+                m_batches.back().swap(m_batch);
+            }
+            else
+                m_batch.push_back(m_input.substr(start, length));
+            start = end + 1;
+        }
+        m_input.erase(0, start);
+    }
+};
+
+
+// asio objects are kept out of the header
+io_context* g_ioContext = 0;
+acceptor_t* g_acceptor = 0;
+vector<CommandConnection*> g_connections;
+CommandConnection* g_nextConnection = 0;
+vector<char> g_receiveBuffer;
+string g_unixSocketPath;
+bool g_isUnixSocketCreated = false;
+
+string CommandServer::ms_endpoint = string();
+bool CommandServer::ms_isClosePending = false;
+boost::uint64_t CommandServer::ms_startTime = 0;
+boost::uint64_t CommandServer::ms_totalBatches = 0;
+boost::uint64_t CommandServer::ms_totalCommands = 0;
+boost::uint64_t CommandServer::ms_totalTime = 0;
+boost::uint64_t CommandServer::ms_bytesReceived = 0;
+boost::uint64_t CommandServer::ms_bytesSent = 0;
+
+bool CommandServer::listen(const string& endpoint) {
+    if (isListening()) {
+        LogError() << "Error: already listening on " << ms_endpoint;
+        return false;
+    }
+
+    protocol_t::endpoint address;
+    if (endpoint.compare(0, ENDPOINT_UNIX.size(), ENDPOINT_UNIX) == 0) {
+        string path = endpoint.substr(ENDPOINT_UNIX.size());
+        // a socket left behind by a previous run is replaced, anything else at the path is kept
+        struct stat status;
+        if (lstat(path.c_str(), &status) == 0) {
+            if (!S_ISSOCK(status.st_mode)) {
+                LogError() << "Error: not a socket, refusing to replace it: " << path;
+                return false;
+            }
+            remove(path.c_str());
+        }
+        else if (errno != ENOENT) {
+            LogError() << "Error: could not check socket path: " << path;
+            return false;
+        }
+        g_unixSocketPath = path;
+        address = local::stream_protocol::endpoint(g_unixSocketPath);
+    }
+    else if (endpoint.compare(0, ENDPOINT_TCP.size(), ENDPOINT_TCP) == 0) {
+        unsigned short port = 0;
+        istringstream ss(endpoint.substr(ENDPOINT_TCP.size()));
+        if (!(ss >> port)) {
+            LogError() << "Error: invalid port: " << endpoint;
+            return false;
+        }
+        address = ip::tcp::endpoint(ip::address_v4::loopback(), port);
+    }
+    else {
+        LogError() << "Error: unknown endpoint, expected unix:<path> or tcp:<port>: " << endpoint;
+        return false;
+    }
+
+    boost::system::error_code errorCode;
+    g_ioContext = new io_context;
+    g_acceptor = new acceptor_t(*g_ioContext);
+    g_acceptor->open(address.protocol(), errorCode);
+    if (!errorCode && g_unixSocketPath.empty())
+        g_acceptor->set_option(socket_base::reuse_address(true), errorCode);
+    if (!errorCode) {
+        g_acceptor->bind(address, errorCode);
+        g_isUnixSocketCreated = !errorCode && !g_unixSocketPath.empty();
+    }
+    if (!errorCode)
+        g_acceptor->listen(MAX_PENDING_CONNECTIONS, errorCode);
+    if (!errorCode)
+        g_acceptor->non_blocking(true, errorCode);
+    if (errorCode) {
+        LogError() << "Error: could not listen on " << endpoint << ": " << errorCode.message();
+        ms_endpoint = endpoint;
+        close();
+        return false;
+    }
+
+    g_receiveBuffer.resize(RECEIVE_BUFFER_SIZE);
+    ms_endpoint = endpoint;
+    ms_startTime = Clock::nanoseconds();
+    ms_totalBatches = 0;
+    ms_totalCommands = 0;
+    ms_totalTime = 0;
+    ms_bytesReceived = 0;
+    ms_bytesSent = 0;
+    LogInfo() << "Listening for commands on " << endpoint;
+    return true;
+}
+
+void CommandServer::close() {
+    if (!isListening())
+        return;
+    for (size_t i = 0; i < g_connections.size(); ++i)
+        delete g_connections[i];
+    g_connections.clear();
+    delete g_nextConnection;
+    g_nextConnection = 0;
+    delete g_acceptor;
+    delete g_ioContext;
+    g_acceptor = 0;
+    g_ioContext = 0;
+    if (g_isUnixSocketCreated)
+        remove(g_unixSocketPath.c_str());
+    g_isUnixSocketCreated = false;
+    g_unixSocketPath.clear();
+    ms_endpoint.clear();
+    ms_isClosePending = false;
+}
+
+// commands can't close the server right away, a client batch may be the one asking
+// while poll() still uses its connection
+void CommandServer::requestClose() {
+    if (isListening())
+        ms_isClosePending = true;
+}
+
+void CommandServer::poll() {
+    if (g_acceptor == 0)
+        return;
+    acceptConnections();
+
+    vector<string> batch;
+    for (size_t i = 0; i < g_connections.size(); ++i) {
+        CommandConnection* connection = g_connections[i];
+        connection->receive(g_receiveBuffer, ms_bytesReceived);
+        while (connection->popBatch(batch))
+            connection->send(runBatch(batch));
+        connection->flush(ms_bytesSent);
+    }
+    if (ms_isClosePending) {
+        close();
+        return;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < g_connections.size(); ++i) {
+        if (g_connections[i]->isFinished())
+            delete g_connections[i];
+        else
+            g_connections[n++] = g_connections[i];
+    }
+    g_connections.resize(n);
+}
+
+string CommandServer::statsToString() {
+    if (!isListening())
+        return "Not listening";
+    double totalTime = double(ms_totalTime) * 1.0e-9;
+    double elapsedTime = double(Clock::nanoseconds() - ms_startTime) * 1.0e-9;
+    stringstream ss;
+    ss << "Listening on " << ms_endpoint << ", " << g_connections.size() << " connections" << endl;
+    ss << fixed << setprecision(1);
+    ss << "  batches:     " << ms_totalBatches << endl;
+    ss << "  commands:    " << ms_totalCommands << endl;
+    ss << "  running:     " << totalTime * 1000.0 << " ms, "
+       << (totalTime > 0.0? double(ms_totalCommands) / totalTime : 0.0) << " commands/s" << endl;
+    ss << "  overall:     " << double(ms_totalCommands) / elapsedTime << " commands/s" << endl;
+    ss << "  received:    " << ms_bytesReceived << " bytes" << endl;
+    ss << "  sent:        " << ms_bytesSent << " bytes";
+    return ss.str();
+}
+
+
+
+void CommandServer::acceptConnections() {
+    // the connection waiting to be accepted is kept, polling doesn't allocate every frame
+    boost::system::error_code errorCode;
+    while (true) {
+        if (g_nextConnection == 0)
+            g_nextConnection = new CommandConnection(*g_ioContext);
+        g_acceptor->accept(g_nextConnection->socket(), errorCode);
+        if (errorCode == error::would_block || errorCode == error::try_again)
+            return;
+        if (!errorCode)
+            g_nextConnection->socket().non_blocking(true, errorCode);
+        if (errorCode) {
+            LogError() << "Error: could not accept connection: " << errorCode.message();
+            g_nextConnection->socket().close(errorCode);
+            return;
+        }
+        g_connections.push_back(g_nextConnection);
+        g_nextConnection = 0;
+    }
+}
+
+string CommandServer::runBatch(const vector<string>& lines) {
+    size_t totalCommands;
+    boost::uint64_t startTime = Clock::nanoseconds();
+    string output = Terminal::runBatch(lines, totalCommands);
+    boost::uint64_t time = Clock::nanoseconds() - startTime;
+
+    ++ms_totalBatches;
+    ms_totalCommands += totalCommands;
+    ms_totalTime += time;
+
+    stringstream header;
+    header << "batch " << totalCommands << " " << output.size() << " " << time / 1000 << "\n";
+    return header.str() + output;
+}
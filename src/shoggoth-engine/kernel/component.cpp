@@ -29,6 +29,7 @@
 #include <iostream>
 #include <ostream>
 #include "shoggoth-engine/kernel/entity.hpp"
+#include "shoggoth-engine/kernel/objectselector.hpp"
 
 using namespace std;
 
@@ -38,10 +39,12 @@ Component::Component(const string& type, Entity* const _entity):
     m_description()
 {
     m_entity->m_components.insert(pair<string, Component*>(m_type, this));
+    ObjectSelector::invalidate();
 }
 
 Component::~Component() {
     m_entity->m_components.erase(m_type);
+    ObjectSelector::invalidate();
 }
 
 Component::Component(const Component& rhs):
@@ -25,8 +25,15 @@
 
 
 #include "shoggoth-engine/kernel/device.hpp"
-
-#include <iostream>
+#include "shoggoth-engine/kernel/inputlatency.hpp"
+#include "shoggoth-engine/kernel/frametimer.hpp"
+#include "shoggoth-engine/kernel/framearena.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
+#include "shoggoth-engine/common/clock.hpp"
+#include "shoggoth-engine/kernel/startuptimer.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+
+#include <algorithm>
 #include <sstream>
 #include <cstdlib>
 #include <ctime>
@@ -44,8 +51,16 @@ const Uint32 SDL_VIDEO_FLAGS = SDL_HWSURFACE | SDL_ANYFORMAT | SDL_OPENGL | SDL_
 Inputs Device::ms_inputs = Inputs();
 SDL_Surface* Device::ms_screen = 0;
 
-Device::Device(const string& objectName):
+// the logger writes from its own thread, messages still in its ring would be lost on exit
+void exitWithError(const char* message) {
+    LogError() << message << ": " << SDL_GetError();
+    Logger::shutdown();
+    exit(EXIT_FAILURE);
+}
+
+Device::Device(const string& objectName, const bool isHeadless):
     CommandObject(objectName),
+    m_isHeadless(isHeadless),
     m_width(DEFAULT_SCREEN_WIDTH),
     m_height(DEFAULT_SCREEN_HEIGHT),
     m_halfWidth(m_width / 2),
@@ -53,18 +68,32 @@ Device::Device(const string& objectName):
     m_depth(DEFAULT_SCREEN_DEPTH),
     m_keysPressed(),
     m_mouseButtonsPressed(),
-    m_startTime(0.0),
+    m_inputBuffer(),
+    m_frameFirstEvent(0),
+    m_isMouseWarped(false),
+    m_syntheticEvents(),
+    m_startTime(0),
     m_deltaTime(0.0),
+    m_fixedDeltaTime(0.0),
     m_fps(0.0)
 {
-    registerCommand("swap-buffers", boost::bind(&Device::cmdSwapBuffers, this, _1));
-    registerAttribute("title", boost::bind(&Device::cmdTitle, this, _1));
-    registerAttribute("fullscreen", boost::bind(&Device::cmdFullscreen, this, _1));
-    registerAttribute("resolution", boost::bind(&Device::cmdResolution, this, _1));
+    StartupPhase phase("Device");
+    registerCommand("swap-buffers", slot_t::fromMethod<Device, &Device::cmdSwapBuffers>(this));
+    registerAttribute("title", slot_t::fromMethod<Device, &Device::cmdTitle>(this));
+    registerAttribute("fullscreen", slot_t::fromMethod<Device, &Device::cmdFullscreen>(this));
+    registerAttribute("resolution", slot_t::fromMethod<Device, &Device::cmdResolution>(this));
+
+    // a headless device opens no window, it runs servers and benchmarks on machines without a display
+    if (m_isHeadless) {
+        LogInfo() << "Creating headless device";
+        if (SDL_Init(SDL_INIT_TIMER) != 0)
+            exitWithError("Could not initialize SDL");
+        return;
+    }
 
-    cout << "Creating SDL-OpenGL device" << endl;
+    LogInfo() << "Creating SDL-OpenGL device";
     if (SDL_Init(SDL_INIT_FLAGS) != 0) // 0 success, -1 failure
-        exit(EXIT_FAILURE);
+        exitWithError("Could not initialize SDL");
 
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, true);
 
@@ -93,13 +122,13 @@ Device::Device(const string& objectName):
 
     ms_screen = SDL_SetVideoMode(m_width, m_height, m_depth, SDL_VIDEO_FLAGS);
     if (ms_screen == 0)
-        exit(EXIT_FAILURE);
+        exitWithError("Could not set the video mode");
 
     SDL_ShowCursor(SDL_FALSE);
 }
 
 Device::~Device() {
-    cout << "SDL-OpenGL device quit" << endl;
+    LogInfo() << (m_isHeadless? "Headless device quit" : "SDL-OpenGL device quit");
     SDL_Quit();
 
     unregisterAllCommands();
@@ -107,28 +136,42 @@ Device::~Device() {
 }
 
 void Device::onFrameStart() {
-    m_startTime = SDL_GetTicks() * 0.001;
+    m_startTime = Clock::nanoseconds();
 }
 
 void Device::onFrameEnd() {
-    m_deltaTime = SDL_GetTicks() * 0.001 - m_startTime;
-    m_fps = 1.0 / m_deltaTime;
+    boost::uint64_t frameNanoseconds = Clock::nanoseconds() - m_startTime;
+    FrameTimer::endFrame(frameNanoseconds);
+    FrameArena::reset();
+    // averaged over the recent frames, a single frame says little
+    m_fps = 1.0e9 / FrameTimer::getMeanFrameTime();
+    double frameTime = double(frameNanoseconds) * 1.0e-9;
+    // a fixed delta time makes commands independent of the framerate (replays)
+    m_deltaTime = m_fixedDeltaTime > 0.0? m_fixedDeltaTime : frameTime;
 }
 
 void Device::swapBuffers() const {
-    SDL_GL_SwapBuffers();
+    if (!m_isHeadless)
+        SDL_GL_SwapBuffers();
+    InputLatency::onSwap();
 }
 
 size_t Device::videoMemKB() {
+    if (m_isHeadless)
+        return 0;
     const SDL_VideoInfo* info = SDL_GetVideoInfo();
     return info->video_mem;
 }
 
 void Device::setTitle(const string& title) {
+    if (m_isHeadless)
+        return;
     SDL_WM_SetCaption(title.c_str(), title.c_str());
 }
 
 void Device::setFullscreen(const bool useFullscreen) {
+    if (m_isHeadless)
+        return;
     ms_screen = SDL_GetVideoSurface();
     Uint32 flags = ms_screen->flags;
     Uint32 fullscreenBit = useFullscreen? SDL_FULLSCREEN : 0;
@@ -140,68 +183,171 @@ void Device::setFullscreen(const bool useFullscreen) {
 }
 
 void Device::setResolution(const size_t width, const size_t height) {
-    Uint32 flags = SDL_GetVideoSurface()->flags;
-    ms_screen = SDL_SetVideoMode(width, height, 0, flags);
-    m_width = static_cast<size_t>(ms_screen->w);
+    if (m_isHeadless) {
+        m_width = width;
+        m_height = height;
+    }
+    else {
+        Uint32 flags = SDL_GetVideoSurface()->flags;
+        ms_screen = SDL_SetVideoMode(width, height, 0, flags);
+        m_width = static_cast<size_t>(ms_screen->w);
+        m_height = static_cast<size_t>(ms_screen->h);
+    }
     m_halfWidth = m_width / 2;
-    m_height = static_cast<size_t>(ms_screen->h);
     m_halfHeight = m_height / 2;
 }
 
 size_t Device::getWinWidth() const {
-    return ms_screen->w;
+    return m_isHeadless? m_width : size_t(ms_screen->w);
 }
 
 size_t Device::getWinHeight() const {
-    return ms_screen->h;
+    return m_isHeadless? m_height : size_t(ms_screen->h);
 }
 
-void Device::processEvents(bool& isRunning) {
+void Device::pushInputEvent(const input_event_t& input) {
+    m_syntheticEvents.push_back(input);
+}
+
+void Device::pollEvents(bool& isRunning) {
+    m_frameFirstEvent = m_inputBuffer.getTotalEvents();
+
+    // synthetic events go first, an event without time is stamped now
+    for (size_t i = 0; i < m_syntheticEvents.size(); ++i) {
+        input_event_t input = m_syntheticEvents[i];
+        if (input.time == 0)
+            input.time = Clock::nanoseconds();
+        bufferEvent(input);
+    }
+    m_syntheticEvents.clear();
+    if (m_isHeadless)
+        return;
+
+    bool hasMouseMoved = false;
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
+        input_event_t input = {INPUT_KEY_PRESS, Clock::nanoseconds(), 0, {0, 0, 0, 0}};
         switch (event.type) {
         case SDL_QUIT:
             isRunning = false;
-            break;
+            continue;
         case SDL_KEYDOWN:
-            ms_inputs.onKeyPress(event.key.keysym.sym);
-            m_keysPressed.insert(event.key.keysym.sym);
+            input.type = INPUT_KEY_PRESS;
+            input.code = event.key.keysym.sym;
             break;
         case SDL_KEYUP:
-            ms_inputs.onKeyRelease(event.key.keysym.sym);
-            m_keysPressed.erase(event.key.keysym.sym);
+            input.type = INPUT_KEY_RELEASE;
+            input.code = event.key.keysym.sym;
             break;
         case SDL_MOUSEBUTTONDOWN:
-            ms_inputs.onMouseButtonPress(event.button.button);
-            m_mouseButtonsPressed.insert(event.button.button);
+            input.type = INPUT_MOUSE_BUTTON_PRESS;
+            input.code = event.button.button;
             break;
         case SDL_MOUSEBUTTONUP:
-            ms_inputs.onMouseButtonRelease(event.button.button);
-            m_mouseButtonsPressed.erase(event.button.button);
+            input.type = INPUT_MOUSE_BUTTON_RELEASE;
+            input.code = event.button.button;
+            break;
+        case SDL_MOUSEMOTION:
+            // warping the cursor back to the center reports itself as one more motion
+            if (m_isMouseWarped && size_t(event.motion.x) == m_halfWidth && size_t(event.motion.y) == m_halfHeight) {
+                m_isMouseWarped = false;
+                continue;
+            }
+            hasMouseMoved = true;
+            input.type = INPUT_MOUSE_MOTION;
+            input.motion.x = event.motion.x;
+            input.motion.y = event.motion.y;
+            input.motion.xrel = event.motion.xrel;
+            input.motion.yrel = event.motion.yrel;
             break;
-        case SDL_MOUSEMOTION: {
-            mouse_motion_t motion;
-            motion.x = event.motion.x;
-            motion.y = event.motion.y;
-            motion.xrel = event.motion.xrel;
-            motion.yrel = event.motion.yrel;
-            ms_inputs.onMouseMotion(motion);
-            SDL_WarpMouse(Uint16(m_halfWidth), Uint16(m_halfHeight));
-            break; }
         default:
             // ignore other events
+            continue;
+        }
+        bufferEvent(input);
+    }
+    // warp once per frame instead of once per motion event
+    if (hasMouseMoved) {
+        SDL_WarpMouse(Uint16(m_halfWidth), Uint16(m_halfHeight));
+        m_isMouseWarped = true;
+    }
+}
+
+void Device::processEvents(bool& isRunning) {
+    TraceScope trace("Device::processEvents");
+    // held inputs are sampled when polling
+    FrameTimer::beginPhase(FRAME_PHASE_EVENTS);
+    boost::uint64_t pollTime = Clock::nanoseconds();
+    pollEvents(isRunning);
+
+    // more events than the buffer holds in a single frame lose the oldest ones
+    boost::uint64_t sequence = max(m_frameFirstEvent, m_inputBuffer.getOldestSequence());
+    mouse_motion_t frameMotion = {0, 0, 0, 0};
+    boost::uint64_t motionTime = 0;
+    bool hasMouseMoved = false;
+    for (; sequence < m_inputBuffer.getTotalEvents(); ++sequence) {
+        const input_event_t& input = *m_inputBuffer.getEvent(sequence);
+        switch (input.type) {
+        case INPUT_KEY_PRESS:
+            ms_inputs.onKeyPress(input.code, input.time);
+            m_keysPressed.insert(input.code);
+            break;
+        case INPUT_KEY_RELEASE:
+            ms_inputs.onKeyRelease(input.code, input.time);
+            m_keysPressed.erase(input.code);
+            break;
+        case INPUT_MOUSE_BUTTON_PRESS:
+            ms_inputs.onMouseButtonPress(input.code, input.time);
+            m_mouseButtonsPressed.insert(input.code);
+            break;
+        case INPUT_MOUSE_BUTTON_RELEASE:
+            ms_inputs.onMouseButtonRelease(input.code, input.time);
+            m_mouseButtonsPressed.erase(input.code);
+            break;
+        case INPUT_MOUSE_MOTION:
+            frameMotion.x = input.motion.x;
+            frameMotion.y = input.motion.y;
+            frameMotion.xrel += input.motion.xrel;
+            frameMotion.yrel += input.motion.yrel;
+            if (!hasMouseMoved)
+                motionTime = input.time;
+            hasMouseMoved = true;
+            break;
+        case INPUT_KEY_PRESSED:
+        case INPUT_MOUSE_BUTTON_PRESSED:
+        default:
+            // held inputs are not events, they are generated below
             break;
         }
     }
+    // a single motion per frame, no matter how many events the mouse generated
+    if (hasMouseMoved)
+        ms_inputs.onMouseMotion(frameMotion, motionTime);
+
     set<size_t>::iterator it;
     for (it = m_keysPressed.begin(); it != m_keysPressed.end(); ++it)
-        ms_inputs.onKeyPressed(*it);
+        ms_inputs.onKeyPressed(*it, pollTime);
     for (it = m_mouseButtonsPressed.begin(); it != m_mouseButtonsPressed.end(); ++it)
-        ms_inputs.onMouseButtonPressed(*it);
+        ms_inputs.onMouseButtonPressed(*it, pollTime);
+    FrameTimer::endPhase(FRAME_PHASE_EVENTS);
 }
 
 
 
+void Device::bufferEvent(const input_event_t& input) {
+    // consecutive motion this frame is merged, keeping the time of the first one
+    input_event_t* last = m_inputBuffer.getNewestEvent();
+    if (input.type == INPUT_MOUSE_MOTION && last != 0 && last->type == INPUT_MOUSE_MOTION
+            && m_inputBuffer.getTotalEvents() > m_frameFirstEvent) {
+        last->motion.x = input.motion.x;
+        last->motion.y = input.motion.y;
+        last->motion.xrel += input.motion.xrel;
+        last->motion.yrel += input.motion.yrel;
+        return;
+    }
+    m_inputBuffer.push(input);
+}
+
 string Device::cmdFullscreen(deque<string>& args) {
     if (args.size() < 1)
         return "Error: too few arguments";
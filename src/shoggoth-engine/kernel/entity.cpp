@@ -32,11 +32,15 @@
 #include "shoggoth-engine/kernel/device.hpp"
 #include "shoggoth-engine/kernel/scene.hpp"
 #include "shoggoth-engine/physics/rigidbody.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
 const size_t INDENT_SIZE = 2;
 
+size_t Entity::ms_simulationStep = 0;
+bool Entity::ms_isSimulationStep = false;
+
 Entity::Entity(Entity* _parent, const string& objectName, const Device* device):
     CommandObject(objectName),
     m_parent(_parent),
@@ -47,38 +51,41 @@ Entity::Entity(Entity* _parent, const string& objectName, const Device* device):
     m_positionRel(VECTOR3_ZERO),
     m_orientationAbs(QUATERNION_IDENTITY),
     m_orientationRel(QUATERNION_IDENTITY),
-    m_lastOrientation(QUATERNION_IDENTITY)
+    m_lastOrientation(QUATERNION_IDENTITY),
+    m_previousPositionAbs(VECTOR3_ZERO),
+    m_previousOrientationAbs(QUATERNION_IDENTITY),
+    m_previousStep(TRANSFORM_NOT_INTERPOLATED)
 {
     if (m_parent != 0) {
         setPositionRel(VECTOR3_ZERO);
         setOrientationRel(QUATERNION_IDENTITY);
     }
-    registerAttribute("position-abs", boost::bind(&Entity::cmdPositionAbs, this, _1));
-    registerAttribute("position-rel", boost::bind(&Entity::cmdPositionRel, this, _1));
-    registerAttribute("orientation-abs-ypr", boost::bind(&Entity::cmdOrientationAbsYPR, this, _1));
-    registerAttribute("orientation-rel-ypr", boost::bind(&Entity::cmdOrientationRelYPR, this, _1));
-    registerCommand("move-xyz", boost::bind(&Entity::cmdMoveXYZ, this, _1));
-    registerCommand("move-x", boost::bind(&Entity::cmdMoveX, this, _1));
-    registerCommand("move-y", boost::bind(&Entity::cmdMoveY, this, _1));
-    registerCommand("move-z", boost::bind(&Entity::cmdMoveZ, this, _1));
-    registerCommand("move-xyz-parent", boost::bind(&Entity::cmdMoveXYZ_parent, this, _1));
-    registerCommand("move-x-parent", boost::bind(&Entity::cmdMoveX_parent, this, _1));
-    registerCommand("move-y-parent", boost::bind(&Entity::cmdMoveY_parent, this, _1));
-    registerCommand("move-z-parent", boost::bind(&Entity::cmdMoveZ_parent, this, _1));
-    registerCommand("move-xyz-global", boost::bind(&Entity::cmdMoveXYZ_global, this, _1));
-    registerCommand("move-x-global", boost::bind(&Entity::cmdMoveX_global, this, _1));
-    registerCommand("move-y-global", boost::bind(&Entity::cmdMoveY_global, this, _1));
-    registerCommand("move-z-global", boost::bind(&Entity::cmdMoveZ_global, this, _1));
-    registerCommand("yaw", boost::bind(&Entity::cmdYaw, this, _1));
-    registerCommand("pitch", boost::bind(&Entity::cmdPitch, this, _1));
-    registerCommand("roll", boost::bind(&Entity::cmdRoll, this, _1));
-    registerCommand("yaw-parent", boost::bind(&Entity::cmdYaw_parent, this, _1));
-    registerCommand("pitch-parent", boost::bind(&Entity::cmdPitch_parent, this, _1));
-    registerCommand("roll-parent", boost::bind(&Entity::cmdRoll_parent, this, _1));
-    registerCommand("yaw-global", boost::bind(&Entity::cmdYaw_global, this, _1));
-    registerCommand("pitch-global", boost::bind(&Entity::cmdPitch_global, this, _1));
-    registerCommand("roll-global", boost::bind(&Entity::cmdRoll_global, this, _1));
-    registerCommand("remove-all-children", boost::bind(&Entity::cmdRemoveAllChildren, this, _1));
+    registerAttribute("position-abs", slot_t::fromMethod<Entity, &Entity::cmdPositionAbs>(this));
+    registerAttribute("position-rel", slot_t::fromMethod<Entity, &Entity::cmdPositionRel>(this));
+    registerAttribute("orientation-abs-ypr", slot_t::fromMethod<Entity, &Entity::cmdOrientationAbsYPR>(this));
+    registerAttribute("orientation-rel-ypr", slot_t::fromMethod<Entity, &Entity::cmdOrientationRelYPR>(this));
+    registerCommand("move-xyz", slot_t::fromMethod<Entity, &Entity::cmdMoveXYZ>(this), COALESCE_SUM);
+    registerCommand("move-x", slot_t::fromMethod<Entity, &Entity::cmdMoveX>(this), COALESCE_SUM);
+    registerCommand("move-y", slot_t::fromMethod<Entity, &Entity::cmdMoveY>(this), COALESCE_SUM);
+    registerCommand("move-z", slot_t::fromMethod<Entity, &Entity::cmdMoveZ>(this), COALESCE_SUM);
+    registerCommand("move-xyz-parent", slot_t::fromMethod<Entity, &Entity::cmdMoveXYZ_parent>(this), COALESCE_SUM);
+    registerCommand("move-x-parent", slot_t::fromMethod<Entity, &Entity::cmdMoveX_parent>(this), COALESCE_SUM);
+    registerCommand("move-y-parent", slot_t::fromMethod<Entity, &Entity::cmdMoveY_parent>(this), COALESCE_SUM);
+    registerCommand("move-z-parent", slot_t::fromMethod<Entity, &Entity::cmdMoveZ_parent>(this), COALESCE_SUM);
+    registerCommand("move-xyz-global", slot_t::fromMethod<Entity, &Entity::cmdMoveXYZ_global>(this), COALESCE_SUM);
+    registerCommand("move-x-global", slot_t::fromMethod<Entity, &Entity::cmdMoveX_global>(this), COALESCE_SUM);
+    registerCommand("move-y-global", slot_t::fromMethod<Entity, &Entity::cmdMoveY_global>(this), COALESCE_SUM);
+    registerCommand("move-z-global", slot_t::fromMethod<Entity, &Entity::cmdMoveZ_global>(this), COALESCE_SUM);
+    registerCommand("yaw", slot_t::fromMethod<Entity, &Entity::cmdYaw>(this), COALESCE_SUM);
+    registerCommand("pitch", slot_t::fromMethod<Entity, &Entity::cmdPitch>(this), COALESCE_SUM);
+    registerCommand("roll", slot_t::fromMethod<Entity, &Entity::cmdRoll>(this), COALESCE_SUM);
+    registerCommand("yaw-parent", slot_t::fromMethod<Entity, &Entity::cmdYaw_parent>(this), COALESCE_SUM);
+    registerCommand("pitch-parent", slot_t::fromMethod<Entity, &Entity::cmdPitch_parent>(this), COALESCE_SUM);
+    registerCommand("roll-parent", slot_t::fromMethod<Entity, &Entity::cmdRoll_parent>(this), COALESCE_SUM);
+    registerCommand("yaw-global", slot_t::fromMethod<Entity, &Entity::cmdYaw_global>(this), COALESCE_SUM);
+    registerCommand("pitch-global", slot_t::fromMethod<Entity, &Entity::cmdPitch_global>(this), COALESCE_SUM);
+    registerCommand("roll-global", slot_t::fromMethod<Entity, &Entity::cmdRoll_global>(this), COALESCE_SUM);
+    registerCommand("remove-all-children", slot_t::fromMethod<Entity, &Entity::cmdRemoveAllChildren>(this));
 }
 
 Entity::~Entity() {
@@ -100,7 +107,7 @@ void Entity::translate(const Vector3& displacement, const transform_space_t& rel
         setPositionAbs(m_positionAbs + displacement);
         break;
     default:
-        cerr << "Invalid transform_space_t: " << relativeTo << endl;
+        LogError() << "Invalid transform_space_t: " << relativeTo;
     }
 }
 
@@ -116,7 +123,7 @@ void Entity::rotate(const Quaternion& deltaRotation, const transform_space_t& re
         setOrientationAbs(deltaRotation * m_orientationAbs);
         break;
     default:
-        cerr << "Invalid transform_space_t: " << relativeTo << endl;
+        LogError() << "Invalid transform_space_t: " << relativeTo;
     }
 }
 
@@ -189,7 +196,10 @@ Entity::Entity(const Entity& rhs):
     m_positionRel(rhs.m_positionRel),
     m_orientationAbs(rhs.m_orientationAbs),
     m_orientationRel(rhs.m_orientationRel),
-    m_lastOrientation(rhs.m_lastOrientation)
+    m_lastOrientation(rhs.m_lastOrientation),
+    m_previousPositionAbs(rhs.m_previousPositionAbs),
+    m_previousOrientationAbs(rhs.m_previousOrientationAbs),
+    m_previousStep(rhs.m_previousStep)
 {
     cerr << "Error: Entity copy constructor should not be called!" << endl;
 }
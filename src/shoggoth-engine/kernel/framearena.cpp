@@ -0,0 +1,99 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/framearena.hpp"
+
+#include <sstream>
+#include <algorithm>
+#include "shoggoth-engine/kernel/allocationcounter.hpp"
+
+using namespace std;
+
+char* FrameArena::ms_block = 0;
+size_t FrameArena::ms_capacity = 0;
+size_t FrameArena::ms_offset = 0;
+size_t FrameArena::ms_frameBytes = 0;
+size_t FrameArena::ms_highWaterBytes = 0;
+vector<char*> FrameArena::ms_overflowBlocks = vector<char*>();
+boost::uint64_t FrameArena::ms_lastAllocations = 0;
+boost::uint64_t FrameArena::ms_frameAllocations = 0;
+
+
+void* FrameArena::allocate(const size_t bytes, const size_t alignment) {
+    if (ms_block == 0) {
+        ms_capacity = DEFAULT_FRAME_ARENA_BYTES;
+        ms_block = new char[ms_capacity];
+    }
+
+    // the frame total counts the worst padding, so the grown block always fits the frame
+    ms_frameBytes += bytes + alignment - 1;
+    size_t address = size_t(ms_block) + ms_offset;
+    size_t padding = (alignment - address % alignment) % alignment;
+    if (ms_offset + padding + bytes <= ms_capacity) {
+        ms_offset += padding + bytes;
+        return ms_block + ms_offset - bytes;
+    }
+
+    // overflow, served from the heap until the next reset grows the block
+    char* overflow = new char[bytes + alignment - 1];
+    ms_overflowBlocks.push_back(overflow);
+    address = size_t(overflow);
+    padding = (alignment - address % alignment) % alignment;
+    return overflow + padding;
+}
+
+void FrameArena::reset() {
+    ms_highWaterBytes = max(ms_highWaterBytes, ms_frameBytes);
+    if (!ms_overflowBlocks.empty()) {
+        for (size_t i = 0; i < ms_overflowBlocks.size(); ++i)
+            delete[] ms_overflowBlocks[i];
+        ms_overflowBlocks.clear();
+
+        // room for this frame and some more, so a slowly growing frame does not grow it every time
+        while (ms_capacity < ms_frameBytes)
+            ms_capacity *= 2;
+        ms_capacity *= 2;
+        delete[] ms_block;
+        ms_block = new char[ms_capacity];
+    }
+    ms_offset = 0;
+    ms_frameBytes = 0;
+
+    boost::uint64_t allocations = AllocationCounter::getTotalAllocations();
+    ms_frameAllocations = allocations - ms_lastAllocations;
+    ms_lastAllocations = allocations;
+}
+
+string FrameArena::report() {
+    stringstream ss;
+    ss << "Frame arena: " << ms_capacity / 1024 << " KB, "
+       << ms_highWaterBytes / 1024 << " KB used at most in a frame" << endl;
+    if (AllocationCounter::isCounting())
+        ss << "  heap allocations last frame: " << ms_frameAllocations << endl;
+    else
+        ss << "  heap allocations are not counted in this build" << endl;
+    return ss.str();
+}
@@ -0,0 +1,155 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/framepacer.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <boost/thread/thread.hpp>
+#include <boost/chrono/chrono.hpp>
+#include "shoggoth-engine/common/clock.hpp"
+
+using namespace std;
+
+FramePacer::FramePacer(const string& objectName):
+    CommandObject(objectName),
+    m_period(0),
+    m_spinTime(DEFAULT_SPIN_TIME),
+    m_deadline(0),
+    m_lastFrameEnd(0),
+    m_totalFrames(0),
+    m_lateFrames(0),
+    m_totalSpinTime(0),
+    m_errors()
+{
+    registerCommand("stats", slot_t::fromMethod<FramePacer, &FramePacer::cmdStats>(this));
+    registerCommand("stats-reset", slot_t::fromMethod<FramePacer, &FramePacer::cmdStatsReset>(this));
+    registerAttribute("target-fps", slot_t::fromMethod<FramePacer, &FramePacer::cmdTargetFps>(this));
+    registerAttribute("spin-time", slot_t::fromMethod<FramePacer, &FramePacer::cmdSpinTime>(this));
+
+    setTargetFps(DEFAULT_TARGET_FPS);
+}
+
+FramePacer::~FramePacer() {
+    unregisterAllCommands();
+    unregisterAllAttributes();
+}
+
+void FramePacer::setTargetFps(const double targetFps) {
+    if (targetFps > 0.0 && (targetFps < MIN_TARGET_FPS || targetFps > MAX_TARGET_FPS))
+        return;
+    m_period = targetFps > 0.0? boost::uint64_t(1.0e9 / targetFps) : 0;
+    m_lastFrameEnd = 0;
+}
+
+void FramePacer::reset() {
+    m_deadline = 0;
+    m_lastFrameEnd = 0;
+    m_totalFrames = 0;
+    m_lateFrames = 0;
+    m_totalSpinTime = 0;
+    m_errors.reset();
+}
+
+void FramePacer::wait() {
+    if (m_period == 0)
+        return;
+
+    boost::uint64_t now = Clock::nanoseconds();
+    if (m_lastFrameEnd != 0 && now < m_deadline) {
+        if (m_deadline - now > m_spinTime)
+            boost::this_thread::sleep_for(boost::chrono::nanoseconds(m_deadline - now - m_spinTime));
+        boost::uint64_t spinStart = Clock::nanoseconds();
+        while (Clock::nanoseconds() < m_deadline)
+            boost::this_thread::yield();
+        m_totalSpinTime += Clock::nanoseconds() - spinStart;
+    }
+
+    boost::uint64_t frameEnd = Clock::nanoseconds();
+    if (m_lastFrameEnd != 0) {
+        boost::uint64_t period = frameEnd - m_lastFrameEnd;
+        m_errors.record(period > m_period? period - m_period : m_period - period);
+        ++m_totalFrames;
+        // a frame that missed its deadline by more than the spin time is late, a short frame
+        // to catch up would only be another stutter
+        if (frameEnd > m_deadline + m_spinTime) {
+            ++m_lateFrames;
+            m_deadline = frameEnd;
+        }
+    }
+    else
+        m_deadline = frameEnd;
+    m_deadline += m_period;
+    m_lastFrameEnd = frameEnd;
+}
+
+string FramePacer::report() const {
+    stringstream ss;
+    ss << fixed << setprecision(1);
+    ss << "Frame pacing at " << getTargetFps() << " fps, " << m_totalFrames << " frames, "
+       << m_lateFrames << " late" << endl;
+    if (m_totalFrames > 0) {
+        ss << "  period error:  p50 " << double(m_errors.getPercentile(50.0)) * 1.0e-3
+           << " us, p99 " << double(m_errors.getPercentile(99.0)) * 1.0e-3
+           << " us, max " << double(m_errors.getMax()) * 1.0e-3 << " us" << endl;
+        ss << "  spinning:      " << double(m_totalSpinTime) * 1.0e-3 / double(m_totalFrames)
+           << " us per frame" << endl;
+    }
+    return ss.str();
+}
+
+
+
+string FramePacer::cmdTargetFps(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    double targetFps = boost::lexical_cast<double>(args[0]);
+    if (targetFps < 0.0)
+        return "Error: target fps can not be negative";
+    if (targetFps > 0.0 && targetFps < MIN_TARGET_FPS)
+        return "Error: target fps too low, the frame period would be over 1000 s";
+    if (targetFps > MAX_TARGET_FPS)
+        return "Error: target fps too high, the frame period would be under 1 ns";
+    setTargetFps(targetFps);
+    return "";
+}
+
+string FramePacer::cmdSpinTime(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    // in microseconds
+    setSpinTime(boost::lexical_cast<boost::uint64_t>(args[0]) * 1000);
+    return "";
+}
+
+string FramePacer::cmdStats(deque<string>&) {
+    return report();
+}
+
+string FramePacer::cmdStatsReset(deque<string>&) {
+    reset();
+    return "";
+}
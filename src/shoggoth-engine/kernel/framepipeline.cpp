@@ -0,0 +1,155 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/framepipeline.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include "shoggoth-engine/common/clock.hpp"
+#include "shoggoth-engine/kernel/simulationloop.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
+
+using namespace std;
+
+FramePipeline::FramePipeline(SimulationLoop* simulationLoop, const step_slot_t& stepSlot):
+    m_simulationLoop(simulationLoop),
+    m_stepSlot(stepSlot),
+    m_worker(0),
+    m_mutex(),
+    m_condition(),
+    m_isStageRunning(false),
+    m_isShuttingDown(false),
+    m_totalStages(0),
+    m_stageTime(0),
+    m_waitTime(0)
+{}
+
+FramePipeline::~FramePipeline() {
+    if (m_worker == 0)
+        return;
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_isShuttingDown = true;
+    }
+    m_condition.notify_all();
+    m_worker->join();
+    delete m_worker;
+}
+
+bool FramePipeline::isStageRunning() const {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    return m_isStageRunning;
+}
+
+void FramePipeline::startStage() {
+    if (m_worker == 0)
+        m_worker = new boost::thread(&FramePipeline::runWorker, this);
+    // the clock is read here, the frame's time must not include the time to draw it
+    m_simulationLoop->beginFrame();
+    {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_isStageRunning = true;
+    }
+    m_condition.notify_all();
+}
+
+void FramePipeline::waitStage() {
+    boost::uint64_t startTime = Clock::nanoseconds();
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (m_isStageRunning)
+        m_condition.wait(lock);
+    m_waitTime += Clock::nanoseconds() - startTime;
+}
+
+string FramePipeline::report() const {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    stringstream ss;
+    ss << "Pipelined frames: " << m_totalStages << endl;
+    if (m_totalStages > 0) {
+        double stages = double(m_totalStages);
+        ss << fixed << setprecision(3);
+        ss << "  steps:          " << double(m_stageTime) * 1.0e-6 / stages << " ms avg" << endl;
+        ss << "  waiting steps:  " << double(m_waitTime) * 1.0e-6 / stages << " ms avg" << endl;
+    }
+    return ss.str();
+}
+
+void FramePipeline::reset() {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_totalStages = 0;
+    m_stageTime = 0;
+    m_waitTime = 0;
+}
+
+
+
+FramePipeline::FramePipeline(const FramePipeline& rhs):
+    m_simulationLoop(rhs.m_simulationLoop),
+    m_stepSlot(rhs.m_stepSlot),
+    m_worker(0),
+    m_mutex(),
+    m_condition(),
+    m_isStageRunning(false),
+    m_isShuttingDown(false),
+    m_totalStages(0),
+    m_stageTime(0),
+    m_waitTime(0)
+{
+    cerr << "Error: FramePipeline copy constructor should not be called!" << endl;
+}
+
+FramePipeline& FramePipeline::operator=(const FramePipeline&) {
+    cerr << "Error: FramePipeline assignment operator should not be called!" << endl;
+    return *this;
+}
+
+void FramePipeline::runWorker() {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (!m_isShuttingDown) {
+        if (!m_isStageRunning) {
+            m_condition.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        boost::uint64_t startTime = Clock::nanoseconds();
+        runStage();
+        boost::uint64_t stageTime = Clock::nanoseconds() - startTime;
+        lock.lock();
+
+        m_stageTime += stageTime;
+        ++m_totalStages;
+        m_isStageRunning = false;
+        m_condition.notify_all();
+    }
+}
+
+void FramePipeline::runStage() {
+    TraceScope trace("FramePipeline::runStage");
+    while (m_simulationLoop->step())
+        m_stepSlot(m_simulationLoop->getTimestep());
+}
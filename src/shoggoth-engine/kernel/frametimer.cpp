@@ -0,0 +1,143 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/frametimer.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include "shoggoth-engine/kernel/logger.hpp"
+
+using namespace std;
+
+const char* FRAME_PHASE_NAMES[TOTAL_FRAME_PHASES] = {
+    "events",
+    "commands",
+    "physics",
+    "culling",
+    "draw",
+    "swap",
+    "frame"
+};
+
+boost::uint64_t FrameTimer::ms_phaseStart[TOTAL_FRAME_PHASES];
+FrameTimer::frame_times_t FrameTimer::ms_frame = {{0}};
+FrameTimer::frame_times_t FrameTimer::ms_history[FRAME_HISTORY];
+boost::uint64_t FrameTimer::ms_totalFrames = 0;
+Histogram FrameTimer::ms_windows[2][TOTAL_FRAME_PHASES];
+size_t FrameTimer::ms_window = 0;
+size_t FrameTimer::ms_windowFrames = 0;
+
+void FrameTimer::endFrame(const boost::uint64_t frameTime) {
+    ms_frame.phases[FRAME_PHASE_TOTAL] = frameTime;
+    ms_history[ms_totalFrames % FRAME_HISTORY] = ms_frame;
+    ++ms_totalFrames;
+
+    if (ms_windowFrames == FRAME_WINDOW_FRAMES) {
+        // the older window is forgotten and starts over
+        ms_window = 1 - ms_window;
+        for (size_t i = 0; i < TOTAL_FRAME_PHASES; ++i)
+            ms_windows[ms_window][i].reset();
+        ms_windowFrames = 0;
+    }
+    for (size_t i = 0; i < TOTAL_FRAME_PHASES; ++i) {
+        ms_windows[ms_window][i].record(ms_frame.phases[i]);
+        ms_frame.phases[i] = 0;
+    }
+    ++ms_windowFrames;
+}
+
+double FrameTimer::getMeanFrameTime() {
+    const Histogram& current = ms_windows[ms_window][FRAME_PHASE_TOTAL];
+    const Histogram& previous = ms_windows[1 - ms_window][FRAME_PHASE_TOTAL];
+    boost::uint64_t frames = current.getCount() + previous.getCount();
+    if (frames == 0)
+        return 0.0;
+    return (current.getMean() * double(current.getCount()) + previous.getMean() * double(previous.getCount())) / double(frames);
+}
+
+void FrameTimer::getHistogram(const frame_phase_t phase, Histogram& histogram) {
+    histogram.reset();
+    histogram.add(ms_windows[0][phase]);
+    histogram.add(ms_windows[1][phase]);
+}
+
+void FrameTimer::reset() {
+    for (size_t i = 0; i < TOTAL_FRAME_PHASES; ++i) {
+        ms_windows[0][i].reset();
+        ms_windows[1][i].reset();
+        ms_frame.phases[i] = 0;
+    }
+    ms_window = 0;
+    ms_windowFrames = 0;
+    ms_totalFrames = 0;
+}
+
+string FrameTimer::report() {
+    Histogram histogram;
+    stringstream ss;
+    ss << left << setw(12) << "phase" << right
+       << setw(10) << "frames"
+       << setw(10) << "mean ms"
+       << setw(10) << "p50 ms"
+       << setw(10) << "p95 ms"
+       << setw(10) << "p99 ms"
+       << setw(10) << "max ms" << endl;
+    ss << fixed << setprecision(3);
+    for (size_t i = 0; i < TOTAL_FRAME_PHASES; ++i) {
+        getHistogram(frame_phase_t(i), histogram);
+        ss << left << setw(12) << FRAME_PHASE_NAMES[i] << right
+           << setw(10) << histogram.getCount()
+           << setw(10) << histogram.getMean() * 1.0e-6
+           << setw(10) << double(histogram.getPercentile(50.0)) * 1.0e-6
+           << setw(10) << double(histogram.getPercentile(95.0)) * 1.0e-6
+           << setw(10) << double(histogram.getPercentile(99.0)) * 1.0e-6
+           << setw(10) << double(histogram.getMax()) * 1.0e-6 << endl;
+    }
+    return ss.str();
+}
+
+bool FrameTimer::exportCsv(const string& fileName) {
+    ofstream file(fileName.c_str(), ios::out | ios::trunc);
+    if (!file.is_open() || !file.good()) {
+        LogError() << "Error: could not open file: " << fileName;
+        return false;
+    }
+    file << "frame";
+    for (size_t i = 0; i < TOTAL_FRAME_PHASES; ++i)
+        file << "," << FRAME_PHASE_NAMES[i] << "_ns";
+    file << endl;
+    boost::uint64_t first = ms_totalFrames > FRAME_HISTORY? ms_totalFrames - FRAME_HISTORY : 0;
+    for (boost::uint64_t frame = first; frame < ms_totalFrames; ++frame) {
+        const frame_times_t& times = ms_history[frame % FRAME_HISTORY];
+        file << frame;
+        for (size_t i = 0; i < TOTAL_FRAME_PHASES; ++i)
+            file << "," << times.phases[i];
+        file << endl;
+    }
+    file.close();
+    return true;
+}
@@ -0,0 +1,97 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/histogram.hpp"
+
+#include <cmath>
+
+using namespace std;
+
+const size_t SUB_BUCKETS = size_t(1) << HISTOGRAM_SUB_BUCKET_BITS;
+
+Histogram::Histogram():
+    m_buckets(),
+    m_count(0),
+    m_total(0),
+    m_max(0)
+{
+}
+
+boost::uint64_t Histogram::getPercentile(const double percentile) const {
+    if (m_count == 0)
+        return 0;
+    boost::uint64_t rank = boost::uint64_t(ceil(percentile * 0.01 * double(m_count)));
+    if (rank == 0)
+        rank = 1;
+    boost::uint64_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            boost::uint64_t limit = getBucketLimit(i);
+            return limit < m_max? limit : m_max;
+        }
+    }
+    return m_max;
+}
+
+void Histogram::add(const Histogram& rhs) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        m_buckets[i] += rhs.m_buckets[i];
+    m_count += rhs.m_count;
+    m_total += rhs.m_total;
+    if (rhs.m_max > m_max)
+        m_max = rhs.m_max;
+}
+
+void Histogram::reset() {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        m_buckets[i] = 0;
+    m_count = 0;
+    m_total = 0;
+    m_max = 0;
+}
+
+
+
+size_t Histogram::findBucket(const boost::uint64_t value) {
+    if (value < SUB_BUCKETS)
+        return size_t(value);
+    size_t exponent = HISTOGRAM_SUB_BUCKET_BITS;
+    while (exponent < 63 && (value >> (exponent + 1)) != 0)
+        ++exponent;
+    size_t shift = exponent - HISTOGRAM_SUB_BUCKET_BITS;
+    size_t subBucket = size_t(value >> shift) & (SUB_BUCKETS - 1);
+    return (shift + 1) * SUB_BUCKETS + subBucket;
+}
+
+boost::uint64_t Histogram::getBucketLimit(const size_t bucket) {
+    // the highest value that falls in the bucket
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    size_t shift = bucket / SUB_BUCKETS - 1;
+    boost::uint64_t lower = boost::uint64_t(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return lower + ((boost::uint64_t(1) << shift) - 1);
+}
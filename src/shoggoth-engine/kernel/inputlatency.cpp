@@ -0,0 +1,109 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/inputlatency.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include "shoggoth-engine/common/clock.hpp"
+
+using namespace std;
+
+const char* LATENCY_STAGE_NAMES[TOTAL_LATENCY_STAGES] = {
+    "event to command",
+    "command to draw",
+    "draw to swap",
+    "event to swap"
+};
+
+bool InputLatency::ms_isEnabled = false;
+Histogram InputLatency::ms_histograms[TOTAL_LATENCY_STAGES];
+boost::uint64_t InputLatency::ms_frameInputTime = 0;
+boost::uint64_t InputLatency::ms_frameCommandTime = 0;
+boost::uint64_t InputLatency::ms_frameDrawTime = 0;
+
+void InputLatency::setEnabled(const bool isEnabled) {
+    ms_isEnabled = isEnabled;
+    ms_frameInputTime = 0;
+    ms_frameCommandTime = 0;
+    ms_frameDrawTime = 0;
+}
+
+void InputLatency::onCommand(const boost::uint64_t inputTime) {
+    if (!ms_isEnabled || inputTime == 0)
+        return;
+    boost::uint64_t now = Clock::nanoseconds();
+    ms_histograms[LATENCY_EVENT_TO_COMMAND].record(now - inputTime);
+    // commands run after the draw started are shown on the next frame
+    if (ms_frameDrawTime == 0 && (ms_frameInputTime == 0 || inputTime < ms_frameInputTime)) {
+        ms_frameInputTime = inputTime;
+        ms_frameCommandTime = now;
+    }
+}
+
+void InputLatency::onDraw() {
+    if (!ms_isEnabled || ms_frameInputTime == 0 || ms_frameDrawTime != 0)
+        return;
+    ms_frameDrawTime = Clock::nanoseconds();
+    ms_histograms[LATENCY_COMMAND_TO_DRAW].record(ms_frameDrawTime - ms_frameCommandTime);
+}
+
+void InputLatency::onSwap() {
+    if (!ms_isEnabled || ms_frameDrawTime == 0)
+        return;
+    boost::uint64_t now = Clock::nanoseconds();
+    ms_histograms[LATENCY_DRAW_TO_SWAP].record(now - ms_frameDrawTime);
+    ms_histograms[LATENCY_EVENT_TO_SWAP].record(now - ms_frameInputTime);
+    ms_frameInputTime = 0;
+    ms_frameCommandTime = 0;
+    ms_frameDrawTime = 0;
+}
+
+void InputLatency::reset() {
+    for (size_t i = 0; i < TOTAL_LATENCY_STAGES; ++i)
+        ms_histograms[i].reset();
+}
+
+string InputLatency::report() {
+    stringstream ss;
+    ss << left << setw(20) << "stage" << right
+       << setw(10) << "samples"
+       << setw(10) << "p50 ms"
+       << setw(10) << "p95 ms"
+       << setw(10) << "p99 ms"
+       << setw(10) << "max ms" << endl;
+    ss << fixed << setprecision(3);
+    for (size_t i = 0; i < TOTAL_LATENCY_STAGES; ++i) {
+        const Histogram& histogram = ms_histograms[i];
+        ss << left << setw(20) << LATENCY_STAGE_NAMES[i] << right
+           << setw(10) << histogram.getCount()
+           << setw(10) << double(histogram.getPercentile(50.0)) * 1.0e-6
+           << setw(10) << double(histogram.getPercentile(95.0)) * 1.0e-6
+           << setw(10) << double(histogram.getPercentile(99.0)) * 1.0e-6
+           << setw(10) << double(histogram.getMax()) * 1.0e-6 << endl;
+    }
+    return ss.str();
+}
@@ -26,12 +26,15 @@
 
 #include "shoggoth-engine/kernel/inputs.hpp"
 
-#include <iostream>
 #include <sstream>
 #include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/objectselector.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
+const size_t UNRESOLVED_BINDING = size_t(-1);
+
 Inputs::Inputs():
     m_keyPressMap(),
     m_keyReleaseMap(),
@@ -44,7 +47,8 @@ Inputs::Inputs():
 {}
 
 void Inputs::bindInput(const input_t type, const string& command, const size_t code) {
-    pair<size_t, string> binding(code, command);
+    binding_t resolved = {command, Command(), UNRESOLVED_BINDING, false};
+    pair<size_t, binding_t> binding(code, resolved);
     switch (type) {
     case INPUT_KEY_PRESS:
         m_keyPressMap.insert(binding);
@@ -65,14 +69,15 @@ void Inputs::bindInput(const input_t type, const string& command, const size_t c
         m_mouseButtonPressedMap.insert(binding);
         break;
     case INPUT_MOUSE_MOTION:
-        m_mouseMotionList.push_back(command);
+        m_mouseMotionList.push_back(resolved);
         break;
     default:
-        cerr << "Invalid input_t: " << type << endl;
+        LogError() << "Invalid input_t: " << type;
     }
 }
 
 void Inputs::clearAllBindings() {
+    Terminal::cancelBoundCommands();
     m_keyPressMap.clear();
     m_keyReleaseMap.clear();
     m_keyPressedMap.clear();
@@ -82,78 +87,83 @@ void Inputs::clearAllBindings() {
     m_mouseMotionList.clear();
 }
 
-void Inputs::onKeyPress(const size_t code) {
-    input_map_t::iterator it = m_keyPressMap.find(code);
-    if (it != m_keyPressMap.end())
-        Terminal::pushCommand(it->second);
+void Inputs::onKeyPress(const size_t code, const boost::uint64_t time) {
+    pushBinding(m_keyPressMap, code, time);
 }
 
-void Inputs::onKeyRelease(const size_t code) {
-    input_map_t::iterator it = m_keyReleaseMap.find(code);
-    if (it != m_keyReleaseMap.end())
-        Terminal::pushCommand(it->second);
+void Inputs::onKeyRelease(const size_t code, const boost::uint64_t time) {
+    pushBinding(m_keyReleaseMap, code, time);
 }
 
-void Inputs::onKeyPressed(const size_t code) {
-    input_map_t::iterator it = m_keyPressedMap.find(code);
-    if (it != m_keyPressedMap.end())
-        Terminal::pushCommand(it->second);
+void Inputs::onKeyPressed(const size_t code, const boost::uint64_t time) {
+    pushBinding(m_keyPressedMap, code, time);
 }
 
-void Inputs::onMouseButtonPress(const size_t code) {
-    input_map_t::iterator it = m_mouseButtonPressMap.find(code);
-    if (it != m_mouseButtonPressMap.end())
-        Terminal::pushCommand(it->second);
+void Inputs::onMouseButtonPress(const size_t code, const boost::uint64_t time) {
+    pushBinding(m_mouseButtonPressMap, code, time);
 }
 
-void Inputs::onMouseButtonRelease(const size_t code) {
-    input_map_t::iterator it = m_mouseButtonReleaseMap.find(code);
-    if (it != m_mouseButtonReleaseMap.end())
-        Terminal::pushCommand(it->second);
+void Inputs::onMouseButtonRelease(const size_t code, const boost::uint64_t time) {
+    pushBinding(m_mouseButtonReleaseMap, code, time);
 }
 
-void Inputs::onMouseButtonPressed(const size_t code) {
-    input_map_t::iterator it = m_mouseButtonPressedMap.find(code);
-    if (it != m_mouseButtonPressedMap.end())
-        Terminal::pushCommand(it->second);
+void Inputs::onMouseButtonPressed(const size_t code, const boost::uint64_t time) {
+    pushBinding(m_mouseButtonPressedMap, code, time);
 }
 
-void Inputs::onMouseMotion(const mouse_motion_t& motion) {
+void Inputs::onMouseMotion(const mouse_motion_t& motion, const boost::uint64_t time) {
     m_lastMouseMotion = motion;
-    for (size_t i = 0; i < m_mouseMotionList.size(); ++i)
-        Terminal::pushCommand(m_mouseMotionList[i]);
+    for (input_list_t::iterator it = m_mouseMotionList.begin(); it != m_mouseMotionList.end(); ++it)
+        pushBinding(*it, time);
+}
+
+void Inputs::pushBinding(input_map_t& bindings, const size_t code, const boost::uint64_t time) {
+    input_map_t::iterator it = bindings.find(code);
+    if (it != bindings.end())
+        pushBinding(it->second, time);
+}
+
+void Inputs::pushBinding(binding_t& binding, const boost::uint64_t time) {
+    const size_t generation = ObjectSelector::getGeneration();
+    if (binding.generation != generation) {
+        binding.isResolved = binding.command.parseCommand(binding.expression);
+        binding.generation = generation;
+    }
+    if (binding.isResolved)
+        Terminal::pushBoundCommand(binding.command, time);
 }
 
 ostream& operator<<(ostream& out, const Inputs& rhs) {
-    map<size_t, string>::const_iterator it;
+    Inputs::input_map_t::const_iterator it;
 
     out << "Key Press Map:" << endl;
     for (it = rhs.m_keyPressMap.begin(); it != rhs.m_keyPressMap.end(); ++it)
-        out << "\t" << it->first << "\t" << it->second << endl;
+        out << "\t" << it->first << "\t" << it->second.expression << endl;
 
     out << "Key Release Map:" << endl;
     for (it = rhs.m_keyReleaseMap.begin(); it != rhs.m_keyReleaseMap.end(); ++it)
-        out << "\t" << it->first << "\t" << it->second << endl;
+        out << "\t" << it->first << "\t" << it->second.expression << endl;
 
     out << "Key Pressed Map:" << endl;
     for (it = rhs.m_keyPressedMap.begin(); it != rhs.m_keyPressedMap.end(); ++it)
-        out << "\t" << it->first << "\t" << it->second << endl;
+        out << "\t" << it->first << "\t" << it->second.expression << endl;
 
     out << "Mouse Button Press Map:" << endl;
     for (it = rhs.m_mouseButtonPressMap.begin(); it != rhs.m_mouseButtonPressMap.end(); ++it)
-        out << "\t" << it->first << "\t" << it->second << endl;
+        out << "\t" << it->first << "\t" << it->second.expression << endl;
 
     out << "Mouse Button Release Map:" << endl;
     for (it = rhs.m_mouseButtonReleaseMap.begin(); it != rhs.m_mouseButtonReleaseMap.end(); ++it)
-        out << "\t" << it->first << "\t" << it->second << endl;
+        out << "\t" << it->first << "\t" << it->second.expression << endl;
 
     out << "Mouse Button Pressed Map:" << endl;
     for (it = rhs.m_mouseButtonPressedMap.begin(); it != rhs.m_mouseButtonPressedMap.end(); ++it)
-        out << "\t" << it->first << "\t" << it->second << endl;
+        out << "\t" << it->first << "\t" << it->second.expression << endl;
 
     out << "Mouse Motion Map:" << endl;
-    for (size_t i = 0; i < rhs.m_mouseMotionList.size(); ++i)
-        out << "\t" << rhs.m_mouseMotionList[i] << endl;
+    Inputs::input_list_t::const_iterator itList;
+    for (itList = rhs.m_mouseMotionList.begin(); itList != rhs.m_mouseMotionList.end(); ++itList)
+        out << "\t" << itList->expression << endl;
 
     return out;
 }
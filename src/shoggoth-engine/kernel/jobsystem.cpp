@@ -0,0 +1,347 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <boost/lexical_cast.hpp>
+#include "shoggoth-engine/kernel/logger.hpp"
+
+using namespace std;
+
+const job_t NO_JOB = {job_slot_t(), 0, 0, 0, JOB_ANY_THREAD};
+
+// searches a waiting thread makes before it sleeps until a job is pushed or a counter finishes
+const size_t WAIT_SPINS = 64;
+
+// slot 0 always exists, it belongs to the main thread (and to threads that are not workers)
+vector<JobSystem::job_queue_t*> JobSystem::ms_queues(1, new job_queue_t());
+vector<boost::thread*> JobSystem::ms_workers = vector<boost::thread*>();
+JobSystem::job_queue_t JobSystem::ms_mainThreadJobs;
+boost::thread_specific_ptr<size_t> JobSystem::ms_queueIndex;
+boost::thread::id JobSystem::ms_mainThreadId;
+boost::mutex JobSystem::ms_sleepMutex;
+boost::condition_variable JobSystem::ms_sleepCondition;
+boost::condition_variable JobSystem::ms_waitCondition;
+boost::uint64_t JobSystem::ms_generation = 0;
+bool JobSystem::ms_isShuttingDown = false;
+
+
+JobCounter::JobCounter():
+    m_mutex(),
+    m_pendingJobs(0),
+    m_continuations()
+{}
+
+bool JobCounter::isDone() const {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    return m_pendingJobs == 0;
+}
+
+JobCounter::JobCounter(const JobCounter&):
+    m_mutex(),
+    m_pendingJobs(0),
+    m_continuations()
+{
+    cerr << "Error: JobCounter copy constructor should not be called!" << endl;
+}
+
+JobCounter& JobCounter::operator=(const JobCounter&) {
+    cerr << "Error: JobCounter assignment operator should not be called!" << endl;
+    return *this;
+}
+
+
+
+void JobSystem::initialize(const size_t totalWorkers) {
+    if (!ms_workers.empty())
+        return;
+    ms_mainThreadId = boost::this_thread::get_id();
+    ms_queueIndex.reset(new size_t(0));
+
+    // the main thread takes one core
+    size_t workers = totalWorkers;
+    if (workers == size_t(-1)) {
+        size_t cores = boost::thread::hardware_concurrency();
+        workers = cores > 1? cores - 1 : 0;
+    }
+    LogInfo() << "Starting job system with " << workers << " workers";
+
+    // every queue exists before any worker may try to steal from it
+    for (size_t i = 0; i < workers; ++i)
+        ms_queues.push_back(new job_queue_t());
+    for (size_t i = 0; i < workers; ++i)
+        ms_workers.push_back(new boost::thread(&JobSystem::runWorker, i + 1));
+}
+
+void JobSystem::shutdown() {
+    if (ms_workers.empty())
+        return;
+    {
+        boost::lock_guard<boost::mutex> lock(ms_sleepMutex);
+        ms_isShuttingDown = true;
+    }
+    ms_sleepCondition.notify_all();
+    for (size_t i = 0; i < ms_workers.size(); ++i) {
+        ms_workers[i]->join();
+        delete ms_workers[i];
+    }
+    ms_workers.clear();
+    ms_isShuttingDown = false;
+
+    // unfinished jobs are left to the main thread, someone may still wait on their counters
+    job_queue_t* mainQueue = ms_queues[0];
+    for (size_t i = 1; i < ms_queues.size(); ++i) {
+        mainQueue->jobs.insert(mainQueue->jobs.end(), ms_queues[i]->jobs.begin(), ms_queues[i]->jobs.end());
+        delete ms_queues[i];
+    }
+    ms_queues.resize(1);
+}
+
+void JobSystem::submit(const job_slot_t& slot, const size_t begin, const size_t end, JobCounter* counter,
+                       const job_affinity_t affinity, JobCounter* dependency)
+{
+    job_t job = {slot, begin, end, counter, affinity};
+    if (counter != 0) {
+        boost::lock_guard<boost::mutex> lock(counter->m_mutex);
+        ++counter->m_pendingJobs;
+    }
+    if (dependency != 0) {
+        boost::lock_guard<boost::mutex> lock(dependency->m_mutex);
+        if (dependency->m_pendingJobs > 0) {
+            dependency->m_continuations.push_back(job);
+            return;
+        }
+    }
+    push(job);
+}
+
+void JobSystem::parallelFor(const size_t begin, const size_t end, const size_t grainSize,
+                            const job_slot_t& slot, JobCounter* counter)
+{
+    size_t grain = max(grainSize, size_t(1));
+    for (size_t first = begin; first < end; first += grain)
+        submit(slot, first, min(first + grain, end), counter);
+}
+
+void JobSystem::parallelFor(const size_t begin, const size_t end, const size_t grainSize, const job_slot_t& slot) {
+    JobCounter counter;
+    parallelFor(begin, end, grainSize, slot, &counter);
+    wait(counter);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    // help instead of blocking, the jobs waited on may be in this thread's own queue.
+    // With workers only the counter's own jobs are taken, an unrelated long job would hold
+    // the waiter long after its counter is done; without them every job has to run here.
+    size_t index = getQueueIndex();
+    const JobCounter* filter = ms_workers.empty()? 0 : &counter;
+    job_t job = NO_JOB;
+    size_t spins = 0;
+    while (true) {
+        boost::uint64_t generation;
+        {
+            boost::lock_guard<boost::mutex> lock(ms_sleepMutex);
+            generation = ms_generation;
+        }
+        if (counter.isDone())
+            break;
+        if (findJob(index, job, filter)) {
+            runJob(job);
+            spins = 0;
+        }
+        else if (++spins < WAIT_SPINS)
+            boost::this_thread::yield();
+        else {
+            boost::unique_lock<boost::mutex> lock(ms_sleepMutex);
+            while (ms_generation == generation)
+                ms_waitCondition.wait(lock);
+            spins = 0;
+        }
+    }
+}
+
+size_t JobSystem::runMainThreadJobs() {
+    size_t totalJobs = 0;
+    job_t job = NO_JOB;
+    while (popMainThreadJob(job)) {
+        runJob(job);
+        ++totalJobs;
+    }
+    return totalJobs;
+}
+
+string JobSystem::report() {
+    // counters are read while workers update them, they are only an approximation
+    stringstream ss;
+    ss << "Job system workers: " << ms_workers.size() << endl;
+    for (size_t i = 0; i < ms_queues.size(); ++i) {
+        ss << "  " << (i == 0? string("main") : string("worker ") + boost::lexical_cast<string>(i)) << ": "
+           << ms_queues[i]->executedJobs.load(boost::memory_order_relaxed) << " jobs, "
+           << ms_queues[i]->stolenJobs.load(boost::memory_order_relaxed) << " stolen" << endl;
+    }
+    ss << "  main thread only: " << ms_mainThreadJobs.executedJobs.load(boost::memory_order_relaxed) << " jobs" << endl;
+    return ss.str();
+}
+
+void JobSystem::resetStats() {
+    for (size_t i = 0; i < ms_queues.size(); ++i) {
+        ms_queues[i]->executedJobs.store(0, boost::memory_order_relaxed);
+        ms_queues[i]->stolenJobs.store(0, boost::memory_order_relaxed);
+    }
+    ms_mainThreadJobs.executedJobs.store(0, boost::memory_order_relaxed);
+}
+
+
+
+size_t JobSystem::getQueueIndex() {
+    const size_t* index = ms_queueIndex.get();
+    return index != 0? *index : 0;
+}
+
+void JobSystem::push(const job_t& job) {
+    if (job.affinity == JOB_MAIN_THREAD) {
+        boost::lock_guard<boost::mutex> lock(ms_mainThreadJobs.mutex);
+        ms_mainThreadJobs.jobs.push_back(job);
+    }
+    else {
+        job_queue_t* queue = ms_queues[getQueueIndex()];
+        boost::lock_guard<boost::mutex> lock(queue->mutex);
+        queue->jobs.push_back(job);
+    }
+    {
+        boost::lock_guard<boost::mutex> lock(ms_sleepMutex);
+        ++ms_generation;
+    }
+    if (job.affinity != JOB_MAIN_THREAD)
+        ms_sleepCondition.notify_one();
+    ms_waitCondition.notify_all();
+}
+
+bool JobSystem::popOwnJob(const size_t index, job_t& job, const JobCounter* counter) {
+    job_queue_t* queue = ms_queues[index];
+    boost::lock_guard<boost::mutex> lock(queue->mutex);
+    deque<job_t>::reverse_iterator it = queue->jobs.rbegin();
+    while (it != queue->jobs.rend() && counter != 0 && it->counter != counter)
+        ++it;
+    if (it == queue->jobs.rend())
+        return false;
+    job = *it;
+    queue->jobs.erase(--it.base());
+    return true;
+}
+
+bool JobSystem::stealJob(const size_t index, job_t& job, const JobCounter* counter) {
+    size_t totalQueues = ms_queues.size();
+    for (size_t i = 1; i < totalQueues; ++i) {
+        job_queue_t* victim = ms_queues[(index + i) % totalQueues];
+        boost::lock_guard<boost::mutex> lock(victim->mutex);
+        deque<job_t>::iterator it = victim->jobs.begin();
+        while (it != victim->jobs.end() && counter != 0 && it->counter != counter)
+            ++it;
+        if (it != victim->jobs.end()) {
+            job = *it;
+            victim->jobs.erase(it);
+            ms_queues[index]->stolenJobs.fetch_add(1, boost::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::popMainThreadJob(job_t& job) {
+    boost::lock_guard<boost::mutex> lock(ms_mainThreadJobs.mutex);
+    if (ms_mainThreadJobs.jobs.empty())
+        return false;
+    job = ms_mainThreadJobs.jobs.front();
+    ms_mainThreadJobs.jobs.pop_front();
+    return true;
+}
+
+bool JobSystem::findJob(const size_t index, job_t& job, const JobCounter* counter) {
+    if (popOwnJob(index, job, counter))
+        return true;
+    // before initialize() there is no main thread to hand them to, so whoever waits runs them.
+    // Any main thread job is taken, nobody else can run what the counter may depend on.
+    if ((isMainThread() || ms_mainThreadId == boost::thread::id()) && popMainThreadJob(job))
+        return true;
+    return stealJob(index, job, counter);
+}
+
+void JobSystem::runJob(const job_t& job) {
+    job.slot(job.begin, job.end);
+    if (job.affinity == JOB_MAIN_THREAD)
+        ms_mainThreadJobs.executedJobs.fetch_add(1, boost::memory_order_relaxed);
+    else
+        ms_queues[getQueueIndex()]->executedJobs.fetch_add(1, boost::memory_order_relaxed);
+    finishJob(job.counter);
+}
+
+void JobSystem::finishJob(JobCounter* counter) {
+    if (counter == 0)
+        return;
+    // the counter may be gone as soon as it is unlocked at zero, continuations are taken first
+    vector<job_t> continuations;
+    {
+        boost::lock_guard<boost::mutex> lock(counter->m_mutex);
+        --counter->m_pendingJobs;
+        if (counter->m_pendingJobs > 0)
+            return;
+        continuations.swap(counter->m_continuations);
+    }
+    for (size_t i = 0; i < continuations.size(); ++i)
+        push(continuations[i]);
+    // wakes the threads sleeping in wait(), one of them may be waiting on this counter
+    {
+        boost::lock_guard<boost::mutex> lock(ms_sleepMutex);
+        ++ms_generation;
+    }
+    ms_waitCondition.notify_all();
+}
+
+void JobSystem::runWorker(const size_t index) {
+    ms_queueIndex.reset(new size_t(index));
+    job_t job = NO_JOB;
+    while (true) {
+        boost::uint64_t generation;
+        {
+            boost::lock_guard<boost::mutex> lock(ms_sleepMutex);
+            if (ms_isShuttingDown)
+                break;
+            generation = ms_generation;
+        }
+        if (findJob(index, job, 0)) {
+            runJob(job);
+            continue;
+        }
+        // sleep until something is pushed after the search started
+        boost::unique_lock<boost::mutex> lock(ms_sleepMutex);
+        while (ms_generation == generation && !ms_isShuttingDown)
+            ms_sleepCondition.wait(lock);
+    }
+}
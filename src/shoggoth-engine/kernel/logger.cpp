@@ -0,0 +1,295 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/logger.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/chrono/chrono.hpp>
+#include "shoggoth-engine/common/clock.hpp"
+
+using namespace std;
+
+const size_t LOG_RING_MASK = LOG_RING_SLOTS - 1;
+const size_t LOG_ENTRY_SIZE = LOG_MESSAGE_SIZE + 32;
+const size_t LOG_REPEAT_ENTRIES = 64;
+const boost::uint64_t LOG_REPEAT_INTERVAL = 1000000000;
+const boost::uint64_t LOG_FLUSH_INTERVAL = 5;
+
+const char* LOG_LEVEL_NAMES[] = {"debug", "info", "warning", "error", "none"};
+
+// A slot is free for the producer claiming position p when its sequence is p, and holds a
+// message for the consumer at position p when its sequence is p + 1
+struct log_slot_t {
+    boost::atomic<size_t> sequence;
+    log_level_t level;
+    size_t length;
+    char text[LOG_ENTRY_SIZE];
+
+    log_slot_t(): sequence(0), level(LOG_LEVEL_INFO), length(0), text() {}
+};
+
+// recent messages of a thread by hash, to skip repetitions
+typedef struct {
+    boost::uint64_t hash;
+    boost::uint64_t windowStart;
+    boost::uint64_t repetitions;
+} log_repeat_t;
+
+struct log_repeat_table_t {
+    log_repeat_t entries[LOG_REPEAT_ENTRIES];
+
+    log_repeat_table_t(): entries() {}
+};
+
+log_slot_t g_ring[LOG_RING_SLOTS];
+boost::atomic<size_t> g_enqueuePosition(0);
+size_t g_dequeuePosition = 0;
+boost::mutex g_flushMutex;
+boost::atomic<bool> g_isRunning(false);
+boost::thread* g_flusher = 0;
+boost::thread_specific_ptr<log_repeat_table_t> g_repeatTable;
+
+boost::atomic<boost::uint64_t> g_totalMessages(0);
+boost::atomic<boost::uint64_t> g_droppedMessages(0);
+boost::atomic<boost::uint64_t> g_repeatedMessages(0);
+
+boost::atomic<int> Logger::ms_level(LOG_LEVEL_INFO);
+
+
+size_t formatEntry(char* entry, const char* text, const size_t length, const boost::uint64_t repetitions) {
+    memcpy(entry, text, length);
+    if (repetitions == 0)
+        return length;
+    int suffix = snprintf(entry + length, LOG_ENTRY_SIZE - length, " (repeated %lu times)",
+                          (unsigned long)(repetitions));
+    return suffix > 0? min(length + size_t(suffix), LOG_ENTRY_SIZE - 1) : length;
+}
+
+void writeEntry(const log_level_t level, const char* entry, const size_t length) {
+    ostream& out = level >= LOG_LEVEL_WARNING? cerr : cout;
+    out.write(entry, streamsize(length));
+    out.put('\n');
+}
+
+
+
+void Logger::initialize() {
+    if (g_isRunning.load(boost::memory_order_acquire))
+        return;
+    for (size_t i = 0; i < LOG_RING_SLOTS; ++i)
+        g_ring[i].sequence.store(i, boost::memory_order_relaxed);
+    g_enqueuePosition.store(0, boost::memory_order_relaxed);
+    g_dequeuePosition = 0;
+    g_isRunning.store(true, boost::memory_order_release);
+    g_flusher = new boost::thread(&Logger::runFlusher);
+}
+
+void Logger::shutdown() {
+    if (!g_isRunning.load(boost::memory_order_acquire))
+        return;
+    g_isRunning.store(false, boost::memory_order_release);
+    g_flusher->join();
+    delete g_flusher;
+    g_flusher = 0;
+    flush();
+    boost::uint64_t dropped = g_droppedMessages.load(boost::memory_order_relaxed);
+    if (dropped > 0)
+        cerr << "Warning: " << dropped << " log messages dropped, the log ring was full" << endl;
+}
+
+void Logger::flush() {
+    boost::lock_guard<boost::mutex> lock(g_flushMutex);
+    bool hasWritten = false;
+    for (;;) {
+        log_slot_t& slot = g_ring[g_dequeuePosition & LOG_RING_MASK];
+        if (slot.sequence.load(boost::memory_order_acquire) != g_dequeuePosition + 1)
+            break;
+        writeEntry(slot.level, slot.text, slot.length);
+        slot.sequence.store(g_dequeuePosition + LOG_RING_SLOTS, boost::memory_order_release);
+        ++g_dequeuePosition;
+        hasWritten = true;
+    }
+    if (hasWritten) {
+        cout.flush();
+        cerr.flush();
+    }
+}
+
+bool Logger::parseLevel(const string& name, log_level_t& level) {
+    for (size_t i = 0; i <= size_t(LOG_LEVEL_NONE); ++i) {
+        if (name == LOG_LEVEL_NAMES[i]) {
+            level = log_level_t(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::write(const log_level_t level, const char* text, const size_t length) {
+    boost::uint64_t repetitions = 0;
+    if (isRepeated(level, text, length, repetitions)) {
+        g_repeatedMessages.fetch_add(1, boost::memory_order_relaxed);
+        return;
+    }
+    g_totalMessages.fetch_add(1, boost::memory_order_relaxed);
+
+    if (!g_isRunning.load(boost::memory_order_acquire)) {
+        char entry[LOG_ENTRY_SIZE];
+        size_t entryLength = formatEntry(entry, text, length, repetitions);
+        boost::lock_guard<boost::mutex> lock(g_flushMutex);
+        writeEntry(level, entry, entryLength);
+        return;
+    }
+
+    // claim a slot, several threads may be racing for it
+    size_t position = g_enqueuePosition.load(boost::memory_order_relaxed);
+    log_slot_t* slot = 0;
+    for (;;) {
+        slot = &g_ring[position & LOG_RING_MASK];
+        size_t sequence = slot->sequence.load(boost::memory_order_acquire);
+        if (sequence == position) {
+            if (g_enqueuePosition.compare_exchange_weak(position, position + 1, boost::memory_order_relaxed))
+                break;
+        }
+        else if (sequence < position) {
+            // still holds the message from a lap ago, the ring is full
+            g_droppedMessages.fetch_add(1, boost::memory_order_relaxed);
+            return;
+        }
+        else
+            position = g_enqueuePosition.load(boost::memory_order_relaxed);
+    }
+    slot->level = level;
+    slot->length = formatEntry(slot->text, text, length, repetitions);
+    slot->sequence.store(position + 1, boost::memory_order_release);
+}
+
+string Logger::report() {
+    stringstream ss;
+    ss << "Log level " << LOG_LEVEL_NAMES[getLevel()]
+       << " (compiled from " << LOG_LEVEL_NAMES[LOG_COMPILED_LEVEL] << ")" << endl;
+    ss << "  messages:  " << g_totalMessages.load(boost::memory_order_relaxed) << endl;
+    ss << "  repeated:  " << g_repeatedMessages.load(boost::memory_order_relaxed) << " skipped" << endl;
+    ss << "  dropped:   " << g_droppedMessages.load(boost::memory_order_relaxed) << endl;
+    return ss.str();
+}
+
+void Logger::resetStats() {
+    g_totalMessages.store(0, boost::memory_order_relaxed);
+    g_droppedMessages.store(0, boost::memory_order_relaxed);
+    g_repeatedMessages.store(0, boost::memory_order_relaxed);
+}
+
+void Logger::runFlusher() {
+    while (g_isRunning.load(boost::memory_order_acquire)) {
+        flush();
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(LOG_FLUSH_INTERVAL));
+    }
+}
+
+bool Logger::isRepeated(const log_level_t level, const char* text, const size_t length,
+                        boost::uint64_t& repetitions)
+{
+    log_repeat_table_t* table = g_repeatTable.get();
+    if (table == 0) {
+        table = new log_repeat_table_t();
+        g_repeatTable.reset(table);
+    }
+
+    // FNV-1a
+    boost::uint64_t hash = 14695981039346656037ULL ^ boost::uint64_t(level);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= boost::uint64_t((unsigned char)(text[i]));
+        hash *= 1099511628211ULL;
+    }
+
+    log_repeat_t& entry = table->entries[hash % LOG_REPEAT_ENTRIES];
+    boost::uint64_t now = Clock::nanoseconds();
+    if (entry.hash == hash) {
+        if (now - entry.windowStart < LOG_REPEAT_INTERVAL) {
+            ++entry.repetitions;
+            return true;
+        }
+        repetitions = entry.repetitions;
+    }
+    entry.hash = hash;
+    entry.windowStart = now;
+    entry.repetitions = 0;
+    return false;
+}
+
+
+
+// the text is not cleared, only its first m_length characters are ever read
+LogLine::LogLine(const bool isEnabled):
+    m_isEnabled(isEnabled),
+    m_length(0)
+{}
+
+void LogLine::send(const log_level_t level) {
+    Logger::write(level, m_text, m_length);
+}
+
+void LogLine::append(const char* text) {
+    while (*text != '\0' && m_length < LOG_MESSAGE_SIZE)
+        m_text[m_length++] = *text++;
+}
+
+void LogLine::append(const string& text) {
+    size_t length = min(text.size(), LOG_MESSAGE_SIZE - m_length);
+    memcpy(m_text + m_length, text.data(), length);
+    m_length += length;
+}
+
+void LogLine::append(const char character) {
+    if (m_length < LOG_MESSAGE_SIZE)
+        m_text[m_length++] = character;
+}
+
+void LogLine::append(const long number) {
+    char text[32];
+    snprintf(text, sizeof(text), "%ld", number);
+    append(text);
+}
+
+void LogLine::append(const unsigned long number) {
+    char text[32];
+    snprintf(text, sizeof(text), "%lu", number);
+    append(text);
+}
+
+void LogLine::append(const double number) {
+    char text[32];
+    snprintf(text, sizeof(text), "%g", number);
+    append(text);
+}
@@ -33,6 +33,7 @@ using namespace std;
 Mesh::Mesh():
     m_vboId(0),
     m_indicesId(0),
+    m_vaoId(0),
     m_vertices(),
     m_normals(),
     m_uvCoords(),
@@ -42,6 +43,7 @@ Mesh::Mesh():
 Mesh::Mesh(const Mesh& rhs):
     m_vboId(rhs.m_vboId),
     m_indicesId(rhs.m_indicesId),
+    m_vaoId(rhs.m_vaoId),
     m_vertices(rhs.m_vertices),
     m_normals(rhs.m_normals),
     m_uvCoords(rhs.m_uvCoords),
@@ -53,6 +55,7 @@ Mesh& Mesh::operator=(const Mesh& rhs) {
         return *this;
     m_vboId = rhs.m_vboId;
     m_indicesId = rhs.m_indicesId;
+    m_vaoId = rhs.m_vaoId;
     m_vertices = rhs.m_vertices;
     m_normals = rhs.m_normals;
     m_uvCoords = rhs.m_uvCoords;
@@ -32,13 +32,16 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include "shoggoth-engine/kernel/model.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
 #include "shoggoth-engine/renderer/texture.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
 const string OPTIMIZED_BINARY_FILE_EXTENSION = ".model";
 
 bool ModelLoader::load(const string& fileName, Model& model) {
+    TraceScope trace("ModelLoader::load");
 //     cout << "TEMPORAL: always importing model for testing purposes" << endl;
 //     import(fileName, model);
 
@@ -51,16 +54,17 @@ bool ModelLoader::load(const string& fileName, Model& model) {
 }
 
 bool ModelLoader::import(const string& fileName, Model& model) {
+    TraceScope trace("ModelLoader::import");
     model.m_meshes.clear();
-    cout << "Importing mesh: " << fileName << endl;
+    LogInfo() << "Importing mesh: " << fileName;
 
     Assimp::Importer importer;
 
     //check if file exists
     ifstream fin(fileName.c_str());
     if (!fin.is_open() || !fin.good()) {
-        cerr << "Error: could not open file: " << fileName << endl;
-        cerr << importer.GetErrorString() << endl;
+        LogError() << "Error: could not open file: " << fileName;
+        LogError() << importer.GetErrorString();
         return false;
     }
     fin.close();
@@ -85,8 +89,8 @@ bool ModelLoader::import(const string& fileName, Model& model) {
                               aiProcess_OptimizeMeshes |
                               aiProcess_Debone);
     if (scene == 0) {
-        cerr << importer.GetErrorString() << endl;
-        cerr << "Aborting importing file: " << fileName << endl;
+        LogError() << importer.GetErrorString();
+        LogError() << "Aborting importing file: " << fileName;
         return false;
     }
 
@@ -116,7 +120,7 @@ bool ModelLoader::import(const string& fileName, Model& model) {
         model.mesh(n)->m_indices.reserve(mesh->mNumFaces * 3);
         for (size_t i = 0; i < mesh->mNumFaces; ++i) {
             if (mesh->mFaces[i].mNumIndices != 3)
-                cerr << "Error: non-triangle face found, check model: " << fileName << endl;
+                LogError() << "Error: non-triangle face found, check model: " << fileName;
             model.mesh(n)->m_indices.push_back(mesh->mFaces[i].mIndices[0]);
             model.mesh(n)->m_indices.push_back(mesh->mFaces[i].mIndices[1]);
             model.mesh(n)->m_indices.push_back(mesh->mFaces[i].mIndices[2]);
@@ -139,14 +143,14 @@ bool ModelLoader::loadBinary(const string& fileName, Model& model) {
     string fileBin = fileName + OPTIMIZED_BINARY_FILE_EXTENSION;
     ifstream file(fileBin.c_str(), ios::in | ios::binary);
     if (!file.is_open() || !file.good()) {
-        cerr << "Optimized binary file not found: " << fileBin << endl;
+        LogDebug() << "Optimized binary file not found: " << fileBin;
         return false;
     }
 
     // temporal values
     size_t size;
 
-    cout << "Loading mesh: " << fileBin << endl;
+    LogInfo() << "Loading mesh: " << fileBin;
     // load header
     file.read(reinterpret_cast<char*>(&size), sizeof(size_t));
     model.m_meshes.resize(size);
@@ -179,10 +183,10 @@ bool ModelLoader::loadBinary(const string& fileName, Model& model) {
 
 bool ModelLoader::writeBinary(const std::string& fileName, Model& model) {
     string fileBin = fileName + OPTIMIZED_BINARY_FILE_EXTENSION;
-    cout << "Saving optimized binary mesh: " << fileBin << endl;
+    LogInfo() << "Saving optimized binary mesh: " << fileBin;
     ofstream file(fileBin.c_str(), ios::out | ios::binary | ios::trunc);
     if (!file.is_open() || !file.good()) {
-        cerr << "Error: could not open file: " << fileBin << endl;
+        LogError() << "Error: could not open file: " << fileBin;
         return false;
     }
 
@@ -0,0 +1,243 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/objectselector.hpp"
+
+#include <set>
+#include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/commandobject.hpp"
+#include "shoggoth-engine/kernel/entity.hpp"
+#include "shoggoth-engine/physics/rigidbody.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+
+using namespace std;
+
+const size_t MAX_CACHED_SELECTIONS = 64;
+
+ObjectSelector::selection_cache_t ObjectSelector::ms_cache = selection_cache_t();
+size_t ObjectSelector::ms_generation = 0;
+
+bool ObjectSelector::isSelector(const string& name) {
+    if (name.empty())
+        return false;
+    if (name[name.size() - 1] == SELECTOR_WAKE_CHAR)
+        return true;
+    return name.find_first_of("*?[/") != string::npos;
+}
+
+bool ObjectSelector::select(const string& selector, vector<CommandObject*>& objects) {
+    const selection_t* selection = resolve(selector);
+    if (selection == 0)
+        return false;
+    objects = selection->objects;
+    return true;
+}
+
+bool ObjectSelector::runCommand(const string& selector, const size_t idCommand, const deque<string>& arguments, string& output) {
+    output.resize(0);
+    const selection_t* selection = resolve(selector);
+    if (selection == 0) {
+        output = "Error: invalid selector: " + selector;
+        return false;
+    }
+
+    // the commands may create or delete objects, which drops the cached selection
+    const vector<CommandObject*> objects(selection->objects);
+    const vector<size_t> ids(selection->ids);
+    const bool isWakeRequested = selection->isWakeRequested;
+    const size_t generation = ms_generation;
+
+    deque<string> args;
+    string objectOutput;
+    CommandObject* object;
+    bool isFound = false;
+    RigidBody::deferActivations();
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (generation != ms_generation && (!Terminal::getObject(ids[i], object) || object != objects[i]))
+            continue;
+        object = objects[i];
+        if (!object->isCommandFound(idCommand))
+            continue;
+        isFound = true;
+        args = arguments;
+        objectOutput.resize(0);
+        object->runObjectCommand(idCommand, args, objectOutput);
+        if (!objectOutput.empty()) {
+            if (!output.empty())
+                output.push_back('\n');
+            output.append(objectOutput);
+        }
+        if (isWakeRequested && (generation == ms_generation || (Terminal::getObject(ids[i], object) && object == objects[i]))) {
+            Entity* entity = dynamic_cast<Entity*>(objects[i]);
+            Component* rigidBody = entity != 0? entity->component(COMPONENT_RIGIDBODY) : 0;
+            if (rigidBody != 0)
+                static_cast<RigidBody*>(rigidBody)->activate();
+        }
+    }
+    RigidBody::flushActivations();
+
+    if (!isFound && !objects.empty()) {
+        output = "Error: no object in " + selector + " has command " + Terminal::findCommandName(idCommand);
+        return false;
+    }
+    return true;
+}
+
+void ObjectSelector::invalidate() {
+    ms_cache.clear();
+    ++ms_generation;
+}
+
+const ObjectSelector::selection_t* ObjectSelector::resolve(const string& selector) {
+    selection_cache_t::const_iterator cached = ms_cache.find(selector);
+    if (cached != ms_cache.end())
+        return &cached->second;
+
+    string pattern = selector;
+    selection_t selection = {vector<CommandObject*>(), vector<size_t>(), false};
+    selection.isWakeRequested = !pattern.empty() && pattern[pattern.size() - 1] == SELECTOR_WAKE_CHAR;
+    if (selection.isWakeRequested)
+        pattern.resize(pattern.size() - 1);
+
+    // component filters: name[component][component]...
+    vector<string> components;
+    size_t filters = pattern.find('[');
+    for (size_t i = filters; i < pattern.size(); ) {
+        size_t end = pattern.find(']', i);
+        if (pattern[i] != '[' || end == string::npos || end == i + 1) {
+            LogError() << "Error: invalid selector: " << selector;
+            return 0;
+        }
+        components.push_back(pattern.substr(i + 1, end - i - 1));
+        i = end + 1;
+    }
+    if (filters != string::npos)
+        pattern.resize(filters);
+    if (pattern.empty())
+        pattern = "*";
+
+    vector<CommandObject*> objects;
+    if (pattern.find(SELECTOR_PATH_SEPARATOR) == string::npos)
+        selectByName(pattern, objects);
+    else {
+        vector<string> segments;
+        size_t begin = 0;
+        while (begin <= pattern.size()) {
+            size_t end = pattern.find(SELECTOR_PATH_SEPARATOR, begin);
+            if (end == string::npos)
+                end = pattern.size();
+            if (end > begin)
+                segments.push_back(pattern.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        if (!segments.empty()) {
+            vector<CommandObject*> roots;
+            selectByName("*", roots);
+            for (size_t i = 0; i < roots.size(); ++i) {
+                Entity* entity = dynamic_cast<Entity*>(roots[i]);
+                if (entity != 0 && entity->getParent() == 0)
+                    selectByPath(segments, 0, entity, objects);
+            }
+        }
+    }
+
+    // ** can reach the same entity through several paths
+    set<CommandObject*> selected;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (!selected.insert(objects[i]).second)
+            continue;
+        if (!components.empty()) {
+            const Entity* entity = dynamic_cast<const Entity*>(objects[i]);
+            bool hasComponents = entity != 0;
+            for (size_t j = 0; j < components.size() && hasComponents; ++j)
+                hasComponents = entity->getComponent(components[j]) != 0;
+            if (!hasComponents)
+                continue;
+        }
+        selection.objects.push_back(objects[i]);
+        selection.ids.push_back(objects[i]->getIdObject());
+    }
+
+    if (ms_cache.size() >= MAX_CACHED_SELECTIONS)
+        ms_cache.clear();
+    return &ms_cache.insert(pair<string, selection_t>(selector, selection)).first->second;
+}
+
+void ObjectSelector::selectByName(const string& pattern, vector<CommandObject*>& objects) {
+    // only the names sharing the literal prefix of the pattern have to be matched
+    vector<size_t> ids;
+    Terminal::ms_objectsTable.findIdsWithPrefix(pattern.substr(0, pattern.find_first_of("*?")), ids);
+    CommandObject* object;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (Terminal::getObject(ids[i], object) && isGlobMatch(pattern.c_str(), object->getObjectName().c_str()))
+            objects.push_back(object);
+    }
+}
+
+void ObjectSelector::selectByPath(const vector<string>& segments, const size_t segment, Entity* entity, vector<CommandObject*>& objects) {
+    const bool isLast = segment + 1 == segments.size();
+    if (segments[segment] == SELECTOR_ANY_DEPTH) {
+        if (isLast)
+            objects.push_back(entity);
+        else
+            selectByPath(segments, segment + 1, entity, objects);
+        for (Entity::child_iterator_t it = entity->getChildrenBegin(); it != entity->getChildrenEnd(); ++it)
+            selectByPath(segments, segment, *it, objects);
+    }
+    else if (isGlobMatch(segments[segment].c_str(), entity->getObjectName().c_str())) {
+        if (isLast)
+            objects.push_back(entity);
+        else {
+            for (Entity::child_iterator_t it = entity->getChildrenBegin(); it != entity->getChildrenEnd(); ++it)
+                selectByPath(segments, segment + 1, *it, objects);
+        }
+    }
+}
+
+bool ObjectSelector::isGlobMatch(const char* pattern, const char* name) {
+    // iterative matching, backtracking only to the last *
+    const char* star = 0;
+    const char* resume = 0;
+    while (*name != '\0') {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        }
+        else if (*pattern == '?' || *pattern == *name) {
+            ++pattern;
+            ++name;
+        }
+        else if (star != 0) {
+            pattern = star + 1;
+            name = ++resume;
+        }
+        else
+            return false;
+    }
+    while (*pattern == '*')
+        ++pattern;
+    return *pattern == '\0';
+}
@@ -28,18 +28,183 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <vector>
 #include <boost/foreach.hpp>
 #include <boost/property_tree/xml_parser.hpp>
+#include <bullet/btBulletCollisionCommon.h>
 #include "shoggoth-engine/common/xmlinfo.hpp"
 #include "shoggoth-engine/kernel/entity.hpp"
+#include "shoggoth-engine/kernel/model.hpp"
 #include "shoggoth-engine/kernel/componentfactory.hpp"
+#include "shoggoth-engine/kernel/asyncjob.hpp"
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
+#include "shoggoth-engine/kernel/startuptimer.hpp"
 #include "shoggoth-engine/renderer/camera.hpp"
+#include "shoggoth-engine/renderer/renderer.hpp"
+#include "shoggoth-engine/renderer/renderablemesh.hpp"
+#include "shoggoth-engine/physics/physicsworld.hpp"
+#include "shoggoth-engine/physics/rigidbody.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 using namespace boost::property_tree;
 
 map<string, Entity*> Scene::ms_entities = map<string, Entity*>();
 
+
+// Parses the XML file on the worker and generates the model files and convex hulls it uses,
+// which is the slow part of loading a scene, spread over the job system. Committing registers
+// them and builds the entities from the parsed tree, so the components find them already
+// loaded. A prefetched scene runs on the job system and gets its scene when it is loaded.
+class LoadSceneJob: public AsyncJob {
+public:
+    LoadSceneJob(Scene* scene, const string& fileName):
+        AsyncJob(),
+        m_scene(scene),
+        m_fileName(fileName),
+        m_tree(),
+        m_isTreeRead(false),
+        m_isLoaded(false),
+        m_modelFiles(),
+        m_convexHullFiles(),
+        m_files(),
+        m_models(),
+        m_convexHulls()
+    {}
+
+    ~LoadSceneJob() {
+        for (size_t i = 0; i < m_models.size(); ++i)
+            delete m_models[i];
+        for (size_t i = 0; i < m_convexHulls.size(); ++i)
+            delete m_convexHulls[i];
+    }
+
+    const string& getFileName() const {
+        return m_fileName;
+    }
+
+    bool isLoaded() const {
+        return m_isLoaded;
+    }
+
+    void setScene(Scene* scene) {
+        m_scene = scene;
+    }
+
+    void run() {
+        TraceScope trace("Scene load job");
+        {
+            StartupPhase phase("Scene XML");
+            m_isTreeRead = Scene::readXML(m_fileName, m_tree);
+        }
+        if (!m_isTreeRead)
+            return;
+        findFiles(m_tree);
+
+        // each job writes only its own slot. Hulls go after the models, a hull of a model not
+        // imported yet would import it again and both would write the same optimized file
+        m_models.resize(m_modelFiles.size(), 0);
+        m_convexHulls.resize(m_convexHullFiles.size(), 0);
+        m_files.assign(m_modelFiles.begin(), m_modelFiles.end());
+        m_files.insert(m_files.end(), m_convexHullFiles.begin(), m_convexHullFiles.end());
+        job_slot_t slot = job_slot_t::fromMethod<LoadSceneJob, &LoadSceneJob::loadFiles>(this);
+        JobSystem::parallelFor(0, m_models.size(), 1, slot);
+        JobSystem::parallelFor(m_models.size(), m_files.size(), 1, slot);
+    }
+
+    // to run the whole job on the job system
+    void runRange(const size_t, const size_t) {
+        run();
+    }
+
+    string commit() {
+        if (!m_isTreeRead)
+            return "";
+        {
+            StartupPhase phase("Scene upload");
+            for (size_t i = 0; i < m_models.size(); ++i)
+                m_scene->m_renderer->registerAndUploadModel(m_models[i]);
+            m_models.clear();
+
+            set<string>::const_iterator it = m_convexHullFiles.begin();
+            for (size_t i = 0; i < m_convexHulls.size(); ++i, ++it) {
+                string shapeId = COLLISION_SHAPE_CONVEX + " " + *it;
+                if (m_scene->m_physicsWorld->findCollisionShape(shapeId) == 0)
+                    m_scene->m_physicsWorld->registerCollisionShape(shapeId, m_convexHulls[i]);
+                else
+                    delete m_convexHulls[i];
+            }
+            m_convexHulls.clear();
+        }
+
+        StartupPhase phase("Scene entities");
+        m_isLoaded = m_scene->loadFromTree(m_fileName, m_tree);
+        return "";
+    }
+
+private:
+    Scene* m_scene;
+    string m_fileName;
+    ptree m_tree;
+    bool m_isTreeRead;
+    bool m_isLoaded;
+    set<string> m_modelFiles;
+    set<string> m_convexHullFiles;
+    vector<string> m_files;
+    vector<Model*> m_models;
+    vector<btCollisionShape*> m_convexHulls;
+
+    LoadSceneJob(const LoadSceneJob& rhs);
+    LoadSceneJob& operator=(const LoadSceneJob&);
+
+    // the model files come first in m_files, then the convex hull files
+    void loadFiles(const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (i < m_models.size()) {
+                StartupPhase phase("Scene model");
+                Model* model = new Model(RENDERABLEMESH_FILE_DESCRIPTION + " " + m_files[i]);
+                model->generateFromFile(m_files[i]);
+                m_models[i] = model;
+            }
+            else {
+                StartupPhase phase("Scene convex hull");
+                m_convexHulls[i - m_models.size()] = RigidBody::buildConvexHull(m_files[i]);
+            }
+        }
+    }
+
+    // the renderer and physics world caches belong to the main thread, so everything
+    // is generated here and whatever was already loaded gets discarded when committing
+    void findFiles(const ptree& tree) {
+        string description;
+        string file;
+        BOOST_FOREACH(const ptree::value_type& v, tree) {
+            if (v.first.compare(COMPONENT_RENDERABLEMESH) == 0) {
+                stringstream ss(v.second.get<string>(xmlPath(XML_ATTRIBUTE + XML_DELIMITER + XML_RENDERABLEMESH_MODEL), ""));
+                ss >> description >> file;
+                if (description.compare(RENDERABLEMESH_FILE_DESCRIPTION) == 0)
+                    m_modelFiles.insert(file);
+            }
+            else if (v.first.compare(COMPONENT_RIGIDBODY) == 0) {
+                stringstream ss(v.second.get<string>(xmlPath(XML_ATTRIBUTE + XML_DELIMITER + XML_RIGIDBODY_COLLISIONSHAPE), ""));
+                ss >> description >> file;
+                if (description.compare(COLLISION_SHAPE_CONVEX) == 0)
+                    m_convexHullFiles.insert(file);
+            }
+            else
+                findFiles(v.second);
+        }
+    }
+};
+
+
+// a scene read in the background by prefetchXML(), waiting for loadFromXML()
+LoadSceneJob* g_prefetchJob = 0;
+JobCounter g_prefetchCounter;
+
+
 Scene::Scene(const std::string& objectName,
              const std::string& rootNodeName,
              const ComponentFactory* componentFactory,
@@ -54,12 +219,18 @@ Scene::Scene(const std::string& objectName,
     m_rootName(rootNodeName),
     m_root(new Entity(0, m_rootName, m_device))
 {
-    registerCommand("save-xml", boost::bind(&Scene::cmdSaveXML, this, _1));
-    registerCommand("load-xml", boost::bind(&Scene::cmdLoadXML, this, _1));
+    registerCommand("save-xml", slot_t::fromMethod<Scene, &Scene::cmdSaveXML>(this));
+    registerAsyncCommand("load-xml", async_slot_t::fromMethod<Scene, &Scene::cmdLoadXML>(this));
 }
 
 Scene::~Scene() {
-    cout << "Removing all entities and their components from scene" << endl;
+    // a prefetch nobody loaded
+    if (g_prefetchJob != 0) {
+        JobSystem::wait(g_prefetchCounter);
+        delete g_prefetchJob;
+        g_prefetchJob = 0;
+    }
+    LogInfo() << "Removing all entities and their components from scene";
     m_root->removeAllChildren();
 
     unregisterAllCommands();
@@ -68,45 +239,41 @@ Scene::~Scene() {
 }
 
 void Scene::saveToXML(const string& fileName) const {
-    cout << "Saving scene to XML file: " << fileName << endl;
+    LogInfo() << "Saving scene to XML file: " << fileName;
     ptree tree;
     xml_writer_settings<char> settings(' ', 2);
     saveToPTree(XML_SCENE, tree, m_root);
     write_xml(fileName, tree, std::locale(), settings);
 }
 
-bool Scene::loadFromXML(const string& fileName) {
-    cout << "Loading scene from XML file: " << fileName << endl;
-    // success flags
-    set<string> names;
-    bool isCameraFound = false;
-
-    ifstream fin(fileName.c_str());
-    if (!fin.is_open() || !fin.good()) {
-        cerr << "Error: could not open file: " << fileName << endl;
-        return false;
+void Scene::prefetchXML(const string& fileName) {
+    if (g_prefetchJob != 0) {
+        LogWarning() << "Warning: already prefetching scene: " << g_prefetchJob->getFileName();
+        return;
     }
-    fin.close();
-
-    ptree tree;
-    read_xml(fileName, tree, xml_parser::trim_whitespace);
+    g_prefetchJob = new LoadSceneJob(0, fileName);
+    JobSystem::submit(job_slot_t::fromMethod<LoadSceneJob, &LoadSceneJob::runRange>(g_prefetchJob), 0, 1, &g_prefetchCounter);
+}
 
-    delete m_root;
-    m_root = new Entity(0, m_rootName, m_device);
-    if (!loadFromPTree(XML_SCENE + XML_DELIMITER + m_rootName, tree, m_root, 0, names, isCameraFound)) {
-        cerr << "Failed to load scene: " << fileName << endl;
-        delete m_root;
-        m_root = new Entity(0, m_rootName, m_device);
-        return false;
+bool Scene::loadFromXML(const string& fileName) {
+    if (g_prefetchJob != 0 && g_prefetchJob->getFileName() == fileName) {
+        {
+            StartupPhase phase("Scene prefetch wait");
+            JobSystem::wait(g_prefetchCounter);
+        }
+        LoadSceneJob* job = g_prefetchJob;
+        g_prefetchJob = 0;
+        job->setScene(this);
+        job->commit();
+        bool isLoaded = job->isLoaded();
+        delete job;
+        return isLoaded;
     }
 
-    if (!isCameraFound) {
-        cerr << "Error: no cameras found, aborting" << endl;
-        delete m_root;
-        m_root = new Entity(0, m_rootName, m_device);
+    ptree tree;
+    if (!readXML(fileName, tree))
         return false;
-    }
-    return true;
+    return loadFromTree(fileName, tree);
 }
 
 bool Scene::findEntity(const string& name, Entity*& entity) {
@@ -146,6 +313,44 @@ Scene& Scene::operator=(const Scene&) {
 
 
 
+bool Scene::readXML(const string& fileName, ptree& tree) {
+    TraceScope trace("Scene::readXML");
+    ifstream fin(fileName.c_str());
+    if (!fin.is_open() || !fin.good()) {
+        LogError() << "Error: could not open file: " << fileName;
+        return false;
+    }
+    fin.close();
+
+    read_xml(fileName, tree, xml_parser::trim_whitespace);
+    return true;
+}
+
+bool Scene::loadFromTree(const string& fileName, const ptree& tree) {
+    TraceScope trace("Scene::loadFromTree");
+    LogInfo() << "Loading scene from XML file: " << fileName;
+    // success flags
+    set<string> names;
+    bool isCameraFound = false;
+
+    delete m_root;
+    m_root = new Entity(0, m_rootName, m_device);
+    if (!loadFromPTree(XML_SCENE + XML_DELIMITER + m_rootName, tree, m_root, 0, names, isCameraFound)) {
+        LogError() << "Failed to load scene: " << fileName;
+        delete m_root;
+        m_root = new Entity(0, m_rootName, m_device);
+        return false;
+    }
+
+    if (!isCameraFound) {
+        LogError() << "Error: no cameras found, aborting";
+        delete m_root;
+        m_root = new Entity(0, m_rootName, m_device);
+        return false;
+    }
+    return true;
+}
+
 void Scene::saveToPTree(const string& path,
                         ptree& tree,
                         const Entity* node) const {
@@ -217,7 +422,7 @@ bool Scene::loadFromPTree(const string& path,
         type = tree.get<string>(ptree::path_type(attrPath + XML_ATTR_TYPE, XML_DELIMITER[0]), "empty");
         if (type.compare(XML_ATTR_TYPE_ENTITY) == 0) {
             if (names.find(name) != names.end()) {
-                cerr << "Error: ignoring repeated entity name: " << name << endl;
+                LogError() << "Error: ignoring repeated entity name: " << name;
                 continue;
             }
             else
@@ -233,15 +438,24 @@ bool Scene::loadFromPTree(const string& path,
             if (component != 0)
                 component->loadFromPtree(attrPath, tree);
             else
-                cerr << "Error: unknown component: " << name << endl;
+                LogError() << "Error: unknown component: " << name;
         }
         else if (type.compare(XML_ATTR_TYPE_ROOT) == 0)
-            cerr << "Error: invalid root node path: " << path << endl;
+            LogError() << "Error: invalid root node path: " << path;
         else if (name.compare(XML_COMMENT) == 0) {
             // ignore comment
         }
         else
-            cerr << "Error: unknown node type: " << type << " - " << curPath << endl;
+            LogError() << "Error: unknown node type: " << type << " - " << curPath;
     }
     return true;
 }
+
+
+
+string Scene::cmdLoadXML(deque<string>& args, AsyncJob*& job) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    job = new LoadSceneJob(this, args[0]);
+    return "";
+}
@@ -0,0 +1,527 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/scriptvm.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cmath>
+#include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/commandobject.hpp"
+#include "shoggoth-engine/kernel/objectselector.hpp"
+
+using namespace std;
+
+const size_t NO_EXPRESSION = size_t(-1);
+const size_t UNRESOLVED = size_t(-1);
+const size_t MAX_NUMBER_DIGITS = 32;
+
+bool isIdentifier(const string& word) {
+    if (word.empty() || !(isalpha(word[0]) || word[0] == '_'))
+        return false;
+    for (size_t i = 1; i < word.size(); ++i) {
+        if (!(isalnum(word[i]) || word[i] == '_'))
+            return false;
+    }
+    return true;
+}
+
+void skipSpaces(const string& text, size_t& i) {
+    while (i < text.size() && isspace(text[i]))
+        ++i;
+}
+
+ScriptVM::ScriptVM():
+    m_program(),
+    m_expressions(),
+    m_commands(),
+    m_variableSlots(),
+    m_variables(),
+    m_stack(),
+    m_arguments(),
+    m_name(),
+    m_output(),
+    m_totalCommands(0)
+{}
+
+bool ScriptVM::isProgram(const vector<string>& lines) {
+    vector<string> words;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        words.clear();
+        splitWords(lines[i], words);
+        if (words.empty())
+            continue;
+        if (isKeyword(words[0]))
+            return true;
+        for (size_t j = 0; j < words.size(); ++j) {
+            if (words[j].find(SCRIPT_FORMAT_BEGIN) != string::npos)
+                return true;
+        }
+    }
+    return false;
+}
+
+bool ScriptVM::compile(const vector<string>& lines, string& error) {
+    vector<size_t> loops;
+    vector<string> words;
+    m_program.clear();
+    m_expressions.clear();
+    m_commands.clear();
+    m_variableSlots.clear();
+    m_variables.clear();
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        words.clear();
+        splitWords(lines[i], words);
+        if (words.empty())
+            continue;
+
+        bool isCompiled = true;
+        if (words[0] == SCRIPT_SET && isKeyword(words[0])) {
+            instruction_t instruction = {INSTRUCTION_SET, 0, 0, 0, 0, 0};
+            string expression;
+            for (size_t j = 2; j < words.size(); ++j)
+                expression.append(words[j] + " ");
+            if (words.size() < 3 || !isIdentifier(words[1])) {
+                error = "expected \"set <variable> <expression>\"";
+                isCompiled = false;
+            }
+            else if ((isCompiled = compileExpression(expression, instruction.operand, error))) {
+                instruction.variable = addVariable(words[1]);
+                m_program.push_back(instruction);
+            }
+        }
+        else if (words[0] == SCRIPT_FOR && isKeyword(words[0])) {
+            size_t from, to, step;
+            if (words.size() < 4 || words.size() > 5 || !isIdentifier(words[1])) {
+                error = "expected \"for <variable> <from> <to> [step]\"";
+                isCompiled = false;
+            }
+            else if ((isCompiled = compileExpression(words[2], from, error) &&
+                                   compileExpression(words[3], to, error) &&
+                                   compileExpression(words.size() > 4? words[4] : "1", step, error))) {
+                instruction_t instruction = {INSTRUCTION_SET, addVariable(words[1]), from, 0, 0, 0};
+                m_program.push_back(instruction);
+                instruction.limit = addVariable("");
+                instruction.step = addVariable("");
+                instruction.variable = instruction.limit;
+                instruction.operand = to;
+                m_program.push_back(instruction);
+                instruction.variable = instruction.step;
+                instruction.operand = step;
+                m_program.push_back(instruction);
+                instruction.op = INSTRUCTION_LOOP_TEST;
+                instruction.variable = addVariable(words[1]);
+                loops.push_back(m_program.size());
+                m_program.push_back(instruction);
+            }
+        }
+        else if (words[0] == SCRIPT_END && isKeyword(words[0])) {
+            if (loops.empty()) {
+                error = "\"end\" without \"for\"";
+                isCompiled = false;
+            }
+            else {
+                instruction_t instruction = m_program[loops.back()];
+                instruction.op = INSTRUCTION_LOOP_STEP;
+                instruction.jump = loops.back();
+                m_program.push_back(instruction);
+                m_program[loops.back()].jump = m_program.size();
+                loops.pop_back();
+            }
+        }
+        else
+            isCompiled = compileCommand(words, error);
+
+        if (!isCompiled) {
+            error = "Error: " + error + ": " + lines[i];
+            return false;
+        }
+    }
+    if (!loops.empty()) {
+        error = "Error: \"for\" without \"end\"";
+        return false;
+    }
+    return true;
+}
+
+string ScriptVM::run() {
+    string output;
+    m_totalCommands = 0;
+    m_variables.assign(m_variables.size(), 0.0);
+    size_t pc = 0;
+    while (pc < m_program.size()) {
+        const instruction_t& instruction = m_program[pc];
+        switch (instruction.op) {
+        case INSTRUCTION_SET:
+            m_variables[instruction.variable] = evaluate(instruction.operand);
+            ++pc;
+            break;
+        case INSTRUCTION_LOOP_TEST: {
+            const double step = m_variables[instruction.step];
+            const double value = m_variables[instruction.variable];
+            const double limit = m_variables[instruction.limit];
+            if (step == 0.0) {
+                output.append("Error: \"for\" with a step of 0\n");
+                return output;
+            }
+            pc = (step > 0.0? value < limit : value > limit)? pc + 1 : instruction.jump;
+            break;
+        }
+        case INSTRUCTION_LOOP_STEP:
+            m_variables[instruction.variable] += m_variables[instruction.step];
+            pc = instruction.jump;
+            break;
+        case INSTRUCTION_COMMAND:
+            runCommand(m_commands[instruction.operand], output);
+            ++pc;
+            break;
+        default:
+            ++pc;
+        }
+    }
+    return output;
+}
+
+bool ScriptVM::isKeyword(const string& word) {
+    // an object can still be named like a keyword
+    if (word != SCRIPT_SET && word != SCRIPT_FOR && word != SCRIPT_END)
+        return false;
+    return !Terminal::ms_objectsTable.isToken(word);
+}
+
+void ScriptVM::splitWords(const string& line, vector<string>& words) {
+    // spaces inside {} belong to the expression
+    string word;
+    size_t depth = 0;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (depth == 0 && line[i] == COMMENT_CHAR)
+            break;
+        if (depth == 0 && isspace(line[i])) {
+            if (!word.empty())
+                words.push_back(word);
+            word.resize(0);
+            continue;
+        }
+        if (line[i] == SCRIPT_FORMAT_BEGIN)
+            ++depth;
+        else if (line[i] == SCRIPT_FORMAT_END && depth > 0)
+            --depth;
+        word.push_back(line[i]);
+    }
+    if (!word.empty())
+        words.push_back(word);
+}
+
+size_t ScriptVM::addVariable(const string& name) {
+    // unnamed variables hold the limit and step of loops
+    if (!name.empty()) {
+        map<string, size_t>::const_iterator it = m_variableSlots.find(name);
+        if (it != m_variableSlots.end())
+            return it->second;
+        m_variableSlots.insert(pair<string, size_t>(name, m_variables.size()));
+    }
+    m_variables.push_back(0.0);
+    return m_variables.size() - 1;
+}
+
+size_t ScriptVM::addExpression(const expression_t& expression) {
+    m_expressions.push_back(expression);
+    return m_expressions.size() - 1;
+}
+
+bool ScriptVM::compileExpression(const string& text, size_t& expression, string& error) {
+    expression_t compiled;
+    size_t i = 0;
+    if (!parseSum(text, i, compiled, error))
+        return false;
+    skipSpaces(text, i);
+    if (i < text.size()) {
+        error = "unexpected \"" + text.substr(i) + "\" in expression";
+        return false;
+    }
+    expression = addExpression(compiled);
+    return true;
+}
+
+bool ScriptVM::parseSum(const string& text, size_t& i, expression_t& expression, string& error) {
+    if (!parseProduct(text, i, expression, error))
+        return false;
+    skipSpaces(text, i);
+    while (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+        expression_item_t item = {text[i] == '+'? EXPRESSION_ADD : EXPRESSION_SUBTRACT, 0.0, 0};
+        ++i;
+        if (!parseProduct(text, i, expression, error))
+            return false;
+        expression.push_back(item);
+        skipSpaces(text, i);
+    }
+    return true;
+}
+
+bool ScriptVM::parseProduct(const string& text, size_t& i, expression_t& expression, string& error) {
+    if (!parseFactor(text, i, expression, error))
+        return false;
+    skipSpaces(text, i);
+    while (i < text.size() && (text[i] == '*' || text[i] == '/' || text[i] == '%')) {
+        expression_item_t item = {EXPRESSION_MULTIPLY, 0.0, 0};
+        if (text[i] == '/')
+            item.op = EXPRESSION_DIVIDE;
+        else if (text[i] == '%')
+            item.op = EXPRESSION_MODULO;
+        ++i;
+        if (!parseFactor(text, i, expression, error))
+            return false;
+        expression.push_back(item);
+        skipSpaces(text, i);
+    }
+    return true;
+}
+
+bool ScriptVM::parseFactor(const string& text, size_t& i, expression_t& expression, string& error) {
+    skipSpaces(text, i);
+    if (i >= text.size()) {
+        error = "incomplete expression";
+        return false;
+    }
+    if (text[i] == '(') {
+        ++i;
+        if (!parseSum(text, i, expression, error))
+            return false;
+        skipSpaces(text, i);
+        if (i >= text.size() || text[i] != ')') {
+            error = "missing \")\" in expression";
+            return false;
+        }
+        ++i;
+        return true;
+    }
+    if (text[i] == '-' || text[i] == '+') {
+        const bool isNegated = text[i] == '-';
+        ++i;
+        if (!parseFactor(text, i, expression, error))
+            return false;
+        if (isNegated) {
+            expression_item_t item = {EXPRESSION_NEGATE, 0.0, 0};
+            expression.push_back(item);
+        }
+        return true;
+    }
+    if (isdigit(text[i]) || text[i] == '.') {
+        const char* begin = text.c_str() + i;
+        char* end;
+        expression_item_t item = {EXPRESSION_NUMBER, strtod(begin, &end), 0};
+        if (end == begin) {
+            error = "invalid number in expression";
+            return false;
+        }
+        i += size_t(end - begin);
+        expression.push_back(item);
+        return true;
+    }
+    size_t length = 0;
+    while (i + length < text.size() && (isalnum(text[i + length]) || text[i + length] == '_'))
+        ++length;
+    const string name = text.substr(i, length);
+    map<string, size_t>::const_iterator it = m_variableSlots.find(name);
+    if (length == 0 || it == m_variableSlots.end()) {
+        error = length == 0? "unexpected \"" + text.substr(i) + "\" in expression" : "unknown variable \"" + name + "\"";
+        return false;
+    }
+    expression_item_t item = {EXPRESSION_VARIABLE, 0.0, it->second};
+    expression.push_back(item);
+    i += length;
+    return true;
+}
+
+bool ScriptVM::compileText(const string& word, text_t& text, string& error) {
+    text_part_t part = {"", NO_EXPRESSION};
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (word[i] != SCRIPT_FORMAT_BEGIN) {
+            part.literal.push_back(word[i]);
+            continue;
+        }
+        const size_t end = word.find(SCRIPT_FORMAT_END, i);
+        if (end == string::npos) {
+            error = "missing \"}\"";
+            return false;
+        }
+        if (!part.literal.empty()) {
+            text.push_back(part);
+            part.literal.resize(0);
+        }
+        text_part_t formatted = {"", NO_EXPRESSION};
+        if (!compileExpression(word.substr(i + 1, end - i - 1), formatted.expression, error))
+            return false;
+        text.push_back(formatted);
+        i = end;
+    }
+    if (!part.literal.empty() || text.empty())
+        text.push_back(part);
+    return true;
+}
+
+bool ScriptVM::compileCommand(const vector<string>& words, string& error) {
+    if (words.size() < 2) {
+        error = "expected \"<object> <command> [arguments]\"";
+        return false;
+    }
+    script_command_t cmd = {text_t(), text_t(), vector<text_t>(words.size() - 2), 0, 0, UNRESOLVED, false};
+    if (!compileText(words[0], cmd.object, error) || !compileText(words[1], cmd.command, error))
+        return false;
+    for (size_t i = 2; i < words.size(); ++i) {
+        if (!compileText(words[i], cmd.arguments[i - 2], error))
+            return false;
+    }
+    instruction_t instruction = {INSTRUCTION_COMMAND, 0, m_commands.size(), 0, 0, 0};
+    m_commands.push_back(cmd);
+    m_program.push_back(instruction);
+    return true;
+}
+
+double ScriptVM::evaluate(const size_t expression) {
+    const expression_t& items = m_expressions[expression];
+    m_stack.resize(0);
+    for (size_t i = 0; i < items.size(); ++i) {
+        const expression_op_t op = items[i].op;
+        double rhs = 0.0;
+        if (op != EXPRESSION_NUMBER && op != EXPRESSION_VARIABLE && op != EXPRESSION_NEGATE) {
+            rhs = m_stack.back();
+            m_stack.pop_back();
+        }
+        switch (op) {
+        case EXPRESSION_NUMBER:
+            m_stack.push_back(items[i].number);
+            break;
+        case EXPRESSION_VARIABLE:
+            m_stack.push_back(m_variables[items[i].variable]);
+            break;
+        case EXPRESSION_ADD:
+            m_stack.back() += rhs;
+            break;
+        case EXPRESSION_SUBTRACT:
+            m_stack.back() -= rhs;
+            break;
+        case EXPRESSION_MULTIPLY:
+            m_stack.back() *= rhs;
+            break;
+        case EXPRESSION_DIVIDE:
+            m_stack.back() /= rhs;
+            break;
+        case EXPRESSION_MODULO:
+            m_stack.back() = fmod(m_stack.back(), rhs);
+            break;
+        case EXPRESSION_NEGATE:
+            m_stack.back() = -m_stack.back();
+            break;
+        default:
+            break;
+        }
+    }
+    return m_stack.back();
+}
+
+void ScriptVM::format(const text_t& text, string& str) {
+    char number[MAX_NUMBER_DIGITS];
+    str.resize(0);
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i].expression == NO_EXPRESSION)
+            str.append(text[i].literal);
+        else {
+            // adding 0 turns -0 into 0
+            snprintf(number, sizeof(number), "%.15g", evaluate(text[i].expression) + 0.0);
+            str.append(number);
+        }
+    }
+}
+
+bool ScriptVM::resolve(script_command_t& cmd, CommandObject*& object, string& output) {
+    // names without expressions are looked up again only when objects were created or deleted
+    const size_t generation = ObjectSelector::getGeneration();
+    if (cmd.generation == generation)
+        return cmd.isSelection || Terminal::getObject(cmd.idObject, object);
+
+    format(cmd.command, m_name);
+    if (!Terminal::ms_commandsTable.isToken(m_name)) {
+        output.append("Error: command not found: " + m_name + "\n");
+        return false;
+    }
+    Terminal::ms_commandsTable.findId(cmd.idCommand, m_name);
+
+    format(cmd.object, m_name);
+    cmd.isSelection = ObjectSelector::isSelector(m_name) && !Terminal::ms_objectsTable.isToken(m_name);
+    if (!cmd.isSelection) {
+        if (!Terminal::ms_objectsTable.isToken(m_name)) {
+            output.append("Error: object not found: " + m_name + "\n");
+            return false;
+        }
+        Terminal::ms_objectsTable.findId(cmd.idObject, m_name);
+        if (!Terminal::getObject(cmd.idObject, object))
+            return false;
+    }
+
+    const bool isLiteral = cmd.object.size() == 1 && cmd.object[0].expression == NO_EXPRESSION &&
+                           cmd.command.size() == 1 && cmd.command[0].expression == NO_EXPRESSION;
+    cmd.generation = isLiteral? generation : UNRESOLVED;
+    return true;
+}
+
+void ScriptVM::runCommand(script_command_t& cmd, string& output) {
+    CommandObject* object = 0;
+    if (!resolve(cmd, object, output))
+        return;
+
+    m_arguments.resize(cmd.arguments.size());
+    for (size_t i = 0; i < cmd.arguments.size(); ++i)
+        format(cmd.arguments[i], m_arguments[i]);
+    m_output.resize(0);
+    ++m_totalCommands;
+    if (cmd.isSelection) {
+        format(cmd.object, m_name);
+        ObjectSelector::runCommand(m_name, cmd.idCommand, m_arguments, m_output);
+    }
+    else
+        object->runObjectCommand(cmd.idCommand, m_arguments, m_output);
+    if (m_output.empty())
+        return;
+
+    // the command is only written out when it has something to say
+    output.append("> ");
+    format(cmd.object, m_name);
+    output.append(m_name);
+    output.push_back(' ');
+    format(cmd.command, m_name);
+    output.append(m_name);
+    for (size_t i = 0; i < cmd.arguments.size(); ++i) {
+        format(cmd.arguments[i], m_name);
+        output.push_back(' ');
+        output.append(m_name);
+    }
+    output.push_back('\n');
+    output.append(m_output);
+    output.push_back('\n');
+}
@@ -0,0 +1,130 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/simulationloop.hpp"
+
+#include <sstream>
+#include "shoggoth-engine/common/clock.hpp"
+#include "shoggoth-engine/kernel/entity.hpp"
+
+using namespace std;
+
+SimulationLoop::SimulationLoop(const string& objectName):
+    CommandObject(objectName),
+    m_timestep(0),
+    m_accumulator(0),
+    m_lastTime(0),
+    m_maxCatchUpSteps(DEFAULT_MAX_CATCH_UP_STEPS),
+    m_frameSteps(0),
+    m_isStepping(false),
+    m_totalSteps(0),
+    m_droppedSteps(0)
+{
+    registerCommand("stats", slot_t::fromMethod<SimulationLoop, &SimulationLoop::cmdStats>(this));
+    registerAttribute("update-rate", slot_t::fromMethod<SimulationLoop, &SimulationLoop::cmdUpdateRate>(this));
+    registerAttribute("max-catch-up-steps", slot_t::fromMethod<SimulationLoop, &SimulationLoop::cmdMaxCatchUpSteps>(this));
+
+    setUpdateRate(DEFAULT_UPDATE_RATE);
+}
+
+SimulationLoop::~SimulationLoop() {
+    unregisterAllCommands();
+    unregisterAllAttributes();
+}
+
+void SimulationLoop::setUpdateRate(const double updateRate) {
+    if (updateRate >= MIN_UPDATE_RATE && updateRate <= MAX_UPDATE_RATE)
+        m_timestep = boost::uint64_t(1.0e9 / updateRate);
+}
+
+void SimulationLoop::reset() {
+    m_accumulator = 0;
+    m_lastTime = 0;
+}
+
+void SimulationLoop::beginFrame() {
+    // the first frame after a reset only starts the clock
+    boost::uint64_t now = Clock::nanoseconds();
+    advance(m_lastTime != 0? now - m_lastTime : 0);
+    m_lastTime = now;
+}
+
+void SimulationLoop::advance(const boost::uint64_t nanoseconds) {
+    m_accumulator += nanoseconds;
+    m_frameSteps = 0;
+}
+
+bool SimulationLoop::step() {
+    if (m_isStepping) {
+        Entity::endSimulationStep();
+        m_isStepping = false;
+    }
+    if (m_accumulator < m_timestep)
+        return false;
+    if (m_frameSteps >= m_maxCatchUpSteps) {
+        // too far behind, keep only the fraction of a step so interpolation stays smooth
+        m_droppedSteps += m_accumulator / m_timestep;
+        m_accumulator %= m_timestep;
+        return false;
+    }
+    m_accumulator -= m_timestep;
+    ++m_frameSteps;
+    ++m_totalSteps;
+    Entity::beginSimulationStep();
+    m_isStepping = true;
+    return true;
+}
+
+
+
+string SimulationLoop::cmdUpdateRate(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    double updateRate = boost::lexical_cast<double>(args[0]);
+    if (updateRate <= 0.0)
+        return "Error: update rate must be positive";
+    if (updateRate < MIN_UPDATE_RATE)
+        return "Error: update rate too low, the timestep would be over 1000 s";
+    if (updateRate > MAX_UPDATE_RATE)
+        return "Error: update rate too high, the timestep would be under 1 ns";
+    setUpdateRate(updateRate);
+    return "";
+}
+
+string SimulationLoop::cmdMaxCatchUpSteps(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    setMaxCatchUpSteps(boost::lexical_cast<size_t>(args[0]));
+    return "";
+}
+
+string SimulationLoop::cmdStats(deque<string>&) {
+    stringstream ss;
+    ss << "Update rate: " << 1.0 / getTimestep() << " Hz, "
+       << "steps: " << m_totalSteps << ", "
+       << "dropped: " << m_droppedSteps;
+    return ss.str();
+}
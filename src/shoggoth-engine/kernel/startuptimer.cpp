@@ -0,0 +1,116 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/startuptimer.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+const size_t PHASE_NAME_WIDTH = 28;
+
+boost::uint64_t StartupTimer::ms_startTime = 0;
+boost::uint64_t StartupTimer::ms_finishTime = 0;
+boost::thread::id StartupTimer::ms_mainThreadId;
+boost::mutex StartupTimer::ms_phasesMutex;
+vector<StartupTimer::startup_phase_t> StartupTimer::ms_phases = vector<StartupTimer::startup_phase_t>();
+
+
+void StartupTimer::start() {
+    boost::lock_guard<boost::mutex> lock(ms_phasesMutex);
+    if (ms_startTime != 0)
+        return;
+    ms_startTime = Clock::nanoseconds();
+    ms_mainThreadId = boost::this_thread::get_id();
+}
+
+void StartupTimer::finish() {
+    boost::lock_guard<boost::mutex> lock(ms_phasesMutex);
+    if (ms_finishTime == 0)
+        ms_finishTime = Clock::nanoseconds();
+}
+
+bool StartupTimer::isFinished() {
+    boost::lock_guard<boost::mutex> lock(ms_phasesMutex);
+    return ms_finishTime != 0;
+}
+
+boost::uint64_t StartupTimer::getTimeToFirstFrame() {
+    boost::lock_guard<boost::mutex> lock(ms_phasesMutex);
+    return ms_finishTime != 0? ms_finishTime - ms_startTime : 0;
+}
+
+string StartupTimer::report() {
+    boost::lock_guard<boost::mutex> lock(ms_phasesMutex);
+    vector<startup_phase_t> phases(ms_phases);
+    sort(phases.begin(), phases.end(), comparePhases);
+
+    stringstream ss;
+    ss << fixed << setprecision(1);
+    if (ms_finishTime != 0)
+        ss << "Startup, first frame after " << double(ms_finishTime - ms_startTime) * 1.0e-6 << " ms" << endl;
+    else
+        ss << "Startup, no frame yet" << endl;
+    ss << "  " << left << setw(int(PHASE_NAME_WIDTH)) << "phase" << right
+       << setw(8) << "thread" << setw(12) << "start ms" << setw(12) << "time ms" << endl;
+
+    boost::uint64_t mainThreadTime = 0;
+    boost::uint64_t workerTime = 0;
+    for (size_t i = 0; i < phases.size(); ++i) {
+        boost::uint64_t time = phases[i].end - phases[i].begin;
+        ss << "  " << left << setw(int(PHASE_NAME_WIDTH)) << phases[i].name << right
+           << setw(8) << (phases[i].isMainThread? "main" : "worker")
+           << setw(12) << double(phases[i].begin - ms_startTime) * 1.0e-6
+           << setw(12) << double(time) * 1.0e-6 << endl;
+        // nested phases are counted twice, the markers are kept to the top level
+        if (phases[i].isMainThread)
+            mainThreadTime += time;
+        else
+            workerTime += time;
+    }
+    ss << "  main thread phases " << double(mainThreadTime) * 1.0e-6 << " ms, worker phases "
+       << double(workerTime) * 1.0e-6 << " ms" << endl;
+    return ss.str();
+}
+
+void StartupTimer::record(const char* name, const boost::uint64_t begin, const boost::uint64_t end) {
+    boost::lock_guard<boost::mutex> lock(ms_phasesMutex);
+    if (ms_finishTime != 0)
+        return;
+    // without start() the timer starts with the first phase
+    if (ms_startTime == 0) {
+        ms_startTime = begin;
+        ms_mainThreadId = boost::this_thread::get_id();
+    }
+    startup_phase_t phase = {name, boost::this_thread::get_id() == ms_mainThreadId, max(begin, ms_startTime), end};
+    ms_phases.push_back(phase);
+}
+
+bool StartupTimer::comparePhases(const startup_phase_t& lhs, const startup_phase_t& rhs) {
+    return lhs.begin < rhs.begin;
+}
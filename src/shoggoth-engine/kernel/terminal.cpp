@@ -26,10 +26,19 @@
 
 #include "shoggoth-engine/kernel/terminal.hpp"
 
-#include <iostream>
 #include <fstream>
 #include <sstream>
-#include "shoggoth-engine/kernel/commandobject.hpp"
+#include <map>
+#include "shoggoth-engine/kernel/binaryscript.hpp"
+#include "shoggoth-engine/kernel/asyncqueue.hpp"
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+#include "shoggoth-engine/kernel/commandserver.hpp"
+#include "shoggoth-engine/kernel/objectselector.hpp"
+#include "shoggoth-engine/kernel/scriptvm.hpp"
+#include "shoggoth-engine/kernel/inputlatency.hpp"
+#include "shoggoth-engine/kernel/frametimer.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
@@ -37,7 +46,18 @@ TokenTable Terminal::ms_objectsTable = TokenTable();
 TokenTable Terminal::ms_commandsTable = TokenTable();
 TokenTable Terminal::ms_attributesTable = TokenTable();
 Terminal::obj_ptr_table_t Terminal:: ms_objectPointersTable = obj_ptr_table_t();
-deque<string> Terminal::ms_commandsQueue = deque<string>();
+Terminal::command_queue_t Terminal::ms_commandsQueue = command_queue_t();
+Terminal::command_queue_t Terminal::ms_runningQueue = command_queue_t();
+Command Terminal::ms_queuedCommand = Command();
+boost::uint64_t Terminal::ms_runningInputTime = 0;
+bool Terminal::ms_isCommandCoalescingEnabled = false;
+size_t Terminal::ms_frame = 0;
+BinaryScriptWriter* Terminal::ms_recorder = 0;
+string Terminal::ms_recordingFileName = string();
+size_t Terminal::ms_recordingFirstFrame = 0;
+BinaryScript* Terminal::ms_replay = 0;
+size_t Terminal::ms_replayFirstFrame = 0;
+size_t Terminal::ms_replayCommand = 0;
 
 enum token_state_t {
     TOKEN_OBJECT,
@@ -69,28 +89,54 @@ void parse(const string& expression, size_t& i, string& token, token_state_t& cu
 
 
 const std::string Terminal::getObjectName(const size_t idObject) {
-    return ms_objectPointersTable[idObject]->getObjectName();
+    CommandObject* object;
+    if (getObject(idObject, object))
+        return object->getObjectName();
+    return string();
 }
 
 void Terminal::pushCommand(const string& cmd) {
-    ms_commandsQueue.push_back(cmd);
+    // commands pushed by a command caused by an input are caused by that input too
+    queued_command_t queued = {string(), 0, ms_runningInputTime};
+    ms_commandsQueue.push_back(queued);
+    ms_commandsQueue.back().expression = cmd;
+}
+
+void Terminal::pushBoundCommand(const Command& cmd, const boost::uint64_t inputTime) {
+    // the queues keep their capacity between frames, so this doesn't allocate
+    queued_command_t queued = {string(), &cmd, inputTime};
+    ms_commandsQueue.push_back(queued);
+}
+
+void Terminal::cancelBoundCommands() {
+    // called before bound commands are destroyed, the queue may be running
+    for (size_t i = 0; i < ms_commandsQueue.size(); ++i)
+        ms_commandsQueue[i].bound = 0;
+    for (size_t i = 0; i < ms_runningQueue.size(); ++i)
+        ms_runningQueue[i].bound = 0;
 }
 
 string Terminal::runScript(const string& fileName) {
-    string expression;
-    Command cmd;
-    deque<Command> commands;
-    stringstream output;
+    if (BinaryScript::isBinaryScript(fileName))
+        return runBinaryScript(fileName);
 
-    // read script
-    fstream file(fileName.c_str(), ios::in);
-    while (file.good()) {
-        getline(file, expression);
-        if (!expression.empty() && cmd.parseCommand(expression)) {
-            commands.push_back(cmd);
-        }
+    vector<string> lines;
+    readScriptLines(fileName, lines);
+    return runScriptLines(lines);
+}
+
+string Terminal::runScriptLines(const vector<string>& lines) {
+    if (ScriptVM::isProgram(lines)) {
+        ScriptVM vm;
+        string error;
+        if (!vm.compile(lines, error))
+            return error + "\n";
+        return vm.run();
     }
-    file.close();
+
+    deque<Command> commands;
+    stringstream output;
+    parseScript(lines, commands);
 
     // run commands
     for (size_t i = 0; i < commands.size(); ++i) {
@@ -101,17 +147,138 @@ string Terminal::runScript(const string& fileName) {
     return output.str();
 }
 
-string Terminal::processCommandsQueue() {
+string Terminal::runBatch(const vector<string>& lines, size_t& totalCommands) {
+    // unlike scripts, only the outputs are returned, and commands that can't be parsed are reported
     string output;
     Command cmd;
-    while (!ms_commandsQueue.empty()) {
-        if (cmd.parseCommand(ms_commandsQueue.front()) && cmd.run() && !cmd.getOutput().empty())
-            output.append(cmd.getOutput() + "\n");
-        ms_commandsQueue.pop_front();
+    totalCommands = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (cmd.parseCommand(lines[i])) {
+            recordCommand(cmd);
+            ++totalCommands;
+            if (cmd.run() && !cmd.getOutput().empty())
+                output.append(cmd.getOutput() + "\n");
+        }
+        else if (lines[i][0] != COMMENT_CHAR)
+            output.append("Error: invalid command: " + lines[i] + "\n");
     }
     return output;
 }
 
+string Terminal::runBinaryScript(const string& fileName) {
+    BinaryScript script;
+    Command cmd;
+    stringstream output;
+
+    if (!script.load(fileName))
+        return "";
+    for (size_t i = 0; i < script.getTotalCommands(); ++i) {
+        if (script.getCommand(i, cmd)) {
+            output << "> " << cmd << endl;
+            if (cmd.run() && !cmd.getOutput().empty())
+                output << cmd.getOutput() << endl;
+        }
+    }
+    return output.str();
+}
+
+string Terminal::compileScript(const string& fileName, const string& binaryFileName) {
+    vector<string> lines;
+    deque<Command> commands;
+    BinaryScriptWriter writer;
+
+    readScriptLines(fileName, lines);
+    if (ScriptVM::isProgram(lines))
+        return "Error: scripts with variables or loops can't be compiled: " + fileName;
+    parseScript(lines, commands);
+    for (size_t i = 0; i < commands.size(); ++i)
+        writer.appendCommand(commands[i]);
+    if (!writer.save(binaryFileName))
+        return "Error: could not save " + binaryFileName;
+    return boost::lexical_cast<string>(writer.getTotalCommands()) + " commands compiled into " + binaryFileName;
+}
+
+bool Terminal::startRecording(const string& fileName) {
+    if (ms_recorder != 0 || ms_replay != 0)
+        return false;
+    ms_recorder = new BinaryScriptWriter;
+    ms_recordingFileName = fileName;
+    ms_recordingFirstFrame = ms_frame;
+    return true;
+}
+
+bool Terminal::stopRecording() {
+    if (ms_recorder == 0)
+        return false;
+    bool isSaved = ms_recorder->save(ms_recordingFileName);
+    delete ms_recorder;
+    ms_recorder = 0;
+    return isSaved;
+}
+
+bool Terminal::startReplay(const string& fileName) {
+    if (ms_recorder != 0 || ms_replay != 0)
+        return false;
+    ms_replay = new BinaryScript;
+    if (!ms_replay->load(fileName)) {
+        stopReplay();
+        return false;
+    }
+    ms_replayFirstFrame = ms_frame;
+    ms_replayCommand = 0;
+    return true;
+}
+
+void Terminal::stopReplay() {
+    delete ms_replay;
+    ms_replay = 0;
+}
+
+string Terminal::processCommandsQueue() {
+    TraceScope trace("Terminal::processCommandsQueue");
+    FrameTimer::beginPhase(FRAME_PHASE_COMMANDS);
+    // async results and remote batches first, so the commands they push run on this frame
+    string output = AsyncQueue::commitFinishedJobs();
+    JobSystem::runMainThreadJobs();
+    CommandServer::poll();
+    if (ms_replay != 0)
+        output.append(processReplayFrame());
+    else if (ms_isCommandCoalescingEnabled) {
+        // commands pushed while running the merged ones are coalesced on the next pass
+        deque<Command> commands;
+        deque<boost::uint64_t> inputTimes;
+        while (!ms_commandsQueue.empty()) {
+            coalesceCommandsQueue(commands, inputTimes);
+            for (size_t i = 0; i < commands.size(); ++i) {
+                recordCommand(commands[i]);
+                ms_runningInputTime = inputTimes[i];
+                if (commands[i].run() && !commands[i].getOutput().empty())
+                    output.append(commands[i].getOutput() + "\n");
+                ms_runningInputTime = 0;
+            }
+        }
+    }
+    else {
+        // commands pushed while running the queue are run on the next pass, still on this frame
+        while (!ms_commandsQueue.empty()) {
+            ms_runningQueue.swap(ms_commandsQueue);
+            for (size_t i = 0; i < ms_runningQueue.size(); ++i) {
+                if (takeQueuedCommand(ms_runningQueue[i], ms_queuedCommand)) {
+                    recordCommand(ms_queuedCommand);
+                    ms_runningInputTime = ms_runningQueue[i].inputTime;
+                    if (ms_queuedCommand.run() && !ms_queuedCommand.getOutput().empty())
+                        output.append(ms_queuedCommand.getOutput() + "\n");
+                    ms_runningInputTime = 0;
+                }
+            }
+            ms_runningQueue.clear();
+        }
+    }
+    ++ms_frame;
+    FrameTimer::endPhase(FRAME_PHASE_COMMANDS);
+    return output;
+}
+
 vector<string> Terminal::generateObjectsList(const bool shouldIncludeId) {
     return ms_objectsTable.generateList(shouldIncludeId);
 }
@@ -147,7 +314,7 @@ vector<string> Terminal::generateAutocompleteList(const std::string& expression)
             parse(expression, i, arguments, tokenState, TOKEN_ARGUMENTS);
             break;
         default:
-            cerr << "Invalid token state: " << tokenState << endl;
+            LogError() << "Invalid token state: " << tokenState;
         }
         ++i;
     }
@@ -168,9 +335,29 @@ vector<string> Terminal::generateAutocompleteList(const std::string& expression)
 
 
 
+void Terminal::readScriptLines(const string& fileName, vector<string>& lines) {
+    string expression;
+    fstream file(fileName.c_str(), ios::in);
+    while (file.good()) {
+        getline(file, expression);
+        if (!expression.empty())
+            lines.push_back(expression);
+    }
+    file.close();
+}
+
+void Terminal::parseScript(const vector<string>& lines, deque<Command>& commands) {
+    Command cmd;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (cmd.parseCommand(lines[i]))
+            commands.push_back(cmd);
+    }
+}
+
 size_t Terminal::registerObject(const std::string& objectName, CommandObject* obj) {
     size_t id = ms_objectsTable.registerToken(objectName);
     ms_objectPointersTable.insert(pair<size_t, CommandObject*>(id, obj));
+    ObjectSelector::invalidate();
     return id;
 }
 
@@ -181,9 +368,113 @@ void Terminal::unregisterObject(const std::string& objectName) {
     if (it != ms_objectPointersTable.end()) {
         ms_objectsTable.unregisterToken(objectName);
         ms_objectPointersTable.erase(it);
+        ObjectSelector::invalidate();
     }
 }
 
+bool Terminal::takeQueuedCommand(const queued_command_t& queued, Command& cmd) {
+    if (queued.bound != 0)
+        cmd = *queued.bound;
+    else if (queued.expression.empty())
+        return false; // cancelled bound command
+    else if (!cmd.parseCommand(queued.expression))
+        return false;
+    InputLatency::onCommand(queued.inputTime);
+    return true;
+}
+
+void Terminal::coalesceCommandsQueue(deque<Command>& commands, deque<boost::uint64_t>& inputTimes) {
+    // A command is only merged into the last command queued for the same object,
+    // so anything else done to that object in between keeps its order.
+    // Commands that can't be coalesced may read any state, so they act as a barrier.
+    // A merged command keeps the earliest input time of the commands it replaces.
+    map<size_t, size_t> lastCommandIndex;
+    map<size_t, size_t>::iterator it;
+    CommandObject* object;
+    Command cmd;
+
+    commands.clear();
+    inputTimes.clear();
+    ms_runningQueue.swap(ms_commandsQueue);
+    for (size_t i = 0; i < ms_runningQueue.size(); ++i) {
+        if (takeQueuedCommand(ms_runningQueue[i], cmd)) {
+            const boost::uint64_t inputTime = ms_runningQueue[i].inputTime;
+            coalesce_t coalescing = COALESCE_NONE;
+            if (getObject(cmd.m_idObject, object))
+                coalescing = object->getCoalescing(cmd.m_idCommand);
+
+            if (coalescing == COALESCE_NONE) {
+                lastCommandIndex.clear();
+                commands.push_back(cmd);
+                inputTimes.push_back(inputTime);
+            }
+            else {
+                it = lastCommandIndex.find(cmd.m_idObject);
+                if (it == lastCommandIndex.end() || !mergeCommands(commands[it->second], cmd, coalescing)) {
+                    lastCommandIndex[cmd.m_idObject] = commands.size();
+                    commands.push_back(cmd);
+                    inputTimes.push_back(inputTime);
+                }
+                else if (inputTime != 0 && (inputTimes[it->second] == 0 || inputTime < inputTimes[it->second]))
+                    inputTimes[it->second] = inputTime;
+            }
+        }
+    }
+    ms_runningQueue.clear();
+}
+
+bool Terminal::mergeCommands(Command& target, const Command& cmd, const coalesce_t coalescing) {
+    if (target.m_idCommand != cmd.m_idCommand || target.m_arguments.size() != cmd.m_arguments.size())
+        return false;
+
+    switch (coalescing) {
+    case COALESCE_SUM: {
+        vector<double> sums(cmd.m_arguments.size());
+        double lhs, rhs;
+        for (size_t i = 0; i < sums.size(); ++i) {
+            if (!target.getArgumentAsNumber(i, lhs) || !cmd.getArgumentAsNumber(i, rhs))
+                return false;
+            sums[i] = lhs + rhs;
+        }
+        for (size_t i = 0; i < sums.size(); ++i)
+            target.m_arguments[i] = boost::lexical_cast<string>(sums[i]);
+        return true; }
+    case COALESCE_LAST:
+        // "set" commands: the first argument is the attribute being set
+        if (target.getArgument(0) != cmd.getArgument(0))
+            return false;
+        target.m_arguments = cmd.m_arguments;
+        return true;
+    case COALESCE_NONE:
+        return false;
+    default:
+        LogError() << "Invalid coalesce_t: " << coalescing;
+    }
+    return false;
+}
+
+void Terminal::recordCommand(const Command& cmd) {
+    if (ms_recorder != 0)
+        ms_recorder->appendCommand(cmd, ms_frame - ms_recordingFirstFrame);
+}
+
+string Terminal::processReplayFrame() {
+    // The replay already holds every command that ran on each frame, including the ones
+    // pushed by other commands, so anything queued meanwhile is dropped
+    string output;
+    Command cmd;
+    size_t frame = ms_frame - ms_replayFirstFrame;
+    ms_commandsQueue.clear();
+    for (; ms_replayCommand < ms_replay->getTotalCommands() && ms_replay->getFrame(ms_replayCommand) <= frame; ++ms_replayCommand) {
+        if (ms_replay->getCommand(ms_replayCommand, cmd) && cmd.run() && !cmd.getOutput().empty())
+            output.append(cmd.getOutput() + "\n");
+        ms_commandsQueue.clear();
+    }
+    if (ms_replayCommand >= ms_replay->getTotalCommands())
+        stopReplay();
+    return output;
+}
+
 vector<string> Terminal::generateAutocompleteObjectList(const string& object) {
     return ms_objectsTable.autocompleteList(object);
 }
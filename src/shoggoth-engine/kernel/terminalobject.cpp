@@ -0,0 +1,238 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/terminalobject.hpp"
+
+#include "shoggoth-engine/kernel/terminal.hpp"
+#include "shoggoth-engine/kernel/commandprofiler.hpp"
+#include "shoggoth-engine/kernel/inputlatency.hpp"
+#include "shoggoth-engine/kernel/frametimer.hpp"
+#include "shoggoth-engine/kernel/framearena.hpp"
+#include "shoggoth-engine/kernel/asyncqueue.hpp"
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+#include "shoggoth-engine/kernel/commandserver.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
+#include "shoggoth-engine/kernel/startuptimer.hpp"
+
+using namespace std;
+
+const size_t DEFAULT_STATS_ENTRIES = 10;
+
+TerminalObject::TerminalObject(const string& objectName):
+    CommandObject(objectName)
+{
+    registerCommand("compile-script", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdCompileScript>(this));
+    registerCommand("stats", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdStats>(this));
+    registerCommand("stats-reset", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdStatsReset>(this));
+    registerCommand("stats-csv", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdStatsCsv>(this));
+    registerCommand("latency", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdLatency>(this));
+    registerCommand("latency-reset", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdLatencyReset>(this));
+    registerCommand("frame-times", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdFrameTimes>(this));
+    registerCommand("frame-times-reset", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdFrameTimesReset>(this));
+    registerCommand("frame-times-csv", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdFrameTimesCsv>(this));
+    registerCommand("frame-arena", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdFrameArena>(this));
+    registerCommand("startup", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdStartup>(this));
+    registerCommand("jobs", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdJobs>(this));
+    registerCommand("jobs-reset", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdJobsReset>(this));
+    registerCommand("log-stats", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdLogStats>(this));
+    registerCommand("log-stats-reset", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdLogStatsReset>(this));
+    registerCommand("record-start", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdRecordStart>(this));
+    registerCommand("record-stop", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdRecordStop>(this));
+    registerCommand("replay", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdReplay>(this));
+    registerCommand("server-start", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdServerStart>(this));
+    registerCommand("server-stop", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdServerStop>(this));
+    registerCommand("server-stats", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdServerStats>(this));
+    registerAttribute("coalesce-commands", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdCoalesceCommands>(this));
+    registerAttribute("profile-commands", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdProfileCommands>(this));
+    registerAttribute("profile-latency", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdProfileLatency>(this));
+    registerAttribute("log-level", slot_t::fromMethod<TerminalObject, &TerminalObject::cmdLogLevel>(this));
+}
+
+TerminalObject::~TerminalObject() {
+    CommandServer::close();
+    AsyncQueue::shutdown();
+    unregisterAllCommands();
+    unregisterAllAttributes();
+}
+
+
+
+string TerminalObject::cmdCoalesceCommands(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    bool isEnabled = boost::lexical_cast<bool>(args[0]);
+    Terminal::setCommandCoalescing(isEnabled);
+    return string("Command coalescing ") + (isEnabled? "enabled" : "disabled");
+}
+
+string TerminalObject::cmdCompileScript(deque<string>& args) {
+    if (args.size() < 2)
+        return "Error: too few arguments";
+    return Terminal::compileScript(args[0], args[1]);
+}
+
+string TerminalObject::cmdProfileCommands(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    bool isEnabled = boost::lexical_cast<bool>(args[0]);
+    CommandProfiler::setEnabled(isEnabled);
+    return string("Command profiling ") + (isEnabled? "enabled" : "disabled");
+}
+
+string TerminalObject::cmdStats(deque<string>& args) {
+    size_t maxEntries = DEFAULT_STATS_ENTRIES;
+    if (args.size() > 0)
+        maxEntries = boost::lexical_cast<size_t>(args[0]);
+    return CommandProfiler::report(maxEntries);
+}
+
+string TerminalObject::cmdStatsReset(deque<string>&) {
+    CommandProfiler::reset();
+    return "";
+}
+
+string TerminalObject::cmdStatsCsv(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    if (!CommandProfiler::exportCsv(args[0]))
+        return "Error: could not export " + args[0];
+    return "Command stats exported to " + args[0];
+}
+
+string TerminalObject::cmdProfileLatency(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    bool isEnabled = boost::lexical_cast<bool>(args[0]);
+    InputLatency::setEnabled(isEnabled);
+    return string("Input latency profiling ") + (isEnabled? "enabled" : "disabled");
+}
+
+string TerminalObject::cmdLatency(deque<string>&) {
+    return InputLatency::report();
+}
+
+string TerminalObject::cmdLatencyReset(deque<string>&) {
+    InputLatency::reset();
+    return "";
+}
+
+string TerminalObject::cmdFrameTimes(deque<string>&) {
+    return FrameTimer::report();
+}
+
+string TerminalObject::cmdFrameTimesReset(deque<string>&) {
+    FrameTimer::reset();
+    return "";
+}
+
+string TerminalObject::cmdFrameTimesCsv(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    if (!FrameTimer::exportCsv(args[0]))
+        return "Error: could not export " + args[0];
+    return "Frame times exported to " + args[0];
+}
+
+string TerminalObject::cmdFrameArena(deque<string>&) {
+    return FrameArena::report();
+}
+
+string TerminalObject::cmdStartup(deque<string>&) {
+    return StartupTimer::report();
+}
+
+string TerminalObject::cmdJobs(deque<string>&) {
+    return JobSystem::report();
+}
+
+string TerminalObject::cmdJobsReset(deque<string>&) {
+    JobSystem::resetStats();
+    return "";
+}
+
+string TerminalObject::cmdLogLevel(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    log_level_t level;
+    if (!Logger::parseLevel(args[0], level))
+        return "Error: unknown log level, expected debug, info, warning, error or none";
+    Logger::setLevel(level);
+    if (level < LOG_COMPILED_LEVEL)
+        return "Log level " + args[0] + ", lower levels were compiled out";
+    return "Log level " + args[0];
+}
+
+string TerminalObject::cmdLogStats(deque<string>&) {
+    return Logger::report();
+}
+
+string TerminalObject::cmdLogStatsReset(deque<string>&) {
+    Logger::resetStats();
+    return "";
+}
+
+string TerminalObject::cmdRecordStart(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    if (!Terminal::startRecording(args[0]))
+        return "Error: already recording or replaying";
+    return "Recording commands into " + args[0];
+}
+
+string TerminalObject::cmdRecordStop(deque<string>&) {
+    if (!Terminal::isRecording())
+        return "Error: not recording";
+    if (!Terminal::stopRecording())
+        return "Error: could not save the recording";
+    return "Recording saved";
+}
+
+string TerminalObject::cmdReplay(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    if (!Terminal::startReplay(args[0]))
+        return "Error: could not replay " + args[0];
+    return "Replaying " + args[0];
+}
+
+string TerminalObject::cmdServerStart(deque<string>& args) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    if (!CommandServer::listen(args[0]))
+        return "Error: could not listen on " + args[0];
+    return "Listening on " + args[0];
+}
+
+string TerminalObject::cmdServerStop(deque<string>&) {
+    if (!CommandServer::isListening())
+        return "Error: not listening";
+    CommandServer::requestClose();
+    return "Command server closing";
+}
+
+string TerminalObject::cmdServerStats(deque<string>&) {
+    return CommandServer::statsToString();
+}
@@ -26,14 +26,17 @@
 
 #include "shoggoth-engine/kernel/tokentable.hpp"
 
-#include <iostream>
 #include <iomanip>
 #include <sstream>
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
 const size_t MAX_EXPECTED_ID_DIGITS = 4;
 
+const boost::uint32_t FNV_OFFSET_BASIS = 2166136261u;
+const boost::uint32_t FNV_PRIME = 16777619u;
+
 TokenTable::TokenTable() :
     m_tokenMap(),
     m_idMap(),
@@ -63,22 +66,36 @@ void TokenTable::unregisterToken(const string& token) {
     }
 }
 
+bool TokenTable::isToken(const string& token) const {
+    return m_tokenMap.find(token) != m_tokenMap.end();
+}
+
 bool TokenTable::findId(size_t& id, const string& token) const {
     map<string, size_t>::const_iterator it = m_tokenMap.find(token);
     if (it != m_tokenMap.end()) {
         id = it->second;
         return true;
     }
-    cerr << "Token \"" << token << "\" not found!" << endl;
+    LogError() << "Token \"" << token << "\" not found!";
     id = 0;
     return false;
 }
 
+void TokenTable::findIdsWithPrefix(const string& prefix, vector<size_t>& ids) const {
+    // tokens are sorted, so the ones sharing a prefix are contiguous
+    map<string, size_t>::const_iterator it;
+    for (it = m_tokenMap.lower_bound(prefix); it != m_tokenMap.end(); ++it) {
+        if (it->first.compare(0, prefix.size(), prefix) != 0)
+            break;
+        ids.push_back(it->second);
+    }
+}
+
 string TokenTable::findName(const size_t id) const {
     map<size_t, const string*>::const_iterator it = m_idMap.find(id);
     if (it != m_idMap.end())
         return *it->second;
-    cerr << "Command ID \"" << id << "\" not found!" << endl;
+    LogError() << "Command ID \"" << id << "\" not found!";
     return "";
 }
 
@@ -115,3 +132,22 @@ vector<string> TokenTable::autocompleteList(const std::string& token) const {
     }
     return autocomplete;
 }
+
+boost::uint32_t TokenTable::fingerprint() const {
+    // FNV-1a hash of every token and its id
+    boost::uint32_t hash = FNV_OFFSET_BASIS;
+    map<string, size_t>::const_iterator it;
+    for (it = m_tokenMap.begin(); it != m_tokenMap.end(); ++it) {
+        for (size_t i = 0; i <= it->first.size(); ++i) {
+            hash ^= static_cast<unsigned char>(it->first.c_str()[i]);
+            hash *= FNV_PRIME;
+        }
+        size_t id = it->second;
+        for (size_t i = 0; i < sizeof(size_t); ++i) {
+            hash ^= static_cast<boost::uint32_t>(id & 0xff);
+            hash *= FNV_PRIME;
+            id >>= 8;
+        }
+    }
+    return hash;
+}
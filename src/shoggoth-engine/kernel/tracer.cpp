@@ -0,0 +1,165 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/tracer.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <boost/lexical_cast.hpp>
+
+using namespace std;
+
+boost::atomic<bool> Tracer::ms_isCapturing(false);
+boost::atomic<boost::uint64_t> Tracer::ms_generation(0);
+boost::uint64_t Tracer::ms_startTime = 0;
+boost::thread::id Tracer::ms_mainThreadId;
+boost::mutex Tracer::ms_buffersMutex;
+vector<Tracer::trace_buffer_t*> Tracer::ms_buffers = vector<Tracer::trace_buffer_t*>();
+// buffers outlive their threads, so they can be exported after a worker is gone
+boost::thread_specific_ptr<Tracer::trace_buffer_t*> Tracer::ms_threadBuffer;
+
+
+void Tracer::start() {
+    // captures are started by a command, so from the main thread. The buffers are not
+    // touched here, each thread drops its old scopes when it records the first new one
+    {
+        boost::lock_guard<boost::mutex> lock(ms_buffersMutex);
+        ms_mainThreadId = boost::this_thread::get_id();
+    }
+    ms_startTime = Clock::nanoseconds();
+    ms_generation.fetch_add(1, boost::memory_order_relaxed);
+    ms_isCapturing.store(true, boost::memory_order_release);
+}
+
+void Tracer::stop() {
+    ms_isCapturing.store(false, boost::memory_order_release);
+}
+
+size_t Tracer::getTotalEvents() {
+    boost::lock_guard<boost::mutex> lock(ms_buffersMutex);
+    size_t totalEvents = 0;
+    boost::uint64_t first, total;
+    for (size_t i = 0; i < ms_buffers.size(); ++i) {
+        if (getCapturedRange(ms_buffers[i], first, total))
+            totalEvents += size_t(total - first);
+    }
+    return totalEvents;
+}
+
+bool Tracer::exportTrace(const string& fileName) {
+    ofstream fout(fileName.c_str());
+    if (!fout.is_open())
+        return false;
+
+    // complete events ("X") in microseconds, nesting is worked out from the times
+    boost::lock_guard<boost::mutex> lock(ms_buffersMutex);
+    vector<trace_event_t> events;
+    boost::uint64_t first, total;
+    fout << fixed << setprecision(3);
+    fout << "{\"traceEvents\":[" << endl;
+    bool isFirst = true;
+    for (size_t i = 0; i < ms_buffers.size(); ++i) {
+        const trace_buffer_t* buffer = ms_buffers[i];
+        fout << (isFirst? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << buffer->threadId << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+        isFirst = false;
+
+        // copied first, the owner may still be recording and overwrite the oldest scopes
+        if (!getCapturedRange(buffer, first, total))
+            continue;
+        events.clear();
+        for (boost::uint64_t n = first; n < total; ++n)
+            events.push_back(buffer->events[size_t(n % TRACE_BUFFER_EVENTS)]);
+        boost::uint64_t written = buffer->totalEvents.load(boost::memory_order_acquire);
+        size_t overwritten = written - first > TRACE_BUFFER_EVENTS? size_t(written - first - TRACE_BUFFER_EVENTS) : 0;
+
+        for (size_t n = min(overwritten, events.size()); n < events.size(); ++n) {
+            const trace_event_t& event = events[n];
+            if (event.begin < ms_startTime)
+                continue;
+            fout << ",\n{\"name\":\"";
+            writeEscaped(fout, event.name);
+            fout << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << double(event.begin - ms_startTime) * 1.0e-3
+                 << ",\"dur\":" << double(event.end - event.begin) * 1.0e-3 << "}";
+        }
+    }
+    fout << "\n],\"displayTimeUnit\":\"ns\"}" << endl;
+    fout.close();
+    return !fout.fail();
+}
+
+
+
+void Tracer::record(const char* name, const boost::uint64_t begin, const boost::uint64_t end) {
+    trace_buffer_t* buffer = getThreadBuffer();
+    boost::uint64_t totalEvents = buffer->totalEvents.load(boost::memory_order_relaxed);
+    boost::uint64_t generation = ms_generation.load(boost::memory_order_relaxed);
+    if (buffer->generation.load(boost::memory_order_relaxed) != generation) {
+        buffer->firstEvent.store(totalEvents, boost::memory_order_relaxed);
+        buffer->generation.store(generation, boost::memory_order_release);
+    }
+    trace_event_t& event = buffer->events[size_t(totalEvents % TRACE_BUFFER_EVENTS)];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    buffer->totalEvents.store(totalEvents + 1, boost::memory_order_release);
+}
+
+bool Tracer::getCapturedRange(const trace_buffer_t* buffer, boost::uint64_t& first, boost::uint64_t& total) {
+    // a buffer still on an older generation recorded nothing in this capture
+    if (buffer->generation.load(boost::memory_order_acquire) != ms_generation.load(boost::memory_order_relaxed))
+        return false;
+    first = buffer->firstEvent.load(boost::memory_order_relaxed);
+    total = buffer->totalEvents.load(boost::memory_order_acquire);
+    if (total - first > TRACE_BUFFER_EVENTS)
+        first = total - TRACE_BUFFER_EVENTS;
+    return true;
+}
+
+Tracer::trace_buffer_t* Tracer::getThreadBuffer() {
+    trace_buffer_t** buffer = ms_threadBuffer.get();
+    if (buffer != 0)
+        return *buffer;
+
+    boost::lock_guard<boost::mutex> lock(ms_buffersMutex);
+    size_t threadId = ms_buffers.size() + 1;
+    string threadName = boost::this_thread::get_id() == ms_mainThreadId?
+                        string("main") : "thread " + boost::lexical_cast<string>(threadId);
+    ms_buffers.push_back(new trace_buffer_t(threadId, threadName));
+    ms_threadBuffer.reset(new trace_buffer_t*(ms_buffers.back()));
+    return ms_buffers.back();
+}
+
+void Tracer::writeEscaped(ostream& out, const char* text) {
+    for (; *text != '\0'; ++text) {
+        if (*text == '"' || *text == '\\')
+            out << '\\';
+        out << *text;
+    }
+}
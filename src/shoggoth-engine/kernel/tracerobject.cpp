@@ -0,0 +1,69 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/kernel/tracerobject.hpp"
+
+#include "shoggoth-engine/kernel/tracer.hpp"
+
+using namespace std;
+
+TracerObject::TracerObject(const string& objectName):
+    CommandObject(objectName)
+{
+    registerCommand("start", slot_t::fromMethod<TracerObject, &TracerObject::cmdStart>(this));
+    registerCommand("stop", slot_t::fromMethod<TracerObject, &TracerObject::cmdStop>(this));
+    registerCommand("status", slot_t::fromMethod<TracerObject, &TracerObject::cmdStatus>(this));
+}
+
+TracerObject::~TracerObject() {
+    Tracer::stop();
+    unregisterAllCommands();
+    unregisterAllAttributes();
+}
+
+
+
+string TracerObject::cmdStart(deque<string>&) {
+    if (Tracer::isCapturing())
+        return "Error: already capturing";
+    Tracer::start();
+    return "Trace capture started";
+}
+
+string TracerObject::cmdStop(deque<string>& args) {
+    if (!Tracer::isCapturing())
+        return "Error: not capturing";
+    Tracer::stop();
+    string fileName = args.size() < 1? DEFAULT_TRACE_FILE : args[0];
+    if (!Tracer::exportTrace(fileName))
+        return "Error: could not export " + fileName;
+    return "Trace of " + boost::lexical_cast<string>(Tracer::getTotalEvents()) + " scopes saved to " + fileName;
+}
+
+string TracerObject::cmdStatus(deque<string>&) {
+    return string("Trace capture ") + (Tracer::isCapturing()? "running, " : "stopped, ")
+           + boost::lexical_cast<string>(Tracer::getTotalEvents()) + " scopes";
+}
@@ -26,10 +26,13 @@
 
 #include "shoggoth-engine/physics/physicsworld.hpp"
 
-#include <iostream>
 #include <bullet/btBulletDynamicsCommon.h>
 #include "shoggoth-engine/kernel/entity.hpp"
+#include "shoggoth-engine/kernel/frametimer.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
 #include "shoggoth-engine/physics/rigidbody.hpp"
+#include "shoggoth-engine/kernel/startuptimer.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
@@ -47,12 +50,13 @@ PhysicsWorld::PhysicsWorld(const string& objectName):
     m_collisionShapes(),
     m_rigidBodies()
 {
-    registerAttribute("min-expected-framerate", boost::bind(&PhysicsWorld::cmdMinExpectedFramerate, this, _1));
+    StartupPhase phase("Physics world");
+    registerAttribute("min-expected-framerate", slot_t::fromMethod<PhysicsWorld, &PhysicsWorld::cmdMinExpectedFramerate>(this));
 
-    cout << "Physics simulations done with Bullet Physics" << endl;
+    LogInfo() << "Physics simulations done with Bullet Physics";
     setMinExpectedFramerate(DEFAULT_MIN_EXPECTED_FRAMERATE);
 
-    cout << "Creating dynamics world" << endl;
+    LogInfo() << "Creating dynamics world";
     m_broadphase = new btDbvtBroadphase;
     m_collisionConfiguration = new btDefaultCollisionConfiguration;
     m_collisionDispatcher = new btCollisionDispatcher(m_collisionConfiguration);
@@ -61,7 +65,7 @@ PhysicsWorld::PhysicsWorld(const string& objectName):
 }
 
 PhysicsWorld::~PhysicsWorld() {
-    cout << "Destroying rigid bodies" << endl;
+    LogInfo() << "Destroying rigid bodies";
     rigid_bodies_map_t::iterator itRig;
     for (itRig = m_rigidBodies.begin(); itRig != m_rigidBodies.end(); ++itRig) {
         m_dynamicsWorld->removeRigidBody(itRig->second);
@@ -69,12 +73,12 @@ PhysicsWorld::~PhysicsWorld() {
         delete itRig->second;
     }
 
-    cout << "Destroying collision shapes" << endl;
+    LogInfo() << "Destroying collision shapes";
     collision_shapes_map_t::iterator itCol;
     for (itCol = m_collisionShapes.begin(); itCol != m_collisionShapes.end(); ++itCol)
         delete itCol->second;
 
-    cout << "Destroying dynamics world" << endl;
+    LogInfo() << "Destroying dynamics world";
     delete m_dynamicsWorld;
     delete m_solver;
     delete m_collisionDispatcher;
@@ -97,12 +101,26 @@ void PhysicsWorld::unregisterRigidBody(RigidBody* body) {
 }
 
 void PhysicsWorld::stepSimulation(const double currentTimeSeconds) {
+    TraceScope trace("PhysicsWorld::stepSimulation");
+    FrameTimer::beginPhase(FRAME_PHASE_PHYSICS);
     m_dynamicsWorld->stepSimulation(btScalar(currentTimeSeconds - m_lastTime),
                                     m_maxSubsteps,
                                     btScalar(FIXED_TIMESTEP));
     m_lastTime = currentTimeSeconds;
 
     updateRigidBodies();
+    FrameTimer::endPhase(FRAME_PHASE_PHYSICS);
+}
+
+void PhysicsWorld::stepFixed(const double timestep) {
+    TraceScope trace("PhysicsWorld::stepFixed");
+    // exactly one step, the caller keeps the time (see SimulationLoop)
+    FrameTimer::beginPhase(FRAME_PHASE_PHYSICS);
+    m_dynamicsWorld->stepSimulation(btScalar(timestep), 1, btScalar(timestep));
+    m_lastTime += timestep;
+
+    updateRigidBodies();
+    FrameTimer::endPhase(FRAME_PHASE_PHYSICS);
 }
 
 PhysicsWorld::PhysicsWorld(const PhysicsWorld& rhs):
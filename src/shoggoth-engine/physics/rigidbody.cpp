@@ -29,18 +29,20 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include <bullet/btBulletDynamicsCommon.h>
 #include <bullet/BulletCollision/CollisionShapes/btShapeHull.h>
 #include "shoggoth-engine/linearmath/transform.hpp"
 #include "shoggoth-engine/kernel/entity.hpp"
 #include "shoggoth-engine/kernel/model.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
 #include "shoggoth-engine/physics/physicsworld.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 using namespace boost::property_tree;
 
 const string XML_RIGIDBODY_MASS = "mass";
-const string XML_RIGIDBODY_COLLISIONSHAPE = "collisionshape";
 const string XML_RIGIDBODY_DAMPING = "damping";
 const string XML_RIGIDBODY_FRICTION = "friction";
 const string XML_RIGIDBODY_ROLLINGFRICTION = "rollingfriction";
@@ -52,6 +54,9 @@ const string XML_RIGIDBODY_ANGULARFACTOR = "angularfactor";
 const string XML_RIGIDBODY_ANGULARVELOCITY = "angularvelocity";
 const string XML_RIGIDBODY_GRAVITY = "gravity";
 
+size_t RigidBody::ms_deferActivationsDepth = 0;
+vector<RigidBody*> RigidBody::ms_pendingActivations = vector<RigidBody*>();
+
 
 
 RigidBody::RigidBody(Entity*const _entity, PhysicsWorld* physicsWorld):
@@ -59,22 +64,26 @@ RigidBody::RigidBody(Entity*const _entity, PhysicsWorld* physicsWorld):
     m_physicsWorld(physicsWorld),
     m_shapeId(""),
     m_rigidBody(0),
-    m_mass(0.0)
+    m_mass(0.0),
+    m_isActivationPending(false),
+    m_isForcedActivation(false)
 {
-    m_entity->registerAttribute("mass", boost::bind(&RigidBody::cmdMass, this, _1));
-    m_entity->registerAttribute("damping", boost::bind(&RigidBody::cmdDamping, this, _1));
-    m_entity->registerAttribute("friction", boost::bind(&RigidBody::cmdFriction, this, _1));
-    m_entity->registerAttribute("rolling-friction", boost::bind(&RigidBody::cmdRollingFriction, this, _1));
-    m_entity->registerAttribute("restitution", boost::bind(&RigidBody::cmdRestitution, this, _1));
-    m_entity->registerAttribute("sleeping-thresholds", boost::bind(&RigidBody::cmdSleepingThresholds, this, _1));
-    m_entity->registerAttribute("linear-factor", boost::bind(&RigidBody::cmdLinearFactor, this, _1));
-    m_entity->registerAttribute("linear-velocity", boost::bind(&RigidBody::cmdLinearVelocity, this, _1));
-    m_entity->registerAttribute("angular-factor", boost::bind(&RigidBody::cmdAngularFactor, this, _1));
-    m_entity->registerAttribute("angular-velocity", boost::bind(&RigidBody::cmdAngularVelocity, this, _1));
-    m_entity->registerAttribute("gravity", boost::bind(&RigidBody::cmdGravity, this, _1));
+    m_entity->registerAttribute("mass", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdMass>(this));
+    m_entity->registerAttribute("damping", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdDamping>(this));
+    m_entity->registerAttribute("friction", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdFriction>(this));
+    m_entity->registerAttribute("rolling-friction", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdRollingFriction>(this));
+    m_entity->registerAttribute("restitution", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdRestitution>(this));
+    m_entity->registerAttribute("sleeping-thresholds", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdSleepingThresholds>(this));
+    m_entity->registerAttribute("linear-factor", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdLinearFactor>(this));
+    m_entity->registerAttribute("linear-velocity", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdLinearVelocity>(this));
+    m_entity->registerAttribute("angular-factor", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdAngularFactor>(this));
+    m_entity->registerAttribute("angular-velocity", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdAngularVelocity>(this));
+    m_entity->registerAttribute("gravity", CommandObject::slot_t::fromMethod<RigidBody, &RigidBody::cmdGravity>(this));
 }
 
 RigidBody::~RigidBody() {
+    if (m_isActivationPending)
+        ms_pendingActivations.erase(find(ms_pendingActivations.begin(), ms_pendingActivations.end(), this));
     m_physicsWorld->unregisterRigidBody(this);
     m_entity->unregisterAttribute("gravity");
     m_entity->unregisterAttribute("angular-velocity");
@@ -157,6 +166,14 @@ Vector3 RigidBody::getGravity() const {
 
 
 void RigidBody::activate(const bool forceActivate) {
+    if (ms_deferActivationsDepth > 0) {
+        if (!m_isActivationPending) {
+            m_isActivationPending = true;
+            ms_pendingActivations.push_back(this);
+        }
+        m_isForcedActivation = m_isForcedActivation || forceActivate;
+        return;
+    }
     m_rigidBody->activate(forceActivate);
 }
 
@@ -284,30 +301,8 @@ void RigidBody::addConvexHull(const double mass, const string& fileName) {
 
     btCollisionShape* shape = m_physicsWorld->findCollisionShape(m_shapeId);
     if (shape == 0) {
-        // build original mesh from file
-        Model model("convex-hull");
-        model.generateFromFile(fileName);
-        cout << "Generating convex hull from file: " << fileName << endl;
-        vector<float> points;
-        for (size_t n = 0; n < model.getTotalMeshes(); ++n) {
-            points.reserve(points.size() + model.mesh(n)->getVerticesSize());
-            for (size_t i = 0; i < model.mesh(n)->getVerticesSize(); ++i) {
-                points.push_back(model.mesh(n)->getVertex(i));
-            }
-        }
-        btConvexShape* originalConvexShape = new btConvexHullShape(&points[0], int(points.size() / 3), sizeof(float) * 3);
-        points.clear();
-
-        // convert to low polygon hull
-        btShapeHull* hull = new btShapeHull(originalConvexShape);
-        btScalar margin = originalConvexShape->getMargin();
-        hull->buildHull(margin);
-
-        shape = new btConvexHullShape(&hull->getVertexPointer()->getX(), hull->numVertices());
+        shape = buildConvexHull(fileName);
         m_physicsWorld->registerCollisionShape(m_shapeId, shape);
-
-        delete originalConvexShape;
-        delete hull;
     }
     addRigidBody(mass, shape);
 }
@@ -317,10 +312,11 @@ void RigidBody::addConcaveHull(const double mass, const string& fileName) {
 
     btCollisionShape* shape = m_physicsWorld->findCollisionShape(m_shapeId);
     if (shape == 0) {
+        TraceScope trace("RigidBody::addConcaveHull");
         // build mesh from file
         Model model("convex-hull");
         model.generateFromFile(fileName);
-        cout << "Generating concave hull from file: " << fileName << endl;
+        LogInfo() << "Generating concave hull from file: " << fileName;
         btTriangleIndexVertexArray* triangles = new btTriangleIndexVertexArray();
         for (size_t n = 0; n < model.getTotalMeshes(); ++n) {
             btIndexedMesh indexedMesh;
@@ -341,6 +337,54 @@ void RigidBody::addConcaveHull(const double mass, const string& fileName) {
     addRigidBody(mass, shape);
 }
 
+btCollisionShape* RigidBody::buildConvexHull(const string& fileName) {
+    TraceScope trace("RigidBody::buildConvexHull");
+    // doesn't touch the physics world, so it can run on a worker thread
+
+    // build original mesh from file
+    Model model("convex-hull");
+    model.generateFromFile(fileName);
+    LogInfo() << "Generating convex hull from file: " << fileName;
+    vector<float> points;
+    for (size_t n = 0; n < model.getTotalMeshes(); ++n) {
+        points.reserve(points.size() + model.mesh(n)->getVerticesSize());
+        for (size_t i = 0; i < model.mesh(n)->getVerticesSize(); ++i) {
+            points.push_back(model.mesh(n)->getVertex(i));
+        }
+    }
+    btConvexShape* originalConvexShape = new btConvexHullShape(&points[0], int(points.size() / 3), sizeof(float) * 3);
+    points.clear();
+
+    // convert to low polygon hull
+    btShapeHull* hull = new btShapeHull(originalConvexShape);
+    btScalar margin = originalConvexShape->getMargin();
+    hull->buildHull(margin);
+
+    btCollisionShape* shape = new btConvexHullShape(&hull->getVertexPointer()->getX(), hull->numVertices());
+
+    delete originalConvexShape;
+    delete hull;
+    return shape;
+}
+
+void RigidBody::deferActivations() {
+    ++ms_deferActivationsDepth;
+}
+
+void RigidBody::flushActivations() {
+    // every body touched while deferred is woken once, instead of once per change
+    if (ms_deferActivationsDepth == 0 || --ms_deferActivationsDepth > 0)
+        return;
+    for (size_t i = 0; i < ms_pendingActivations.size(); ++i) {
+        RigidBody* body = ms_pendingActivations[i];
+        if (body->m_rigidBody != 0)
+            body->m_rigidBody->activate(body->m_isForcedActivation);
+        body->m_isActivationPending = false;
+        body->m_isForcedActivation = false;
+    }
+    ms_pendingActivations.clear();
+}
+
 void RigidBody::loadFromPtree(const string& path, const ptree& tree) {
     m_mass = tree.get<double>(xmlPath(path + XML_RIGIDBODY_MASS), 0.0);
     string shape = tree.get<string>(xmlPath(path + XML_RIGIDBODY_COLLISIONSHAPE), "empty");
@@ -382,7 +426,7 @@ void RigidBody::loadFromPtree(const string& path, const ptree& tree) {
         addConcaveHull(m_mass, file);
     }
     else
-        cerr << "Error: unknown rigidbody collisionshape: " << shape << endl;
+        LogError() << "Error: unknown rigidbody collisionshape: " << shape;
 
     double x, y;
     x = tree.get<double>(xmlPath(path + XML_RIGIDBODY_FRICTION), 0.5);
@@ -443,7 +487,9 @@ RigidBody::RigidBody(const RigidBody& rhs):
     m_physicsWorld(rhs.m_physicsWorld),
     m_shapeId(rhs.m_shapeId),
     m_rigidBody(rhs.m_rigidBody),
-    m_mass(rhs.m_mass)
+    m_mass(rhs.m_mass),
+    m_isActivationPending(false),
+    m_isForcedActivation(false)
 {
     cerr << "Error: RigidBody copy constructor should not be called!" << endl;
 }
@@ -63,11 +63,11 @@ Camera::Camera(Entity* const _entity, Renderer* renderer):
 
     m_renderer->registerCamera(this);
 
-    m_entity->registerAttribute("type", boost::bind(&Camera::cmdCameraType, this, _1));
-    m_entity->registerAttribute("perspective-fov", boost::bind(&Camera::cmdPerspectiveFOV, this, _1));
-    m_entity->registerAttribute("ortho-height", boost::bind(&Camera::cmdOrthoHeight, this, _1));
-    m_entity->registerAttribute("near-distance", boost::bind(&Camera::cmdNearDistance, this, _1));
-    m_entity->registerAttribute("far-distance", boost::bind(&Camera::cmdFarDistance, this, _1));
+    m_entity->registerAttribute("type", CommandObject::slot_t::fromMethod<Camera, &Camera::cmdCameraType>(this));
+    m_entity->registerAttribute("perspective-fov", CommandObject::slot_t::fromMethod<Camera, &Camera::cmdPerspectiveFOV>(this));
+    m_entity->registerAttribute("ortho-height", CommandObject::slot_t::fromMethod<Camera, &Camera::cmdOrthoHeight>(this));
+    m_entity->registerAttribute("near-distance", CommandObject::slot_t::fromMethod<Camera, &Camera::cmdNearDistance>(this));
+    m_entity->registerAttribute("far-distance", CommandObject::slot_t::fromMethod<Camera, &Camera::cmdFarDistance>(this));
 }
 
 Camera::~Camera() {
@@ -31,7 +31,9 @@
 #include "shoggoth-engine/linearmath/transform.hpp"
 #include "shoggoth-engine/kernel/entity.hpp"
 #include "shoggoth-engine/kernel/model.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
 #include "shoggoth-engine/renderer/renderablemesh.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
@@ -81,10 +83,13 @@ struct DbvtBroadphaseFrustumCulling : btDbvt::ICollide {
     }
 } g_DBFC;
 
+// kept between frames, resize(0) keeps the memory (clear() would free it)
+btAlignedObjectArray<btCollisionObject*> g_objectsInFrustum;
+
 
 
 void Culling::initialize() {
-    cout << "Creating dbvtBroadphase collision world for rendering culling" << endl;
+    LogInfo() << "Creating dbvtBroadphase collision world for rendering culling";
     m_broadphase = new btDbvtBroadphase;
     m_collisionConfiguration = new btDefaultCollisionConfiguration;
     m_collisionDispatcher = new btCollisionDispatcher(m_collisionConfiguration);
@@ -92,7 +97,7 @@ void Culling::initialize() {
 }
 
 void Culling::shutdown() {
-    cout << "Destroying all collision objects for culling" << endl;
+    LogInfo() << "Destroying all collision objects for culling";
     collision_object_map_t::const_iterator it;
     for (it = m_collisionObjects.begin(); it != m_collisionObjects.end(); ++it) {
         btCollisionObject* object = it->second;
@@ -101,7 +106,7 @@ void Culling::shutdown() {
         delete object;
     }
 
-    cout << "Destroying dbvtBroadphase collision world" << endl;
+    LogInfo() << "Destroying dbvtBroadphase collision world";
     delete m_collisionWorld;
     delete m_collisionDispatcher;
     delete m_collisionConfiguration;
@@ -165,7 +170,8 @@ void Culling::unregisterForCulling(RenderableMesh* const renderablemesh) {
 
 void Culling::performFrustumCulling(const float* projectionMatrix,
                                     const Entity* camera,
-                                    set<RenderableMesh*>& modelsInFrustum) {
+                                    frame_renderable_set_t& modelsInFrustum) {
+    TraceScope trace("Culling::performFrustumCulling");
 //     renderable_mesh_map_t::const_iterator itTemp;
 //     for (itTemp = m_renderableMeshes.begin(); itTemp != m_renderableMeshes.end(); ++itTemp) {
 //         RenderableMesh* renderable = itTemp->second;
@@ -207,7 +213,8 @@ void Culling::performFrustumCulling(const float* projectionMatrix,
     m_collisionWorld->updateAabbs();
 
     // check for the dbvt collisions
-    btAlignedObjectArray<btCollisionObject*> objectsInFrustum;
+    btAlignedObjectArray<btCollisionObject*>& objectsInFrustum = g_objectsInFrustum;
+    objectsInFrustum.resize(0);
     g_DBFC.m_pCollisionObjectArray = &objectsInFrustum;
     btDbvt::collideKDOP(m_broadphase->m_sets[1].m_root, planeNormals, planeOffsets, 5, g_DBFC);
     btDbvt::collideKDOP(m_broadphase->m_sets[0].m_root, planeNormals, planeOffsets, 5, g_DBFC);
@@ -62,9 +62,9 @@ Light::Light(Entity* const _entity, Renderer* renderer):
 
     m_renderer->registerLight(this);
 
-    m_entity->registerAttribute("ambient-color", boost::bind(&Light::cmdAmbient, this, _1));
-    m_entity->registerAttribute("diffuse-color", boost::bind(&Light::cmdDiffuse, this, _1));
-    m_entity->registerAttribute("specular-color", boost::bind(&Light::cmdSpecular, this, _1));
+    m_entity->registerAttribute("ambient-color", CommandObject::slot_t::fromMethod<Light, &Light::cmdAmbient>(this));
+    m_entity->registerAttribute("diffuse-color", CommandObject::slot_t::fromMethod<Light, &Light::cmdDiffuse>(this));
+    m_entity->registerAttribute("specular-color", CommandObject::slot_t::fromMethod<Light, &Light::cmdSpecular>(this));
 }
 
 Light::~Light() {
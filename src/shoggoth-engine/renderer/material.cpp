@@ -26,7 +26,6 @@
 
 #include "shoggoth-engine/renderer/material.hpp"
 
-#include <iostream>
 #include <fstream>
 #include <boost/foreach.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -34,6 +33,7 @@
 #include "shoggoth-engine/renderer/opengl.hpp"
 #include "shoggoth-engine/renderer/renderer.hpp"
 #include "shoggoth-engine/renderer/texture.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 using namespace boost::property_tree;
@@ -129,7 +129,11 @@ istream& operator>>(istream& in, mat4_t& m) {
 }
 
 
+size_t Material::ms_totalMaterials = 0;
+
+
 Material::Material(Renderer* renderer):
+    m_sortId(ms_totalMaterials++),
     m_renderer(renderer),
     m_fileName(),
     m_shader(),
@@ -154,6 +158,7 @@ Material::Material(Renderer* renderer):
 {}
 
 Material::Material(const Material& rhs):
+    m_sortId(ms_totalMaterials++),
     m_renderer(rhs.m_renderer),
     m_fileName(rhs.m_fileName),
     m_shader(rhs.m_shader),
@@ -215,7 +220,7 @@ bool Material::loadFromFile(const std::string& fileName) {
     m_fileName = fileName;
     ifstream fin(m_fileName.c_str());
     if (!fin.is_open() || !fin.good()) {
-        cerr << "Error: could not open material file: " << m_fileName << endl;
+        LogError() << "Error: could not open material file: " << m_fileName;
         return false;
     }
     fin.close();
@@ -234,7 +239,7 @@ bool Material::loadFromFile(const std::string& fileName) {
     }
 
     if (tree.find(XML_ROOT_NODE) == tree.not_found()) {
-        cerr << "Error loading material: <material> root node not found" << endl;
+        LogError() << "Error loading material: <material> root node not found";
         return false;
     }
 
@@ -321,7 +326,7 @@ bool Material::loadFromFile(const std::string& fileName) {
                     m_shader.setUniformMatrix2x2(v.first, mat2.m);
             }
             else
-                cerr << "Error: undefined data type for attribute: " << type << " " << name << endl;
+                LogError() << "Error: undefined data type for attribute: " << type << " " << name;
         }
     }
     return true;
@@ -339,8 +344,25 @@ Texture* Material::loadTextureFromFile(const string& fileName) {
 }
 
 void Material::useMaterial() const {
+    useProgram();
+    useMaterialState();
+    useTransform();
+    if (!OpenGL::areShadersSupported()) {
+        // set diffuse texture
+        glBindTexture(GL_TEXTURE_2D, getTextureId());
+    }
+}
+
+// bound apart from the rest of the material, materials sharing a program skip it
+void Material::useProgram() const {
+    if (OpenGL::areShadersSupported())
+        m_shader.useProgram();
+}
+
+// the uniforms of the program in use, or the fixed pipeline material
+void Material::useMaterialState() const {
     if (OpenGL::areShadersSupported())
-        m_shader.useShader();
+        m_shader.useUniforms();
     else {
         // set material
         glMaterialfv(GL_FRONT, GL_DIFFUSE, m_diffuseColor.getRGBA());
@@ -348,15 +370,14 @@ void Material::useMaterial() const {
         glMaterialfv(GL_FRONT, GL_AMBIENT, m_ambientColor.getRGBA());
         glMaterialfv(GL_FRONT, GL_EMISSION, m_emissiveColor.getRGBA());
         glMaterialf(GL_FRONT, GL_SHININESS, m_shininess);
-
-        // set diffuse texture
-        if (m_diffuseMap != 0)
-            glBindTexture(GL_TEXTURE_2D, m_diffuseMap->getId());
-        else
-            glBindTexture(GL_TEXTURE_2D, 0);
-//         if (mtl->getTextureMap(MATERIAL_DIFFUSE_MAP) != 0)
-//             glBindTexture(GL_TEXTURE_2D, mtl->getTextureMap(MATERIAL_DIFFUSE_MAP)->getId());
-//         else
-//             glBindTexture(GL_TEXTURE_2D, 0);
     }
 }
+
+void Material::useTransform() const {
+    if (OpenGL::areShadersSupported())
+        m_shader.useMatrices();
+}
+
+unsigned int Material::getTextureId() const {
+    return m_diffuseMap != 0? m_diffuseMap->getId() : 0;
+}
@@ -47,11 +47,26 @@ float OpenGL::ms_anisotropy = 1.0f;
 texture_filtering_t OpenGL::ms_textureFilteringMode = TEXTURE_FILTERING_NEAREST;
 texture_compression_t OpenGL::ms_textureCompressionMode = TEXTURE_COMPRESSION_NONE;
 rendering_method_t OpenGL::ms_renderingMethod = RENDERING_METHOD_FIXED_PIPELINE;
+instancing_t OpenGL::ms_instancingMode = INSTANCING_NONE;
 bool OpenGL::ms_areVBOsSupported = false;
 bool OpenGL::ms_areShadersSupported = false;
+bool OpenGL::ms_areVAOsSupported = false;
+bool OpenGL::ms_isNullRenderer = false;
 
 
 void OpenGL::detectCapabilities() {
+    if (ms_isNullRenderer) {
+        // there is no context to ask, meshes and textures stay in main memory
+        cout << "Using null renderer, no OpenGL calls are made" << endl << endl;
+        ms_dataUploadMode = DATA_UPLOAD_VERTEX_ARRAY;
+        ms_renderingMethod = RENDERING_METHOD_FIXED_PIPELINE;
+        ms_instancingMode = INSTANCING_NONE;
+        ms_areVBOsSupported = false;
+        ms_areShadersSupported = false;
+        ms_areVAOsSupported = false;
+        return;
+    }
+
     GLint integer;
 
     stringstream ss;
@@ -140,6 +155,7 @@ void OpenGL::detectCapabilities() {
         ms_mipMapGenerationMode = MIPMAP_GENERATION_GLU;
         ms_renderingMethod = RENDERING_METHOD_FIXED_PIPELINE;
     }
+    ms_instancingMode = openGLVersionInt >= 33? INSTANCING : INSTANCING_NONE;
 
     // extension techniques
     glGetIntegerv(GL_NUM_EXTENSIONS, &integer);
@@ -184,6 +200,16 @@ void OpenGL::detectCapabilities() {
         ms_renderingMethod = RENDERING_METHOD_SHADERS_EXT;
     }
 
+    // instances read their matrix from a vbo through a shader attribute
+    if (ms_instancingMode == INSTANCING_NONE &&
+        ms_dataUploadMode != DATA_UPLOAD_VERTEX_ARRAY &&
+        ms_renderingMethod != RENDERING_METHOD_FIXED_PIPELINE &&
+        glewIsSupported("GL_ARB_instanced_arrays") &&
+        glewIsSupported("GL_ARB_draw_instanced"))
+    {
+        ms_instancingMode = INSTANCING_EXT;
+    }
+
     switch (ms_dataUploadMode) {
     case DATA_UPLOAD_VERTEX_ARRAY:
         cout << "Using Vertex Array Objects" << endl;
@@ -258,6 +284,28 @@ void OpenGL::detectCapabilities() {
     default:
         cerr << "Error: invalid rendering_method_t: " << ms_renderingMethod << endl;
     }
+
+    // a vao per mesh keeps its buffers and attribute layout, meshes are drawn by binding it
+    ms_areVAOsSupported = ms_areVBOsSupported && ms_areShadersSupported &&
+                          (openGLVersionInt >= 30 || glewIsSupported("GL_ARB_vertex_array_object"));
+    if (ms_areVAOsSupported)
+        cout << "Using Vertex Array Objects for meshes" << endl;
+    else
+        cout << "Vertex Array Objects for meshes not supported" << endl;
+
+    switch (ms_instancingMode) {
+    case INSTANCING_NONE:
+        cout << "Instanced drawing not supported" << endl;
+        break;
+    case INSTANCING_EXT:
+        cout << "Using instanced drawing ARB extension" << endl;
+        break;
+    case INSTANCING:
+        cout << "Using instanced drawing" << endl;
+        break;
+    default:
+        cerr << "Error: invalid instancing_t: " << ms_instancingMode << endl;
+    }
     cout << endl;
 
     // always
@@ -268,8 +316,12 @@ void OpenGL::detectCapabilities() {
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 }
 
+void OpenGL::forceNullRenderer(const bool useNullRenderer) {
+    ms_isNullRenderer = useNullRenderer;
+}
+
 void OpenGL::forceFixedPipeline(const bool useFixedPipeline) {
-    if (!useFixedPipeline)
+    if (!useFixedPipeline || ms_isNullRenderer)
         return;
     cout << "NOTE: OpenGL.detectCapabilities: Forcing Fixed Pipeline" << endl;
     ms_renderingMethod = RENDERING_METHOD_FIXED_PIPELINE;
@@ -295,7 +347,9 @@ void OpenGL::forceFixedPipeline(const bool useFixedPipeline) {
     glEnableClientState(GL_VERTEX_ARRAY);
     glEnableClientState(GL_NORMAL_ARRAY);
     glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    ms_instancingMode = INSTANCING_NONE;
     ms_areShadersSupported = false;
+    ms_areVAOsSupported = false;
 }
 
 void OpenGL::multMatrix(float* result, const float* a, const float* b) {
@@ -29,18 +29,66 @@
 #include <sstream>
 #include "shoggoth-engine/kernel/entity.hpp"
 #include "shoggoth-engine/kernel/model.hpp"
+#include "shoggoth-engine/kernel/asyncjob.hpp"
+#include "shoggoth-engine/kernel/terminal.hpp"
 #include "shoggoth-engine/renderer/renderer.hpp"
 #include "shoggoth-engine/renderer/culling.hpp"
 #include "shoggoth-engine/renderer/material.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 using namespace boost::property_tree;
 
-const string XML_RENDERABLEMESH_MODEL = "model";
 const string XML_MATERIAL = "material";
 const string XML_DEFAULT_MATERIAL = "**default**";
 
 
+// Imports the model file on the worker, the GPU upload is done when committing.
+// The entity and the component can both be destroyed while importing, so the mesh
+// pointer is only compared until the entity is found again by id.
+class LoadModelFileJob: public AsyncJob {
+public:
+    LoadModelFileJob(RenderableMesh* renderableMesh, const string& fileName):
+        AsyncJob(),
+        m_renderableMesh(renderableMesh),
+        m_entity(renderableMesh->entity()),
+        m_idEntity(m_entity->getIdObject()),
+        m_fileName(fileName),
+        m_model(0)
+    {}
+
+    ~LoadModelFileJob() {
+        delete m_model;
+    }
+
+    void run() {
+        m_model = new Model(RENDERABLEMESH_FILE_DESCRIPTION + " " + m_fileName);
+        m_model->generateFromFile(m_fileName);
+    }
+
+    string commit() {
+        CommandObject* object;
+        if (!Terminal::getObject(m_idEntity, object) || object != m_entity)
+            return "";
+        if (m_entity->component(COMPONENT_RENDERABLEMESH) != m_renderableMesh)
+            return "";
+        m_renderableMesh->loadFromModel(m_model);
+        m_model = 0;
+        return "";
+    }
+
+private:
+    RenderableMesh* m_renderableMesh;
+    Entity* m_entity;
+    size_t m_idEntity;
+    string m_fileName;
+    Model* m_model;
+
+    LoadModelFileJob(const LoadModelFileJob& rhs);
+    LoadModelFileJob& operator=(const LoadModelFileJob&);
+};
+
+
 RenderableMesh::RenderableMesh(Entity* const _entity, Renderer* renderer):
     Component(COMPONENT_RENDERABLEMESH, _entity),
     m_renderer(renderer),
@@ -49,8 +97,8 @@ RenderableMesh::RenderableMesh(Entity* const _entity, Renderer* renderer):
 {
     m_renderer->registerRenderableMesh(this);
 
-    m_entity->registerCommand("load-model-box", boost::bind(&RenderableMesh::cmdLoadModelBox, this, _1));
-    m_entity->registerCommand("load-model-file", boost::bind(&RenderableMesh::cmdLoadModelFile, this, _1));
+    m_entity->registerCommand("load-model-box", CommandObject::slot_t::fromMethod<RenderableMesh, &RenderableMesh::cmdLoadModelBox>(this));
+    m_entity->registerAsyncCommand("load-model-file", CommandObject::async_slot_t::fromMethod<RenderableMesh, &RenderableMesh::cmdLoadModelFile>(this));
 }
 
 RenderableMesh::~RenderableMesh() {
@@ -81,15 +129,18 @@ void RenderableMesh::loadBox(const double lengthX, const double lengthY, const d
 }
 
 void RenderableMesh::loadFromFile(const string& fileName) {
-    m_description = RENDERABLEMESH_FILE_DESCRIPTION + " " + fileName;
-    m_model = m_renderer->findModel(m_description);
-    if (m_model == 0) {
-        m_model = new Model(m_description);
-        m_model->generateFromFile(fileName);
-        m_renderer->registerModel(m_model);
-        for (size_t i = 0; i < m_model->getTotalMeshes(); ++i)
-            m_renderer->uploadMeshToGPU(*m_model->mesh(i));
+    string description = RENDERABLEMESH_FILE_DESCRIPTION + " " + fileName;
+    Model* model = m_renderer->findModel(description);
+    if (model == 0) {
+        model = new Model(description);
+        model->generateFromFile(fileName);
     }
+    loadFromModel(model);
+}
+
+void RenderableMesh::loadFromModel(Model* model) {
+    m_model = m_renderer->registerAndUploadModel(model);
+    m_description = m_model->getIdentifier();
     m_materials.resize(m_model->getTotalMeshes());
     Culling::registerForCulling(this);
 }
@@ -121,7 +172,7 @@ void RenderableMesh::loadFromPtree(const string& path, const ptree& tree) {
         loadFromFile(file);
     }
     else {
-        cerr << "Error: unknown renderablemesh model type: " << _model << endl;
+        LogError() << "Error: unknown renderablemesh model type: " << _model;
         return;
     }
 
@@ -169,3 +220,13 @@ string RenderableMesh::cmdLoadModelBox(deque<string>& args) {
     loadBox(x, y, z);
     return "";
 }
+
+string RenderableMesh::cmdLoadModelFile(deque<string>& args, AsyncJob*& job) {
+    if (args.size() < 1)
+        return "Error: too few arguments";
+    if (m_renderer->findModel(RENDERABLEMESH_FILE_DESCRIPTION + " " + args[0]) != 0)
+        loadFromFile(args[0]);
+    else
+        job = new LoadModelFileJob(this, args[0]);
+    return "";
+}
@@ -27,18 +27,27 @@
 #include "shoggoth-engine/renderer/renderer.hpp"
 
 #include <iostream>
+#include <sstream>
+#include <iomanip>
 #include <cmath>
+#include <algorithm>
 #include <GL/glew.h>
 #include "shoggoth-engine/linearmath/transform.hpp"
 #include "shoggoth-engine/kernel/device.hpp"
 #include "shoggoth-engine/kernel/entity.hpp"
+#include "shoggoth-engine/kernel/inputlatency.hpp"
+#include "shoggoth-engine/kernel/frametimer.hpp"
 #include "shoggoth-engine/kernel/model.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
+#include "shoggoth-engine/kernel/jobsystem.hpp"
+#include "shoggoth-engine/kernel/startuptimer.hpp"
 #include "shoggoth-engine/renderer/camera.hpp"
 #include "shoggoth-engine/renderer/light.hpp"
 #include "shoggoth-engine/renderer/material.hpp"
 #include "shoggoth-engine/renderer/opengl.hpp"
 #include "shoggoth-engine/renderer/renderablemesh.hpp"
 #include "shoggoth-engine/renderer/texture.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
@@ -52,34 +61,57 @@ Renderer::Renderer(const string& objectName, const Device* device):
     m_models(),
     m_materials(),
     m_textures(),
-    m_defaultMaterial(new Material(this))
+    m_defaultMaterial(new Material(this)),
+    m_drawTransforms(),
+    m_drawList(),
+    m_drawLights(),
+    m_renderQueue(),
+    m_drawBatches(),
+    m_instanceMatrices(),
+    m_instanceBufferId(0),
+    m_frameStats(),
+    m_totalStats()
 {
-    registerAttribute("ambient-light", boost::bind(&Renderer::cmdAmbientLight, this, _1));
-    registerAttribute("texture-filtering", boost::bind(&Renderer::cmdTextureFiltering, this, _1));
-    registerAttribute("anisotropy", boost::bind(&Renderer::cmdAnisotropy, this, _1));
+    registerAttribute("ambient-light", slot_t::fromMethod<Renderer, &Renderer::cmdAmbientLight>(this));
+    registerAttribute("texture-filtering", slot_t::fromMethod<Renderer, &Renderer::cmdTextureFiltering>(this));
+    registerAttribute("anisotropy", slot_t::fromMethod<Renderer, &Renderer::cmdAnisotropy>(this));
+    registerCommand("render-stats", slot_t::fromMethod<Renderer, &Renderer::cmdRenderStats>(this));
+    registerCommand("render-stats-reset", slot_t::fromMethod<Renderer, &Renderer::cmdRenderStatsReset>(this));
 
-    OpenGL::detectCapabilities();
-    m_defaultMaterial->loadFromFile("assets/materials/default.material");
-    Culling::initialize();
+    // the culling world needs no context, it is built while the main thread talks to the driver
+    JobCounter culling;
+    JobSystem::submit(job_slot_t::fromMethod<Renderer, &Renderer::initializeCulling>(this), 0, 1, &culling);
+
+    if (m_device->isHeadless())
+        OpenGL::forceNullRenderer();
+    {
+        StartupPhase phase("OpenGL capabilities");
+        OpenGL::detectCapabilities();
+    }
+    {
+        StartupPhase phase("Default material");
+        m_defaultMaterial->loadFromFile("assets/materials/default.material");
+    }
+    JobSystem::wait(culling);
 }
 
 Renderer::~Renderer() {
     Culling::shutdown();
 
-    cout << "Destroying all textures: " << m_textures.size() << endl;
+    LogInfo() << "Destroying all textures: " << m_textures.size();
     boost::unordered_map<string, Texture*>::const_iterator itTexture;
     for (itTexture = m_textures.begin(); itTexture != m_textures.end(); ++itTexture) {
         deleteTextureFromGPU(*itTexture->second);
         delete itTexture->second;
     }
 
-    cout << "Destroying all materials: " << m_materials.size() << endl;
+    LogInfo() << "Destroying all materials: " << m_materials.size();
     delete m_defaultMaterial;
     boost::unordered_map<string, Material*>::const_iterator itMat;
     for (itMat = m_materials.begin(); itMat != m_materials.end(); ++itMat)
         delete itMat->second; // automatically destroys and frees its shader program
 
-    cout << "Destroying all models: " << m_models.size() << endl;
+    LogInfo() << "Destroying all models: " << m_models.size();
     boost::unordered_map<string, Model*>::const_iterator itModel;
     for (itModel = m_models.begin(); itModel != m_models.end(); ++itModel) {
         for (size_t i = 0; i < itModel->second->getTotalMeshes(); ++i)
@@ -87,94 +119,78 @@ Renderer::~Renderer() {
         delete itModel->second;
     }
 
+    if (m_instanceBufferId != 0)
+        gl::deleteBuffer(m_instanceBufferId);
+
     // renderablemeshes, lights and cameras destroyed when destroying root scene node
 
     unregisterAllCommands();
     unregisterAllAttributes();
 }
 
-void Renderer::draw() {
+void Renderer::draw(const double alpha) {
+    buildFrame(alpha);
+    submitFrame();
+}
+
+void Renderer::buildFrame(const double alpha) {
+    TraceScope trace("Renderer::buildFrame");
+    InputLatency::onDraw();
+    FrameTimer::beginPhase(FRAME_PHASE_DRAW);
+
     if (m_activeCamera->hasChanged()) {
         initCamera();
         m_activeCamera->setHasChanged(false);
     }
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
     // set camera
     const Entity* cam = m_activeCamera->getEntity();
-    Transform(cam->getOrientationAbs(), cam->getPositionAbs()).inverse().getOpenGLMatrix(OpenGL::ms_viewMatrix);
-    if (!OpenGL::areShadersSupported()) {
-        glLoadIdentity();
-        glMultMatrixf(OpenGL::ms_viewMatrix);
-        displayLegacyLights();
-    }
+    const scalar_t t = scalar_t(alpha);
+    Transform(cam->getInterpolatedOrientationAbs(t), cam->getInterpolatedPositionAbs(t)).inverse().getOpenGLMatrix(OpenGL::ms_viewMatrix);
 
     // frustum culling
-    set<RenderableMesh*> modelsInFrustum;
+    FrameTimer::endPhase(FRAME_PHASE_DRAW);
+    FrameTimer::beginPhase(FRAME_PHASE_CULLING);
+    frame_renderable_set_t modelsInFrustum;
     Culling::performFrustumCulling(OpenGL::ms_projectionMatrix, m_activeCamera->getEntity(), modelsInFrustum);
+    FrameTimer::endPhase(FRAME_PHASE_CULLING);
+    FrameTimer::beginPhase(FRAME_PHASE_DRAW);
 
-    // set meshes
-    set<RenderableMesh*>::const_iterator it;
-    for (it = modelsInFrustum.begin(); it != modelsInFrustum.end(); ++it) {
-        const Model* model = (*it)->getModel();
-        const Entity* entity = (*it)->getEntity();
-
-        Transform(entity->getOrientationAbs(), entity->getPositionAbs()).getOpenGLMatrix(OpenGL::ms_modelMatrix);
-        OpenGL::multMatrix(OpenGL::ms_modelViewMatrix, OpenGL::ms_modelMatrix, OpenGL::ms_viewMatrix);
-        OpenGL::multMatrix(OpenGL::ms_modelViewProjectionMatrix, OpenGL::ms_modelViewMatrix, OpenGL::ms_projectionMatrix);
-        OpenGL::inverseMatrix(OpenGL::ms_normalMatrix, OpenGL::ms_modelViewMatrix);
-        OpenGL::transposeMatrix(OpenGL::ms_normalMatrix);
-        if (!OpenGL::areShadersSupported()) {
-            glLoadIdentity();
-            glMultMatrixf(OpenGL::ms_modelViewMatrix);
-        }
-        for (size_t n = 0; n < model->getTotalMeshes(); ++n) {
-            const Mesh* mesh = model->getMesh(n);
-            const Material* material = (*it)->getMaterial(n);
+    buildDrawList(modelsInFrustum, t);
+    FrameTimer::endPhase(FRAME_PHASE_DRAW);
+}
 
-            // draw mesh
-            if (material != 0)
-                material->useMaterial();
-            else
-                m_defaultMaterial->useMaterial();
-            if (OpenGL::areVBOsSupported()) {
-                // bind buffers
-                gl::bindVboBuffer(mesh->getVboId());
-                gl::bindIndexBuffer(mesh->getIndicesId());
+void Renderer::submitFrame() {
+    TraceScope trace("Renderer::submitFrame");
+    FrameTimer::beginPhase(FRAME_PHASE_DRAW);
+    if (!OpenGL::isNullRenderer())
+        submitDrawList();
+    FrameTimer::endPhase(FRAME_PHASE_DRAW);
 
-                // draw
-                if (OpenGL::areShadersSupported()) {
-                    gl::vertexAttribPointer(VERTEX_ARRAY_INDEX, 0);
-                    gl::vertexAttribPointer(NORMALS_ARRAY_INDEX, mesh->getVerticesBytes());
-                    gl::vertexAttribPointer(UVCOORDS_ARRAY_INDEX, mesh->getVerticesBytes() + mesh->getNormalsBytes());
-                }
-                else {
-                    glVertexPointer(3, GL_FLOAT, 0, 0);
-                    glNormalPointer(GL_FLOAT, 0, (GLvoid*)mesh->getVerticesBytes());
-                    glTexCoordPointer(2, GL_FLOAT, 0, (GLvoid*)(mesh->getVerticesBytes() + mesh->getNormalsBytes()));
-                }
-                gl::drawElements(mesh->getIndicesSize());
-
-                // unbind buffers
-                gl::bindVboBuffer(0);
-                gl::bindIndexBuffer(0);
-            }
-            else {
-                glVertexPointer(3, GL_FLOAT, 0, mesh->getVerticesPtr());
-                glNormalPointer(GL_FLOAT, 0, mesh->getNormalsPtr());
-                glTexCoordPointer(2, GL_FLOAT, 0, mesh->getUvCoordsPtr());
-                glDrawElements(GL_TRIANGLES, GLsizei(mesh->getIndicesSize()), GL_UNSIGNED_INT, mesh->getIndicesPtr());
-            }
-        }
-    }
+    FrameTimer::beginPhase(FRAME_PHASE_SWAP);
+    TraceScope traceSwap("Device::swapBuffers");
     m_device->swapBuffers();
+    FrameTimer::endPhase(FRAME_PHASE_SWAP);
 }
 
 void Renderer::registerModel(Model* model) {
     m_models.insert(pair<string, Model*>(model->getIdentifier(), model));
 }
 
+Model* Renderer::registerAndUploadModel(Model* model) {
+    // models generated on a worker may have been loaded meanwhile by someone else
+    Model* registeredModel = findModel(model->getIdentifier());
+    if (registeredModel != 0) {
+        if (registeredModel != model)
+            delete model;
+        return registeredModel;
+    }
+    registerModel(model);
+    for (size_t i = 0; i < model->getTotalMeshes(); ++i)
+        uploadMeshToGPU(*model->mesh(i));
+    return model;
+}
+
 void Renderer::unregisterModel(Model* model) {
     m_models.erase(model->getIdentifier());
 }
@@ -220,11 +236,15 @@ Material* Renderer::findMaterial(const std::string& fileName) {
 }
 
 void Renderer::setAmbientLight(const float r, const float g, const float b, const float a) {
+    if (OpenGL::isNullRenderer())
+        return;
     GLfloat global_ambient[] = {r, g, b, a};
     glLightModelfv(GL_LIGHT_MODEL_AMBIENT, global_ambient);
 }
 
 void Renderer::updateLegacyLights() const {
+    if (OpenGL::isNullRenderer())
+        return;
     set<Light*>::const_iterator it = m_lights.begin();
     for (size_t i = 0; i < m_lights.size(); ++i) {
         GLenum lightEnum;
@@ -279,18 +299,36 @@ void Renderer::uploadMeshToGPU(Mesh& mesh) {
         gl::vboBufferSubData(verticesBytes, normalsBytes, mesh.getNormalsPtr());
         gl::vboBufferSubData(verticesBytes + normalsBytes, uvCoordsBytes, mesh.getUvCoordsPtr());
         if (verticesBytes + normalsBytes + uvCoordsBytes != gl::getVboBufferBytes())
-            cerr << "Error: data size is mismatch with input array" << endl;
+            LogError() << "Error: data size is mismatch with input array";
 
         id = gl::genBuffer();
         mesh.setIndicesId(id);
         gl::bindIndexBuffer(mesh.getIndicesId());
         gl::indexBufferData(indicesBytes, mesh.getIndicesPtr());
         if (indicesBytes != gl::getIndexBufferBytes())
-            cerr << "Error: data size is mismatch with input array" << endl;
+            LogError() << "Error: data size is mismatch with input array";
+    }
+
+    if (OpenGL::areVAOsSupported()) {
+        // the index buffer binding and the attribute layout are recorded in the bound vao
+        mesh.setVaoId(gl::genVertexArray());
+        gl::bindVertexArray(mesh.getVaoId());
+        gl::bindVboBuffer(mesh.getVboId());
+        gl::bindIndexBuffer(mesh.getIndicesId());
+        gl::enableVertexAttribArray(VERTEX_ARRAY_INDEX);
+        gl::enableVertexAttribArray(NORMALS_ARRAY_INDEX);
+        gl::enableVertexAttribArray(UVCOORDS_ARRAY_INDEX);
+        gl::vertexAttribPointer(VERTEX_ARRAY_INDEX, 0);
+        gl::vertexAttribPointer(NORMALS_ARRAY_INDEX, verticesBytes);
+        gl::vertexAttribPointer(UVCOORDS_ARRAY_INDEX, verticesBytes + normalsBytes);
+        gl::bindVertexArray(0);
     }
 }
 
 void Renderer::deleteMeshFromGPU(const Mesh& mesh) {
+    // forcing the fixed pipeline turns vaos off, the ones already made are still deleted
+    if (mesh.getVaoId() != 0)
+        gl::deleteVertexArray(mesh.getVaoId());
     if (OpenGL::areVBOsSupported()) {
         gl::deleteBuffer(mesh.getVboId());
         gl::deleteBuffer(mesh.getIndicesId());
@@ -298,6 +336,8 @@ void Renderer::deleteMeshFromGPU(const Mesh& mesh) {
 }
 
 void Renderer::uploadTextureToGPU(Texture& texture) {
+    if (OpenGL::isNullRenderer())
+        return;
     GLenum textureFormat;
 
     unsigned int id;
@@ -321,7 +361,7 @@ void Renderer::uploadTextureToGPU(Texture& texture) {
         textureFormat = GL_BGR;
         break;
     default:
-        cerr << "Error: invalid texture_format_t: " << texture.getTextureFormat() << endl;
+        LogError() << "Error: invalid texture_format_t: " << texture.getTextureFormat();
         textureFormat = GL_RGBA;
     }
     switch (OpenGL::textureFilteringMode()) {
@@ -337,7 +377,7 @@ void Renderer::uploadTextureToGPU(Texture& texture) {
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         break;
     default:
-        cerr << "Error: invalid texture_filtering_t: " << OpenGL::textureFilteringMode() << endl;
+        LogError() << "Error: invalid texture_filtering_t: " << OpenGL::textureFilteringMode();
     }
     switch (OpenGL::mipMapGenerationMode()) {
     case MIPMAP_GENERATION_TEX_PARAMETER:
@@ -351,7 +391,7 @@ void Renderer::uploadTextureToGPU(Texture& texture) {
                           GLsizei(texture.getHeight()), textureFormat, GL_UNSIGNED_BYTE, texture.getPixels());
         break;
     default:
-        cerr << "Error: invalid mipmap_generation_t: " << OpenGL::mipMapGenerationMode() << endl;
+        LogError() << "Error: invalid mipmap_generation_t: " << OpenGL::mipMapGenerationMode();
     }
     if (OpenGL::mipMapGenerationMode() != MIPMAP_GENERATION_GLU) {
         switch (OpenGL::textureCompressionMode()) {
@@ -370,12 +410,14 @@ void Renderer::uploadTextureToGPU(Texture& texture) {
                     GLsizei(texture.getHeight()), 0, textureFormat, GL_UNSIGNED_BYTE, texture.getPixels());
             break;
         default:
-            cerr << "Error: invalid texture_compression_t: " << OpenGL::textureCompressionMode() << endl;
+            LogError() << "Error: invalid texture_compression_t: " << OpenGL::textureCompressionMode();
         }
     }
 }
 
 void Renderer::deleteTextureFromGPU(const Texture& texture) {
+    if (OpenGL::isNullRenderer())
+        return;
     unsigned int id = texture.getId();
     glDeleteTextures(1, &id);
 }
@@ -423,7 +465,16 @@ Renderer::Renderer(const Renderer& rhs):
     m_models(rhs.m_models),
     m_materials(rhs.m_materials),
     m_textures(rhs.m_textures),
-    m_defaultMaterial(rhs.m_defaultMaterial)
+    m_defaultMaterial(rhs.m_defaultMaterial),
+    m_drawTransforms(rhs.m_drawTransforms),
+    m_drawList(rhs.m_drawList),
+    m_drawLights(rhs.m_drawLights),
+    m_renderQueue(rhs.m_renderQueue),
+    m_drawBatches(rhs.m_drawBatches),
+    m_instanceMatrices(rhs.m_instanceMatrices),
+    m_instanceBufferId(rhs.m_instanceBufferId),
+    m_frameStats(rhs.m_frameStats),
+    m_totalStats(rhs.m_totalStats)
 {
     cerr << "Renderer copy constructor should not be called" << endl;
 }
@@ -435,7 +486,365 @@ Renderer& Renderer::operator=(const Renderer& rhs) {
     return *this;
 }
 
+void Renderer::initializeCulling(const size_t, const size_t) {
+    StartupPhase phase("Culling world");
+    Culling::initialize();
+}
+
+void Renderer::buildDrawList(const frame_renderable_set_t& renderables, const scalar_t& alpha) {
+    TraceScope trace("Renderer::buildDrawList");
+    // the vectors keep their capacity between frames
+    m_drawTransforms.clear();
+    m_drawList.clear();
+    m_drawLights.clear();
+    m_renderQueue.clear();
+
+    set<Light*>::const_iterator itLight;
+    for (itLight = m_lights.begin(); itLight != m_lights.end(); ++itLight) {
+        const Light* light = *itLight;
+        const Entity* entity = light->getEntity();
+        const Vector3 pos = entity->getInterpolatedPositionAbs(alpha);
+        const Vector3 rot = VECTOR3_UNIT_Z_NEG.rotate(entity->getInterpolatedOrientationAbs(alpha));
+        draw_light_t drawLight = {
+            {float(pos.getX()), float(pos.getY()), float(pos.getZ()), (light->getLightType() == LIGHT_DIRECTIONAL)? 0.0f : 1.0f},
+            {float(rot.getX()), float(rot.getY()), float(rot.getZ())},
+            light->getConstantAttenuation(),
+            light->getLinearAttenuation(),
+            light->getQuadraticAttenuation(),
+            light->getLightType() != LIGHT_POINTLIGHT
+        };
+        m_drawLights.push_back(drawLight);
+    }
+
+    const float* view = OpenGL::ms_viewMatrix;
+    frame_renderable_set_t::const_iterator it;
+    for (it = renderables.begin(); it != renderables.end(); ++it) {
+        const Model* model = (*it)->getModel();
+        const Entity* entity = (*it)->getEntity();
+
+        draw_transform_t transform;
+        Transform(entity->getInterpolatedOrientationAbs(alpha), entity->getInterpolatedPositionAbs(alpha)).getOpenGLMatrix(transform.modelMatrix);
+        m_drawTransforms.push_back(transform);
+
+        // distance to the camera along its view, it looks down -z
+        const float* position = transform.modelMatrix + 12;
+        float depth = -(view[2] * position[0] + view[6] * position[1] + view[10] * position[2] + view[14]);
+
+        for (size_t n = 0; n < model->getTotalMeshes(); ++n) {
+            const Material* material = (*it)->getMaterial(n);
+            draw_item_t item = {model->getMesh(n), material != 0? material : m_defaultMaterial, m_drawTransforms.size() - 1};
+            boost::uint64_t key;
+            if (isInstancedDraw(item))
+                key = RenderQueue::makeInstancedKey(item.material->getProgramId(),
+                                                    item.material->getSortId(),
+                                                    item.material->getTextureId(),
+                                                    item.mesh->getVboId());
+            else
+                key = RenderQueue::makeKey(item.material->isTransparent()? RENDER_PASS_TRANSPARENT : RENDER_PASS_OPAQUE,
+                                           item.material->getProgramId(),
+                                           item.material->getSortId(),
+                                           item.material->getTextureId(),
+                                           depth);
+            m_renderQueue.push(key, m_drawList.size());
+            m_drawList.push_back(item);
+        }
+    }
+    m_renderQueue.sort();
+    buildDrawBatches();
+    countStateChanges();
+}
+
+void Renderer::buildDrawBatches() {
+    m_drawBatches.clear();
+    m_instanceMatrices.clear();
+    for (size_t i = 0; i < m_renderQueue.size(); ++i) {
+        const draw_item_t& item = m_drawList[m_renderQueue.getItem(i)];
+        const float* modelMatrix = m_drawTransforms[item.transform].modelMatrix;
+        if (!isInstancedDraw(item)) {
+            draw_batch_t batch = {i, 1, 0, false};
+            m_drawBatches.push_back(batch);
+            continue;
+        }
+
+        // the instanced keys sort the items of a mesh with a material next to each other
+        if (!m_drawBatches.empty() && m_drawBatches.back().isInstanced) {
+            const draw_item_t& first = m_drawList[m_renderQueue.getItem(m_drawBatches.back().first)];
+            if (first.mesh == item.mesh && first.material == item.material) {
+                ++m_drawBatches.back().count;
+                m_instanceMatrices.insert(m_instanceMatrices.end(), modelMatrix, modelMatrix + 16);
+                continue;
+            }
+        }
+        draw_batch_t batch = {i, 1, m_instanceMatrices.size() / 16, true};
+        m_drawBatches.push_back(batch);
+        m_instanceMatrices.insert(m_instanceMatrices.end(), modelMatrix, modelMatrix + 16);
+    }
+}
+
+// the calls the submit loop of the backend in use makes, the shaders bind no texture and
+// the fixed pipeline no program
+void Renderer::countStateChanges() {
+    const bool areShadersUsed = OpenGL::areShadersSupported();
+    const bool areVBOsUsed = OpenGL::areVBOsSupported();
+    render_stats_t stats = {1, m_renderQueue.size(), m_drawBatches.size(), 0, 0, 0, 0, 0};
+    const Material* lastMaterial = 0;
+    const Mesh* lastMesh = 0;
+    unsigned int lastProgram = 0;
+    unsigned int lastTexture = 0;
+    size_t lastTransform = m_drawTransforms.size();
+    for (size_t i = 0; i < m_drawBatches.size(); ++i) {
+        const draw_batch_t& batch = m_drawBatches[i];
+        const draw_item_t& item = m_drawList[m_renderQueue.getItem(batch.first)];
+        bool isMaterialChanged = item.material != lastMaterial;
+        if (isMaterialChanged) {
+            if (areShadersUsed && (lastMaterial == 0 || item.material->getProgramId() != lastProgram)) {
+                ++stats.programBinds;
+                lastProgram = item.material->getProgramId();
+            }
+            if (!areShadersUsed && (lastMaterial == 0 || item.material->getTextureId() != lastTexture)) {
+                ++stats.textureBinds;
+                lastTexture = item.material->getTextureId();
+            }
+            ++stats.materialBinds;
+            lastMaterial = item.material;
+        }
+
+        // instanced batches take the model matrices from the instance buffer
+        bool isTransformChanged = !batch.isInstanced && item.transform != lastTransform;
+        if (isTransformChanged)
+            lastTransform = item.transform;
+        if (isTransformChanged || (areShadersUsed && isMaterialChanged))
+            ++stats.matrixUploads;
+
+        if (areVBOsUsed && item.mesh != lastMesh) {
+            ++stats.bufferBinds;
+            lastMesh = item.mesh;
+        }
+        if (batch.isInstanced)
+            ++stats.bufferBinds;
+    }
+
+    m_frameStats = stats;
+    m_totalStats.frames += stats.frames;
+    m_totalStats.draws += stats.draws;
+    m_totalStats.drawCalls += stats.drawCalls;
+    m_totalStats.programBinds += stats.programBinds;
+    m_totalStats.materialBinds += stats.materialBinds;
+    m_totalStats.textureBinds += stats.textureBinds;
+    m_totalStats.matrixUploads += stats.matrixUploads;
+    m_totalStats.bufferBinds += stats.bufferBinds;
+}
+
+string Renderer::reportRenderStats() const {
+    const render_stats_t* stats[] = {&m_frameStats, &m_totalStats};
+    const char* names[] = {"Last frame", "Total"};
+    stringstream ss;
+    for (size_t i = 0; i < 2; ++i) {
+        const render_stats_t& s = *stats[i];
+        ss << names[i] << ", " << s.frames << " frames, " << s.draws << " draws" << endl;
+        ss << "  draw calls:       " << setw(10) << s.drawCalls << "  saved " << setw(10) << s.draws - s.drawCalls << endl;
+        ss << "  program binds:    " << setw(10) << s.programBinds << "  saved " << setw(10) << s.draws - s.programBinds << endl;
+        ss << "  material binds:   " << setw(10) << s.materialBinds << "  saved " << setw(10) << s.draws - s.materialBinds << endl;
+        ss << "  texture binds:    " << setw(10) << s.textureBinds << "  saved " << setw(10) << s.draws - s.textureBinds << endl;
+        ss << "  matrix uploads:   " << setw(10) << s.matrixUploads << "  saved " << setw(10) << s.draws - s.matrixUploads << endl;
+        ss << "  buffer binds:     " << setw(10) << s.bufferBinds << "  saved " << setw(10) << s.draws - s.bufferBinds << endl;
+    }
+    return ss.str();
+}
+
+// transparent draws keep their back to front order, one by one
+bool Renderer::isInstancedDraw(const draw_item_t& item) const {
+    return OpenGL::areInstancedDrawsSupported() && item.material->isInstanced() && !item.material->isTransparent();
+}
+
+void Renderer::submitDrawList() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (OpenGL::areShadersSupported() && OpenGL::areVBOsSupported())
+        submitShaderDrawList();
+    else
+        submitLegacyDrawList();
+}
+
+// shaders reading vbos, only calls that a core profile keeps. Each mesh is a vao bind when
+// they are supported. The state only changes between the groups of the sorted queue,
+// countStateChanges() makes the same decisions
+void Renderer::submitShaderDrawList() {
+    // the model matrices of every instanced batch go in a single upload
+    if (!m_instanceMatrices.empty()) {
+        if (m_instanceBufferId == 0)
+            m_instanceBufferId = gl::genBuffer();
+        gl::bindVboBuffer(m_instanceBufferId);
+        gl::vboStreamData(m_instanceMatrices.size() * sizeof(float), &m_instanceMatrices[0]);
+    }
+
+    const bool areVAOsUsed = OpenGL::areVAOsSupported();
+    const Material* lastMaterial = 0;
+    const Mesh* lastMesh = 0;
+    unsigned int lastProgram = 0;
+    size_t lastTransform = m_drawTransforms.size();
+    bool wasInstanced = false;
+    for (size_t i = 0; i < m_drawBatches.size(); ++i) {
+        const draw_batch_t& batch = m_drawBatches[i];
+        const draw_item_t& item = m_drawList[m_renderQueue.getItem(batch.first)];
+        const Mesh* mesh = item.mesh;
+
+        // set mesh transform, once for all the meshes of a model
+        bool isTransformChanged = !batch.isInstanced && item.transform != lastTransform;
+        if (isTransformChanged) {
+            copy(m_drawTransforms[item.transform].modelMatrix, m_drawTransforms[item.transform].modelMatrix + 16, OpenGL::ms_modelMatrix);
+            OpenGL::multMatrix(OpenGL::ms_modelViewMatrix, OpenGL::ms_modelMatrix, OpenGL::ms_viewMatrix);
+            OpenGL::multMatrix(OpenGL::ms_modelViewProjectionMatrix, OpenGL::ms_modelViewMatrix, OpenGL::ms_projectionMatrix);
+            OpenGL::inverseMatrix(OpenGL::ms_normalMatrix, OpenGL::ms_modelViewMatrix);
+            OpenGL::transposeMatrix(OpenGL::ms_normalMatrix);
+            lastTransform = item.transform;
+        }
+
+        // set material, the queue sorts by program first so most changes keep it bound
+        bool isMaterialChanged = item.material != lastMaterial;
+        if (isMaterialChanged) {
+            if (lastMaterial == 0 || item.material->getProgramId() != lastProgram) {
+                item.material->useProgram();
+                lastProgram = item.material->getProgramId();
+            }
+            item.material->useMaterialState();
+            lastMaterial = item.material;
+        }
+        if (isMaterialChanged || isTransformChanged)
+            item.material->useTransform();
+
+        // a shader made for instancing drawn one by one takes its model matrix as a constant
+        // attribute, the value is undefined after a draw with the array enabled
+        if (!batch.isInstanced && item.material->isInstanced() && (isMaterialChanged || isTransformChanged || wasInstanced))
+            gl::instanceMatrix(OpenGL::ms_modelMatrix);
+
+        // bind buffers
+        if (mesh != lastMesh) {
+            if (areVAOsUsed)
+                gl::bindVertexArray(mesh->getVaoId());
+            else {
+                gl::bindVboBuffer(mesh->getVboId());
+                gl::bindIndexBuffer(mesh->getIndicesId());
+                gl::vertexAttribPointer(VERTEX_ARRAY_INDEX, 0);
+                gl::vertexAttribPointer(NORMALS_ARRAY_INDEX, mesh->getVerticesBytes());
+                gl::vertexAttribPointer(UVCOORDS_ARRAY_INDEX, mesh->getVerticesBytes() + mesh->getNormalsBytes());
+            }
+            lastMesh = mesh;
+        }
+
+        // draw, instance matrices come from the array only for instanced batches. The enabled
+        // arrays belong to the vao, so they are turned back off for the next draw of its mesh
+        if (batch.isInstanced) {
+            if (areVAOsUsed || !wasInstanced)
+                gl::enableInstanceMatrixArray(true);
+            gl::bindVboBuffer(m_instanceBufferId);
+            gl::instanceMatrixPointer(batch.instance * 16 * sizeof(float));
+            gl::drawElementsInstanced(mesh->getIndicesSize(), batch.count);
+            if (areVAOsUsed)
+                gl::enableInstanceMatrixArray(false);
+        }
+        else {
+            if (!areVAOsUsed && wasInstanced)
+                gl::enableInstanceMatrixArray(false);
+            gl::drawElements(mesh->getIndicesSize());
+        }
+        wasInstanced = batch.isInstanced;
+    }
+
+    // unbind buffers
+    if (!areVAOsUsed && wasInstanced)
+        gl::enableInstanceMatrixArray(false);
+    if (areVAOsUsed && lastMesh != 0)
+        gl::bindVertexArray(0);
+    if (lastMesh != 0 || !m_instanceMatrices.empty()) {
+        gl::bindVboBuffer(0);
+        if (!areVAOsUsed)
+            gl::bindIndexBuffer(0);
+    }
+}
+
+// fixed pipeline, or shaders fed from main memory, without instanced batches
+void Renderer::submitLegacyDrawList() {
+    const bool areShadersUsed = OpenGL::areShadersSupported();
+    if (!areShadersUsed) {
+        glLoadIdentity();
+        glMultMatrixf(OpenGL::ms_viewMatrix);
+        displayLegacyLights();
+    }
+
+    const Material* lastMaterial = 0;
+    const Mesh* lastMesh = 0;
+    unsigned int lastProgram = 0;
+    unsigned int lastTexture = 0;
+    size_t lastTransform = m_drawTransforms.size();
+    for (size_t i = 0; i < m_drawBatches.size(); ++i) {
+        const draw_item_t& item = m_drawList[m_renderQueue.getItem(m_drawBatches[i].first)];
+        const Mesh* mesh = item.mesh;
+
+        // set mesh transform, once for all the meshes of a model
+        bool isTransformChanged = item.transform != lastTransform;
+        if (isTransformChanged) {
+            copy(m_drawTransforms[item.transform].modelMatrix, m_drawTransforms[item.transform].modelMatrix + 16, OpenGL::ms_modelMatrix);
+            OpenGL::multMatrix(OpenGL::ms_modelViewMatrix, OpenGL::ms_modelMatrix, OpenGL::ms_viewMatrix);
+            OpenGL::multMatrix(OpenGL::ms_modelViewProjectionMatrix, OpenGL::ms_modelViewMatrix, OpenGL::ms_projectionMatrix);
+            OpenGL::inverseMatrix(OpenGL::ms_normalMatrix, OpenGL::ms_modelViewMatrix);
+            OpenGL::transposeMatrix(OpenGL::ms_normalMatrix);
+            if (!areShadersUsed) {
+                glLoadIdentity();
+                glMultMatrixf(OpenGL::ms_modelViewMatrix);
+            }
+            lastTransform = item.transform;
+        }
+
+        // set material
+        bool isMaterialChanged = item.material != lastMaterial;
+        if (isMaterialChanged) {
+            if (areShadersUsed && (lastMaterial == 0 || item.material->getProgramId() != lastProgram)) {
+                item.material->useProgram();
+                lastProgram = item.material->getProgramId();
+            }
+            item.material->useMaterialState();
+            if (!areShadersUsed && (lastMaterial == 0 || item.material->getTextureId() != lastTexture)) {
+                lastTexture = item.material->getTextureId();
+                glBindTexture(GL_TEXTURE_2D, lastTexture);
+            }
+            lastMaterial = item.material;
+        }
+        if (isMaterialChanged || isTransformChanged) {
+            item.material->useTransform();
+            if (areShadersUsed && item.material->isInstanced())
+                gl::instanceMatrix(OpenGL::ms_modelMatrix);
+        }
+
+        // draw mesh
+        if (OpenGL::areVBOsSupported()) {
+            if (mesh != lastMesh) {
+                gl::bindVboBuffer(mesh->getVboId());
+                gl::bindIndexBuffer(mesh->getIndicesId());
+                glVertexPointer(3, GL_FLOAT, 0, 0);
+                glNormalPointer(GL_FLOAT, 0, (GLvoid*)mesh->getVerticesBytes());
+                glTexCoordPointer(2, GL_FLOAT, 0, (GLvoid*)(mesh->getVerticesBytes() + mesh->getNormalsBytes()));
+                lastMesh = mesh;
+            }
+            gl::drawElements(mesh->getIndicesSize());
+        }
+        else {
+            glVertexPointer(3, GL_FLOAT, 0, mesh->getVerticesPtr());
+            glNormalPointer(GL_FLOAT, 0, mesh->getNormalsPtr());
+            glTexCoordPointer(2, GL_FLOAT, 0, mesh->getUvCoordsPtr());
+            glDrawElements(GL_TRIANGLES, GLsizei(mesh->getIndicesSize()), GL_UNSIGNED_INT, mesh->getIndicesPtr());
+        }
+    }
+
+    // unbind buffers
+    if (OpenGL::areVBOsSupported() && lastMesh != 0) {
+        gl::bindVboBuffer(0);
+        gl::bindIndexBuffer(0);
+    }
+}
+
 void Renderer::initLighting() const {
+    if (OpenGL::isNullRenderer())
+        return;
     // enable lighting for legacy lights
     //     glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL, GL_SEPARATE_SPECULAR_COLOR); // 1.4
 
@@ -510,10 +919,14 @@ void Renderer::initLighting() const {
 void Renderer::initCamera() {
     m_activeCamera->setViewport(0, 0, m_device->getWinWidth(), m_device->getWinHeight());
     viewport_t view = m_activeCamera->getViewport();
-    glViewport(view.posX, view.posY, GLsizei(view.width), GLsizei(view.height));
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
+    // the projection is needed for culling even when nothing is drawn
+    const bool isNullRenderer = OpenGL::isNullRenderer();
+    if (!isNullRenderer) {
+        glViewport(view.posX, view.posY, GLsizei(view.width), GLsizei(view.height));
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+    }
     switch (m_activeCamera->getCameraType()) {
     case CAMERA_ORTHOGRAPHIC:
         OpenGL::projectionMatrixOrthographic(
@@ -532,15 +945,16 @@ void Renderer::initCamera() {
         );
         break;
     default:
-        cerr << "Error: invalid camera_t: " << m_activeCamera->getCameraType() << endl;
+        LogError() << "Error: invalid camera_t: " << m_activeCamera->getCameraType();
+    }
+    if (!isNullRenderer) {
+        glMultMatrixf(OpenGL::ms_projectionMatrix);
+        glMatrixMode(GL_MODELVIEW);
     }
-    glMultMatrixf(OpenGL::ms_projectionMatrix);
-    glMatrixMode(GL_MODELVIEW);
 }
 
 void Renderer::displayLegacyLights() const {
-    set<Light*>::const_iterator itLight = m_lights.begin();
-    for (size_t i = 0; i < m_lights.size(); ++i) {
+    for (size_t i = 0; i < m_drawLights.size(); ++i) {
         GLenum lightEnum;
         switch (i) {
         case 0:
@@ -568,19 +982,13 @@ void Renderer::displayLegacyLights() const {
             lightEnum = GL_LIGHT7;
             break;
         }
-        float w = ((*itLight)->getLightType() == LIGHT_DIRECTIONAL)? 0.0f : 1.0f;
-        const Vector3& pos = (*itLight)->getEntity()->getPositionAbs();
-        float lightPosition[] = {float(pos.getX()), float(pos.getY()), float(pos.getZ()), w};
-        glLightfv(lightEnum, GL_POSITION, lightPosition);
-        glLightf(lightEnum, GL_CONSTANT_ATTENUATION, (*itLight)->getConstantAttenuation());
-        glLightf(lightEnum, GL_LINEAR_ATTENUATION, (*itLight)->getLinearAttenuation());
-        glLightf(lightEnum, GL_QUADRATIC_ATTENUATION, (*itLight)->getQuadraticAttenuation());
-        if ((*itLight)->getLightType() != LIGHT_POINTLIGHT) {
-            const Vector3& rot = VECTOR3_UNIT_Z_NEG.rotate((*itLight)->getEntity()->getOrientationAbs());
-            float lightOrientation[] = {float(rot.getX()), float(rot.getY()), float(rot.getZ())};
-            glLightfv(lightEnum, GL_SPOT_DIRECTION, lightOrientation);
-        }
-        ++itLight;
+        const draw_light_t& light = m_drawLights[i];
+        glLightfv(lightEnum, GL_POSITION, light.position);
+        glLightf(lightEnum, GL_CONSTANT_ATTENUATION, light.constantAttenuation);
+        glLightf(lightEnum, GL_LINEAR_ATTENUATION, light.linearAttenuation);
+        glLightf(lightEnum, GL_QUADRATIC_ATTENUATION, light.quadraticAttenuation);
+        if (light.isSpotDirectionUsed)
+            glLightfv(lightEnum, GL_SPOT_DIRECTION, light.spotDirection);
     }
 }
 
@@ -605,6 +1013,17 @@ string Renderer::cmdTextureFiltering(deque<string>& args) {
     return "";
 }
 
+string Renderer::cmdRenderStats(deque<string>&) {
+    return reportRenderStats();
+}
+
+string Renderer::cmdRenderStatsReset(deque<string>&) {
+    render_stats_t stats = {0, 0, 0, 0, 0, 0, 0, 0};
+    m_frameStats = stats;
+    m_totalStats = stats;
+    return "";
+}
+
 string Renderer::cmdAnisotropy(deque<string>& args) {
     if (args.size() < 1)
         return "Error: too few arguments";
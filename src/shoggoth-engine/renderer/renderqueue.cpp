@@ -0,0 +1,118 @@
+/*
+ *    Copyright (c) 2012 David Cavazos <davido262@gmail.com>
+ *
+ *    Permission is hereby granted, free of charge, to any person
+ *    obtaining a copy of this software and associated documentation
+ *    files (the "Software"), to deal in the Software without
+ *    restriction, including without limitation the rights to use,
+ *    copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following
+ *    conditions:
+ *
+ *    The above copyright notice and this permission notice shall be
+ *    included in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *    OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "shoggoth-engine/renderer/renderqueue.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+const size_t RADIX_BITS = 8;
+const size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+const size_t RADIX_PASSES = 64 / RADIX_BITS;
+
+const size_t KEY_PROGRAM_SHIFT = 48;
+const size_t KEY_MATERIAL_SHIFT = 34;
+const size_t KEY_TEXTURE_SHIFT = 20;
+const size_t KEY_PASS_SHIFT = 62;
+const size_t KEY_TRANSPARENT_DEPTH_SHIFT = 42;
+const boost::uint64_t KEY_FIELD_MASK = 0x3fff;
+const boost::uint64_t KEY_DEPTH_MASK = 0xfffff;
+
+
+RenderQueue::RenderQueue():
+    m_keys(),
+    m_buffer()
+{}
+
+boost::uint64_t RenderQueue::makeKey(const render_pass_t pass,
+                                     const unsigned int program,
+                                     const size_t material,
+                                     const unsigned int texture,
+                                     const float depth)
+{
+    // the bits of a positive float sort like the float, the top 20 are enough to order draws
+    boost::uint32_t depthBits = 0;
+    float positiveDepth = depth > 0.0f? depth : 0.0f;
+    memcpy(&depthBits, &positiveDepth, sizeof(depthBits));
+    boost::uint64_t depthKey = (boost::uint64_t(depthBits) >> 11) & KEY_DEPTH_MASK;
+
+    boost::uint64_t state = ((boost::uint64_t(program) & KEY_FIELD_MASK) << KEY_PROGRAM_SHIFT) |
+                            ((boost::uint64_t(material) & KEY_FIELD_MASK) << KEY_MATERIAL_SHIFT) |
+                            ((boost::uint64_t(texture) & KEY_FIELD_MASK) << KEY_TEXTURE_SHIFT);
+    switch (pass) {
+    case RENDER_PASS_OPAQUE:
+        return state | depthKey;
+    case RENDER_PASS_TRANSPARENT:
+        // the depth goes above the state so the state still groups draws at the same depth
+        return (boost::uint64_t(pass) << KEY_PASS_SHIFT) |
+               ((KEY_DEPTH_MASK - depthKey) << KEY_TRANSPARENT_DEPTH_SHIFT) |
+               (state >> (KEY_PASS_SHIFT - KEY_TRANSPARENT_DEPTH_SHIFT));
+    default:
+        return state | depthKey;
+    }
+}
+
+boost::uint64_t RenderQueue::makeInstancedKey(const unsigned int program,
+                                              const size_t material,
+                                              const unsigned int texture,
+                                              const unsigned int mesh)
+{
+    return ((boost::uint64_t(program) & KEY_FIELD_MASK) << KEY_PROGRAM_SHIFT) |
+           ((boost::uint64_t(material) & KEY_FIELD_MASK) << KEY_MATERIAL_SHIFT) |
+           ((boost::uint64_t(texture) & KEY_FIELD_MASK) << KEY_TEXTURE_SHIFT) |
+           (boost::uint64_t(mesh) & KEY_DEPTH_MASK);
+}
+
+void RenderQueue::sort() {
+    // least significant digit radix sort, stable, skipping the digits every key shares
+    // (most of them, the fields rarely use all their bits)
+    size_t counts[RADIX_PASSES][RADIX_BUCKETS];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < m_keys.size(); ++i) {
+        boost::uint64_t key = m_keys[i].key;
+        for (size_t pass = 0; pass < RADIX_PASSES; ++pass)
+            ++counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+    }
+
+    m_buffer.resize(m_keys.size());
+    for (size_t pass = 0; pass < RADIX_PASSES; ++pass) {
+        size_t* count = counts[pass];
+        size_t shift = pass * RADIX_BITS;
+        if (m_keys.empty() || count[(m_keys[0].key >> shift) & (RADIX_BUCKETS - 1)] == m_keys.size())
+            continue;
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+            size_t total = count[bucket];
+            count[bucket] = offset;
+            offset += total;
+        }
+        for (size_t i = 0; i < m_keys.size(); ++i)
+            m_buffer[count[(m_keys[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = m_keys[i];
+        m_keys.swap(m_buffer);
+    }
+}
@@ -42,6 +42,7 @@ const string GLSL_NORMAL_MATRIX = "_normalMatrix";
 const string GLSL_VERTEX = "_vertex";
 const string GLSL_NORMAL = "_normal";
 const string GLSL_UVCOORD = "_uvcoord";
+const string GLSL_INSTANCE_MODEL_MATRIX = "_instanceModelMatrix";
 
 
 Shader::Shader():
@@ -55,6 +56,7 @@ Shader::Shader():
     m_projectionMatrixLocation(-1),
     m_modelViewProjectionMatrixLocation(-1),
     m_normalMatrix(-1),
+    m_instanceMatrixLocation(-1),
     m_uniform1(),
     m_uniform2(),
     m_uniform3(),
@@ -128,6 +130,7 @@ bool Shader::loadShaderProgram(const string& vertexFile, const string& fragmentF
     gl::bindAttribLocation(m_shaderProgramId, VERTEX_ARRAY_INDEX, GLSL_VERTEX);
     gl::bindAttribLocation(m_shaderProgramId, NORMALS_ARRAY_INDEX, GLSL_NORMAL);
     gl::bindAttribLocation(m_shaderProgramId, UVCOORDS_ARRAY_INDEX, GLSL_UVCOORD);
+    gl::bindAttribLocation(m_shaderProgramId, INSTANCE_MATRIX_INDEX, GLSL_INSTANCE_MODEL_MATRIX);
 
     // link program
     bool linkedSuccesfully = gl::linkProgram(m_shaderProgramId);
@@ -149,12 +152,25 @@ bool Shader::loadShaderProgram(const string& vertexFile, const string& fragmentF
     m_modelViewProjectionMatrixLocation = gl::getUniformLocation(m_shaderProgramId, GLSL_MODEL_VIEW_PROJECTION_MATRIX);
     m_normalMatrix = gl::getUniformLocation(m_shaderProgramId, GLSL_NORMAL_MATRIX);
 
+    // shaders taking the model matrix as an attribute can draw many instances at once
+    m_instanceMatrixLocation = gl::getAttribLocation(m_shaderProgramId, GLSL_INSTANCE_MODEL_MATRIX);
+
     return true;
 }
 
 void Shader::useShader() const {
-    map<int, float*>::const_iterator it;
+    useProgram();
+    useUniforms();
+    useMatrices();
+}
+
+void Shader::useProgram() const {
     gl::useProgram(m_shaderProgramId);
+}
+
+// the uniforms of its material, the program must be in use
+void Shader::useUniforms() const {
+    map<int, float*>::const_iterator it;
     for (it = m_uniform1.begin(); it != m_uniform1.end(); ++it)
         gl::useUniform1(it->first, it->second);
     for (it = m_uniform2.begin(); it != m_uniform2.end(); ++it)
@@ -169,7 +185,10 @@ void Shader::useShader() const {
         gl::useUniform3x3(it->first, it->second);
     for (it = m_uniform4x4.begin(); it != m_uniform4x4.end(); ++it)
         gl::useUniform4x4(it->first, it->second);
+}
 
+// the matrices of the object being drawn, the program must be in use
+void Shader::useMatrices() const {
     gl::useUniform4x4(m_viewMatrixLocation, OpenGL::ms_viewMatrix);
     gl::useUniform4x4(m_modelMatrixLocation, OpenGL::ms_modelMatrix);
     gl::useUniform4x4(m_modelViewMatrixLocation, OpenGL::ms_modelViewMatrix);
@@ -29,6 +29,8 @@
 #include <iostream>
 #include <SDL/SDL_image.h>
 #include "shoggoth-engine/renderer/renderer.hpp"
+#include "shoggoth-engine/kernel/tracer.hpp"
+#include "shoggoth-engine/kernel/logger.hpp"
 
 using namespace std;
 
@@ -44,9 +46,10 @@ Texture::Texture(const string& fileName, Renderer* renderer):
 {}
 
 void Texture::loadToGPU() {
+    TraceScope trace("Texture::loadToGPU");
     SDL_Surface* img = IMG_Load(m_fileName.c_str());
     if (img == 0) {
-        cerr << "Error opening image file: " << m_fileName << endl;
+        LogError() << "Error opening image file: " << m_fileName;
         return;
     }
 
@@ -58,9 +61,9 @@ void Texture::loadToGPU() {
 
     // check width and height
     if ((m_width & (m_width - 1)) != 0)
-        cerr << "Warning: image's width is not a power of 2: " << m_fileName << endl;
+        LogWarning() << "Warning: image's width is not a power of 2: " << m_fileName;
     if ((m_height & (m_height - 1)) != 0)
-        cerr << "Warning: image's height is not a power of 2: " << m_fileName << endl;
+        LogWarning() << "Warning: image's height is not a power of 2: " << m_fileName;
 
     // check for number of channels in each pixel
     switch (m_bytesPerPixel) {
@@ -77,7 +80,7 @@ void Texture::loadToGPU() {
             m_textureFormat = TEXTURE_FORMAT_BGR;
         break;
     default:
-        cerr << "Warning: image is not truecolor: " << m_fileName << endl;
+        LogWarning() << "Warning: image is not truecolor: " << m_fileName;
     }
 
     m_renderer->uploadTextureToGPU(*this);
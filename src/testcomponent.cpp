@@ -37,7 +37,7 @@ TestComponent::TestComponent(Entity* const _entity):
     Component(COMPONENT_TESTCOMPONENT, _entity),
     m_health(100.0)
 {
-    m_entity->registerAttribute("health", boost::bind(&TestComponent::cmdHealth, this, _1));
+    m_entity->registerAttribute("health", CommandObject::slot_t::fromMethod<TestComponent, &TestComponent::cmdHealth>(this));
 }
 
 TestComponent::~TestComponent() {